@@ -0,0 +1,80 @@
+/**
+ * @file bigint_bench.cpp
+ * @brief Timing of BigInt multiplication, division and text conversion
+ *
+ * Build with -DKAYNAT_BUILD_BENCHMARKS=ON and run bigint_bench. Each size
+ * multiplies two random numbers of that many digits, then divides the
+ * product plus a remainder by one of them and checks q * b + r == a.
+ * The product is then printed and parsed back in decimal and in hex.
+ */
+
+#include "../src/interpreter/runtime_value.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace kaynat;
+
+namespace {
+
+BigInt random_number(size_t digits, std::mt19937_64& rng) {
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::string text(digits, '0');
+    text[0] = static_cast<char>('1' + digit(rng) % 9);
+    for (size_t i = 1; i < digits; ++i) {
+        text[i] = static_cast<char>('0' + digit(rng));
+    }
+    return BigInt(text);
+}
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 rng(42);
+    const size_t sizes[] = {10000, 100000, 1000000};
+
+    std::printf("%10s %14s %14s %14s %14s\n", "digits", "multiply (ms)", "divide (ms)", "decimal (ms)",
+                "hex (ms)");
+    for (size_t digits : sizes) {
+        BigInt a = random_number(digits, rng);
+        BigInt b = random_number(digits, rng);
+        BigInt r = random_number(digits / 2, rng);
+
+        BigInt product;
+        double multiply_ms = time_ms([&] { product = a * b; });
+
+        // Dividend of 2n digits by a divisor of n digits
+        BigInt dividend = product + r;
+        std::pair<BigInt, BigInt> result;
+        double divide_ms = time_ms([&] { result = BigInt::divmod(dividend, b); });
+
+        if (result.first != a || result.second != r) {
+            std::fprintf(stderr, "divmod mismatch at %zu digits\n", digits);
+            return 1;
+        }
+
+        // Print and parse back
+        BigInt decimal;
+        double decimal_ms = time_ms([&] { decimal = BigInt(product.to_string()); });
+        BigInt hex;
+        double hex_ms = time_ms([&] { hex = BigInt(product.to_string(16), 16); });
+
+        if (decimal != product || hex != product) {
+            std::fprintf(stderr, "conversion mismatch at %zu digits\n", digits);
+            return 1;
+        }
+
+        std::printf("%10zu %14.2f %14.2f %14.2f %14.2f\n", digits, multiply_ms, divide_ms, decimal_ms, hex_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file startup_bench.cpp
+ * @brief Wall time of launching kaynat for --version and for hello world
+ *
+ * Build with -DKAYNAT_BUILD_BENCHMARKS=ON and run startup_bench, optionally
+ * passing the path of another kaynat binary to compare against. Each case
+ * launches the process repeatedly with its output discarded and reports
+ * the median and mean time per launch.
+ */
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+constexpr int RUNS = 200;
+
+/**
+ * @brief Run a command to completion with stdout and stderr discarded
+ * @return Whether it exited with status 0
+ */
+bool run_quietly(const std::vector<std::string>& command) {
+    std::vector<char*> argv;
+    for (const std::string& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+
+    pid_t pid = 0;
+    const int error = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0) {
+        return false;
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool report(const char* name, const std::vector<std::string>& command) {
+    // One untimed launch warms the page cache
+    if (!run_quietly(command)) {
+        std::fprintf(stderr, "%s: %s failed\n", name, command[0].c_str());
+        return false;
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < RUNS; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run_quietly(command);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (double t : times) {
+        total += t;
+    }
+    std::printf("%-12s %12.3f %12.3f\n", name, times[times.size() / 2], total / times.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string kaynat = argc > 1 ? argv[1] : KAYNAT_BINARY;
+
+    std::printf("%-12s %12s %12s\n", "case", "median (ms)", "mean (ms)");
+    bool succeeded = report("--version", {kaynat, "--version"});
+    succeeded = report("hello world", {kaynat, HELLO_WORLD}) && succeeded;
+    return succeeded ? 0 : 1;
+}
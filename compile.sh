@@ -11,12 +11,21 @@ g++ -std=c++17 -Wall -Wextra -Wpedantic -O2 -I./src -o kaynat \
   src/interpreter/interpreter.cpp \
   src/interpreter/environment.cpp \
   src/interpreter/runtime_value.cpp \
+  src/interpreter/operators.cpp \
+  src/interpreter/symbol.cpp \
+  src/compiler/compiler.cpp \
+  src/compiler/optimizer.cpp \
+  src/compiler/resolver.cpp \
+  src/compiler/bytecode.cpp \
+  src/vm/vm.cpp \
   src/errors/messages.cpp \
   src/stdlib/math_tools.cpp \
   src/stdlib/string_tools.cpp \
   src/stdlib/list_tools.cpp \
   src/stdlib/other_tools.cpp \
-  src/gui/gui_system.cpp
+  src/stdlib/registry.cpp \
+  src/gui/gui_system.cpp \
+  src/gui/gui_commands.cpp
 
 if [ $? -eq 0 ]; then
     echo "✓ Compilation successful!"
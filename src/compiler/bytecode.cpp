@@ -0,0 +1,159 @@
+/**
+ * @file bytecode.cpp
+ * @brief Bytecode disassembler
+ */
+
+#include "bytecode.hpp"
+#include <iomanip>
+
+namespace kaynat {
+
+const char* opcode_name(OpCode op) {
+    switch (op) {
+        case OpCode::CONSTANT: return "CONSTANT";
+        case OpCode::PUSH_NULL: return "PUSH_NULL";
+        case OpCode::POP: return "POP";
+        case OpCode::DUP: return "DUP";
+        case OpCode::LOAD_LOCAL: return "LOAD_LOCAL";
+        case OpCode::STORE_LOCAL: return "STORE_LOCAL";
+        case OpCode::DEFINE_LOCAL: return "DEFINE_LOCAL";
+        case OpCode::LOAD_GLOBAL: return "LOAD_GLOBAL";
+        case OpCode::STORE_GLOBAL: return "STORE_GLOBAL";
+        case OpCode::DEFINE_GLOBAL: return "DEFINE_GLOBAL";
+        case OpCode::LOAD_NAME: return "LOAD_NAME";
+        case OpCode::STORE_NAME: return "STORE_NAME";
+        case OpCode::DEFINE_SCOPED: return "DEFINE_SCOPED";
+        case OpCode::ADD: return "ADD";
+        case OpCode::SUBTRACT: return "SUBTRACT";
+        case OpCode::MULTIPLY: return "MULTIPLY";
+        case OpCode::DIVIDE: return "DIVIDE";
+        case OpCode::MODULO: return "MODULO";
+        case OpCode::EQUAL: return "EQUAL";
+        case OpCode::NOT_EQUAL: return "NOT_EQUAL";
+        case OpCode::LESS_THAN: return "LESS_THAN";
+        case OpCode::LESS_EQUAL: return "LESS_EQUAL";
+        case OpCode::GREATER_THAN: return "GREATER_THAN";
+        case OpCode::GREATER_EQUAL: return "GREATER_EQUAL";
+        case OpCode::AND: return "AND";
+        case OpCode::OR: return "OR";
+        case OpCode::NEGATE: return "NEGATE";
+        case OpCode::NOT: return "NOT";
+        case OpCode::JUMP: return "JUMP";
+        case OpCode::JUMP_IF_FALSE: return "JUMP_IF_FALSE";
+        case OpCode::REPEAT_INIT: return "REPEAT_INIT";
+        case OpCode::REPEAT_NEXT: return "REPEAT_NEXT";
+        case OpCode::FOR_EACH_INIT: return "FOR_EACH_INIT";
+        case OpCode::FOR_EACH_NEXT: return "FOR_EACH_NEXT";
+        case OpCode::FOR_EACH_PARALLEL: return "FOR_EACH_PARALLEL";
+        case OpCode::MAKE_FUNCTION: return "MAKE_FUNCTION";
+        case OpCode::CALL: return "CALL";
+        case OpCode::CALL_GLOBAL: return "CALL_GLOBAL";
+        case OpCode::RETURN: return "RETURN";
+        case OpCode::SET_RESULT: return "SET_RESULT";
+        case OpCode::RETURN_RESULT: return "RETURN_RESULT";
+        case OpCode::SPAWN: return "SPAWN";
+        case OpCode::WAIT: return "WAIT";
+        case OpCode::BUILD_LIST: return "BUILD_LIST";
+        case OpCode::BUILD_DICT: return "BUILD_DICT";
+        case OpCode::INDEX: return "INDEX";
+        case OpCode::SAY: return "SAY";
+        case OpCode::GUI: return "GUI";
+    }
+
+    return "UNKNOWN";
+}
+
+namespace {
+
+/**
+ * @brief Describe the operands of one instruction
+ */
+void write_operands(const FunctionProto& proto, const Instruction& instr, std::ostream& out) {
+    switch (instr.op) {
+        case OpCode::CONSTANT:
+            out << instr.a << " (" << proto.constants[instr.a].to_string() << ")";
+            break;
+
+        case OpCode::LOAD_GLOBAL:
+        case OpCode::STORE_GLOBAL:
+        case OpCode::DEFINE_GLOBAL:
+            out << instr.a << " (" << proto.names[instr.a].str() << ")";
+            break;
+
+        case OpCode::LOAD_LOCAL:
+        case OpCode::STORE_LOCAL:
+        case OpCode::DEFINE_LOCAL:
+        case OpCode::DEFINE_SCOPED:
+        case OpCode::REPEAT_INIT:
+        case OpCode::FOR_EACH_INIT:
+        case OpCode::JUMP:
+        case OpCode::JUMP_IF_FALSE:
+            out << instr.a;
+            break;
+
+        case OpCode::LOAD_NAME:
+        case OpCode::STORE_NAME:
+            out << instr.a << " (" << proto.names[proto.references[instr.a].name].str() << ")";
+            break;
+
+        case OpCode::REPEAT_NEXT:
+        case OpCode::FOR_EACH_NEXT:
+            out << instr.a << " slot " << instr.c;
+            break;
+
+        case OpCode::MAKE_FUNCTION:
+        case OpCode::FOR_EACH_PARALLEL:
+            out << instr.a << " (" << proto.functions[instr.a]->name << ")";
+            break;
+
+        case OpCode::CALL:
+        case OpCode::SPAWN:
+        case OpCode::BUILD_LIST:
+        case OpCode::BUILD_DICT:
+        case OpCode::SAY:
+            out << instr.c;
+            break;
+
+        case OpCode::CALL_GLOBAL:
+            out << instr.a << " (" << proto.names[instr.a].str() << ") " << instr.c;
+            break;
+
+        case OpCode::GUI:
+            out << static_cast<int>(instr.b) << " " << proto.names[instr.a].str() << " " << instr.c;
+            break;
+
+        default:
+            break;
+    }
+
+    if ((instr.op == OpCode::CALL || instr.op == OpCode::CALL_GLOBAL) && instr.b != 0) {
+        out << " tail";
+    }
+
+    if ((instr.op == OpCode::STORE_LOCAL || instr.op == OpCode::STORE_GLOBAL ||
+         instr.op == OpCode::STORE_NAME) && instr.b != 0) {
+        out << " constant";
+    }
+}
+
+} // namespace
+
+void disassemble(const FunctionProto& proto, std::ostream& out) {
+    out << "== " << proto.name << " (arity " << proto.arity << ", frame " << proto.frame_size
+        << ", scope " << proto.scope_size << ") ==\n";
+
+    for (size_t i = 0; i < proto.code.size(); ++i) {
+        const Instruction& instr = proto.code[i];
+        out << std::setw(4) << i << "  line " << std::setw(4) << proto.lines[i] << "  "
+            << std::left << std::setw(16) << opcode_name(instr.op) << std::right;
+        write_operands(proto, instr, out);
+        out << "\n";
+    }
+
+    for (const auto& function : proto.functions) {
+        out << "\n";
+        disassemble(*function, out);
+    }
+}
+
+} // namespace kaynat
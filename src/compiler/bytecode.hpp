@@ -0,0 +1,195 @@
+/**
+ * @file bytecode.hpp
+ * @brief Bytecode format for the Kaynat++ virtual machine
+ *
+ * Defines the instruction set, the compact instruction encoding and the
+ * function prototypes produced by the compiler and executed by the VM.
+ */
+
+#pragma once
+
+#include "../interpreter/memo_table.hpp"
+#include "../interpreter/runtime_value.hpp"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace kaynat {
+
+class Environment;
+
+/**
+ * @brief VM instruction opcodes
+ *
+ * Operand usage is documented per opcode as (a, b, c), matching the
+ * fields of Instruction. Stack effects are written as before -- after.
+ */
+enum class OpCode : uint8_t {
+    // Constants and stack
+    CONSTANT,        // a = constant index            -- value
+    PUSH_NULL,       //                               -- null
+    POP,             // value --
+    DUP,             // value -- value value
+
+    // Variables
+    LOAD_LOCAL,      // a = frame slot                -- value
+    STORE_LOCAL,     // a = frame slot, b = constant  value --
+    DEFINE_LOCAL,    // a = frame slot                value --
+    LOAD_GLOBAL,     // a = name index                -- value
+    STORE_GLOBAL,    // a = name index, b = constant  value --
+    DEFINE_GLOBAL,   // a = name index                value --
+    LOAD_NAME,       // a = name reference index      -- value
+    STORE_NAME,      // a = name reference, b = const value --
+    DEFINE_SCOPED,   // a = own scope slot            value --
+
+    // Operators
+    ADD,             //                               left right -- result
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MODULO,
+    EQUAL,
+    NOT_EQUAL,
+    LESS_THAN,
+    LESS_EQUAL,
+    GREATER_THAN,
+    GREATER_EQUAL,
+    AND,
+    OR,
+    NEGATE,          //                               value -- result
+    NOT,
+
+    // Control flow
+    JUMP,            // a = target
+    JUMP_IF_FALSE,   // a = target                    condition --
+    REPEAT_INIT,     // a = counter slot              count --
+    REPEAT_NEXT,     // a = exit target, c = counter slot
+    FOR_EACH_INIT,   // a = iterator slot             iterable --
+    FOR_EACH_NEXT,   // a = exit target, c = iterator slot  -- item
+    FOR_EACH_PARALLEL,  // a = body prototype index   iterable -- results
+
+    // Functions
+    MAKE_FUNCTION,   // a = nested prototype index    -- function
+    CALL,            // b = tail, c = argument count  callee args -- result
+    CALL_GLOBAL,     // a = name index, b = tail, c = argument count  args -- result
+    RETURN,          //                               value --
+    SET_RESULT,      //                               value --
+    RETURN_RESULT,
+
+    // Tasks
+    SPAWN,           // c = argument count            callee args -- task
+    WAIT,            //                               task -- result
+
+    // Collections
+    BUILD_LIST,      // c = element count             elements -- list
+    BUILD_DICT,      // a = first key, c = entry count         values -- dict
+    INDEX,           //                               object index -- value
+
+    // Builtin statements
+    SAY,             // c = argument count            args --
+    GUI              // a = target name index, b = command, c = argument count  args --
+};
+
+/**
+ * @brief Fixed-size 8-byte instruction
+ *
+ * Every instruction carries an opcode, a small 8-bit operand, a 16-bit
+ * operand and a 32-bit operand so that dispatch never decodes
+ * variable-length operands.
+ */
+struct Instruction {
+    OpCode op;
+    uint8_t b;
+    uint16_t c;
+    uint32_t a;
+};
+
+static_assert(sizeof(Instruction) == 8, "Instruction must stay 8 bytes");
+
+/**
+ * @brief Where a variable reference may live at runtime
+ *
+ * Kaynat++ assigns to an existing variable when one is visible and
+ * otherwise defines it in the current scope, so a single name can refer
+ * to several locations depending on what has been defined so far. The
+ * compiler records every candidate location, innermost first; the
+ * global scope is always the final fallback.
+ */
+struct NameLocation {
+    enum class Kind : uint8_t {
+        FRAME,   // Slot in the current call frame
+        OWN,     // Slot in the current frame's captured scope
+        OUTER    // Slot in an enclosing function's captured scope
+    };
+
+    Kind kind;
+    uint32_t depth;  // Scope hops from the closure scope (OUTER only)
+    uint32_t slot;
+};
+
+/**
+ * @brief Resolved variable reference used by LOAD_NAME / STORE_NAME
+ */
+struct NameReference {
+    uint32_t name;                        // Index into FunctionProto::names
+    std::vector<NameLocation> locations;  // Innermost first
+};
+
+/**
+ * @brief Cached result of a global variable lookup
+ *
+ * Valid only while the owning environment and its version match. A null
+ * value records that the name is not defined.
+ */
+struct GlobalCacheEntry {
+    const Environment* owner = nullptr;
+    uint64_t version = 0;
+    KaynatValue* value = nullptr;
+    bool constant = false;
+};
+
+/**
+ * @brief Compiled function (or top-level script)
+ *
+ * Immutable after compilation apart from the per-name global caches,
+ * which the VM fills lazily.
+ */
+struct FunctionProto {
+    std::string name;
+    uint32_t line = 0;
+    uint32_t arity = 0;
+
+    std::vector<Instruction> code;
+    std::vector<uint32_t> lines;           // Source line per instruction
+    std::vector<KaynatValue> constants;
+    std::vector<Symbol> names;             // Global names and error text
+    std::vector<Symbol> keys;              // Dictionary literal keys
+    std::vector<NameReference> references;
+    std::vector<std::shared_ptr<FunctionProto>> functions;
+
+    uint32_t frame_size = 0;               // Frame slots (parameters first)
+    uint32_t scope_size = 0;               // Captured slots
+    std::vector<uint32_t> frame_names;     // Name index per frame slot
+    std::vector<uint32_t> scope_names;     // Name index per captured slot
+    std::vector<uint32_t> param_targets;   // Frame or scope slot per parameter
+    std::vector<bool> param_captured;      // Whether each parameter is captured
+    std::shared_ptr<MemoStats> memo;       // Set when calls are memoized
+
+    mutable std::vector<GlobalCacheEntry> global_cache;  // One entry per name
+};
+
+/**
+ * @brief Write a human-readable listing of a prototype and its children
+ * @param proto Prototype to disassemble
+ * @param out Output stream
+ */
+void disassemble(const FunctionProto& proto, std::ostream& out);
+
+/**
+ * @brief Get the mnemonic for an opcode
+ */
+const char* opcode_name(OpCode op);
+
+} // namespace kaynat
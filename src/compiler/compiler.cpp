@@ -0,0 +1,549 @@
+/**
+ * @file compiler.cpp
+ * @brief Bytecode compiler implementation
+ */
+
+#include "compiler.hpp"
+#include "resolver.hpp"
+#include "../errors/error_types.hpp"
+#include "../gui/gui_commands.hpp"
+#include <limits>
+#include <type_traits>
+
+namespace kaynat {
+
+namespace {
+
+constexpr uint32_t NO_NAME = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+std::shared_ptr<FunctionProto> Compiler::compile(Ast& ast) {
+    Resolver resolver;
+    resolver.resolve(ast);
+
+    ast_ = &ast;
+    const ProgramNode& program = ast.program();
+
+    FunctionScope script;
+    script.is_script = true;
+    script.proto = std::make_shared<FunctionProto>();
+    script.proto->name = "<script>";
+    script.proto->line = program.line;
+    scope_ = &script;
+
+    // Comments are skipped at the top level, so they never become the result
+    std::vector<NodeRef> statements;
+    for (NodeRef stmt : ast.list(program.statements)) {
+        if (!stmt.empty()) {
+            statements.push_back(stmt);
+        }
+    }
+
+    compile_block(NodeSpan(statements.data(), statements.size()), true);
+    emit(OpCode::RETURN_RESULT, program.line);
+    script.proto->global_cache.resize(script.proto->names.size());
+
+    scope_ = nullptr;
+    ast_ = nullptr;
+    return script.proto;
+}
+
+void Compiler::begin_function(FunctionScope& scope, const ScopeLayout& layout) {
+    auto& proto = *scope.proto;
+
+    // Captured slots move to the heap scope, the rest stay in the frame
+    for (size_t i = 0; i < layout.names.size(); ++i) {
+        const uint32_t name = name_index(layout.names[i]);
+        if (layout.captured[i]) {
+            scope.slots.push_back({NameLocation::Kind::OWN, 0, proto.scope_size++});
+            proto.scope_names.push_back(name);
+        } else {
+            scope.slots.push_back({NameLocation::Kind::FRAME, 0, proto.frame_size++});
+            proto.frame_names.push_back(name);
+        }
+    }
+
+    for (size_t i = 0; i < proto.arity; ++i) {
+        proto.param_captured.push_back(scope.slots[i].kind == NameLocation::Kind::OWN);
+        proto.param_targets.push_back(scope.slots[i].slot);
+    }
+}
+
+uint32_t Compiler::name_index(Symbol name) {
+    auto it = scope_->name_indices.find(name);
+    if (it != scope_->name_indices.end()) {
+        return it->second;
+    }
+
+    auto& names = scope_->proto->names;
+    const auto index = static_cast<uint32_t>(names.size());
+    names.push_back(name);
+    scope_->name_indices[name] = index;
+    return index;
+}
+
+uint32_t Compiler::constant_index(const std::string& key, const KaynatValue& value) {
+    auto it = scope_->constant_indices.find(key);
+    if (it != scope_->constant_indices.end()) {
+        return it->second;
+    }
+
+    auto& constants = scope_->proto->constants;
+    const auto index = static_cast<uint32_t>(constants.size());
+    constants.push_back(value);
+    scope_->constant_indices[key] = index;
+    return index;
+}
+
+uint32_t Compiler::hidden_slots(uint32_t count) {
+    auto& proto = *scope_->proto;
+    const uint32_t first = proto.frame_size;
+    proto.frame_size += count;
+    proto.frame_names.insert(proto.frame_names.end(), count, NO_NAME);
+    return first;
+}
+
+bool Compiler::has_own_scope(const FunctionScope& scope) const {
+    return scope.proto->scope_size > 0;
+}
+
+size_t Compiler::emit(OpCode op, uint32_t line, uint32_t a, uint8_t b, uint16_t c) {
+    auto& proto = *scope_->proto;
+    proto.code.push_back(Instruction{op, b, c, a});
+    proto.lines.push_back(line);
+    return proto.code.size() - 1;
+}
+
+void Compiler::patch_jump(size_t at) {
+    auto& proto = *scope_->proto;
+    proto.code[at].a = static_cast<uint32_t>(proto.code.size());
+}
+
+uint16_t Compiler::small_operand(size_t value, uint32_t line) const {
+    if (value > std::numeric_limits<uint16_t>::max()) {
+        throw RuntimeError("Too many operands for a single instruction", line, 0);
+    }
+    return static_cast<uint16_t>(value);
+}
+
+std::vector<NameLocation> Compiler::resolve(const VariableBinding& binding) const {
+    std::vector<NameLocation> locations;
+
+    for (const auto& candidate : binding.candidates) {
+        // Only enclosing functions with a heap scope add a hop at runtime
+        const FunctionScope* target = scope_;
+        uint32_t hops = 0;
+        for (uint32_t d = 0; d < candidate.depth; ++d) {
+            if (d > 0 && has_own_scope(*target)) {
+                hops++;
+            }
+            target = target->enclosing;
+        }
+
+        const NameLocation& location = target->slots[candidate.slot];
+        if (candidate.depth == 0) {
+            locations.push_back(location);
+        } else {
+            locations.push_back({NameLocation::Kind::OUTER, hops, location.slot});
+        }
+    }
+
+    return locations;
+}
+
+void Compiler::emit_load(Symbol name, const VariableBinding& binding, uint32_t line) {
+    auto locations = resolve(binding);
+
+    if (locations.empty()) {
+        emit(OpCode::LOAD_GLOBAL, line, name_index(name));
+    } else if (locations.size() == 1 && locations[0].kind == NameLocation::Kind::FRAME) {
+        emit(OpCode::LOAD_LOCAL, line, locations[0].slot);
+    } else {
+        auto& refs = scope_->proto->references;
+        refs.push_back(NameReference{name_index(name), std::move(locations)});
+        emit(OpCode::LOAD_NAME, line, static_cast<uint32_t>(refs.size() - 1));
+    }
+}
+
+void Compiler::emit_store(Symbol name, const VariableBinding& binding,
+                          bool is_constant, uint32_t line) {
+    auto locations = resolve(binding);
+    const uint8_t flag = is_constant ? 1 : 0;
+
+    if (locations.empty()) {
+        emit(OpCode::STORE_GLOBAL, line, name_index(name), flag);
+    } else if (locations.size() == 1 && locations[0].kind == NameLocation::Kind::FRAME) {
+        emit(OpCode::STORE_LOCAL, line, locations[0].slot, flag);
+    } else {
+        auto& refs = scope_->proto->references;
+        refs.push_back(NameReference{name_index(name), std::move(locations)});
+        emit(OpCode::STORE_NAME, line, static_cast<uint32_t>(refs.size() - 1), flag);
+    }
+}
+
+void Compiler::emit_define(Symbol name, const VariableBinding& binding, uint32_t line) {
+    if (scope_->is_script) {
+        emit(OpCode::DEFINE_GLOBAL, line, name_index(name));
+        return;
+    }
+
+    // Definitions always target the current function
+    const NameLocation& location = scope_->slots[binding.candidates.front().slot];
+    if (location.kind == NameLocation::Kind::FRAME) {
+        emit(OpCode::DEFINE_LOCAL, line, location.slot);
+    } else {
+        emit(OpCode::DEFINE_SCOPED, line, location.slot);
+    }
+}
+
+void Compiler::compile_block(NodeSpan statements, bool tail) {
+    if (statements.empty()) {
+        if (tail) {
+            emit(OpCode::PUSH_NULL, 0);
+            emit(OpCode::SET_RESULT, 0);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < statements.size(); ++i) {
+        compile_statement(statements[i], tail && i + 1 == statements.size());
+    }
+}
+
+void Compiler::compile_statement(NodeRef node, bool tail) {
+    if (node.empty()) {
+        // Comments evaluate to nothing inside blocks
+        if (tail) {
+            emit(OpCode::PUSH_NULL, 0);
+            emit(OpCode::SET_RESULT, 0);
+        }
+        return;
+    }
+
+    if (auto* assign = ast_->get_if<AssignmentNode>(node)) {
+        compile_assignment(*assign, tail);
+    } else if (auto* if_node = ast_->get_if<IfNode>(node)) {
+        compile_if(*if_node, tail);
+    } else if (auto* while_node = ast_->get_if<WhileNode>(node)) {
+        compile_while(*while_node, tail);
+    } else if (auto* repeat = ast_->get_if<RepeatNode>(node)) {
+        compile_repeat(*repeat, tail);
+    } else if (auto* for_each = ast_->get_if<ForEachNode>(node)) {
+        compile_for_each(*for_each, tail);
+    } else if (auto* def = ast_->get_if<FunctionDefNode>(node)) {
+        compile_function_def(*def, tail);
+    } else if (auto* ret = ast_->get_if<ReturnNode>(node)) {
+        // A returned call replaces the running frame, except in the script
+        auto* call = ast_->get_if<FunctionCallNode>(ret->value);
+        if (call != nullptr && !call->is_spawn && !scope_->is_script) {
+            compile_call(*call, true);
+        } else {
+            compile_expression(ret->value);
+        }
+        emit(OpCode::RETURN, ret->line);
+    } else if (auto* block = ast_->get_if<BlockNode>(node)) {
+        compile_block(ast_->list(block->statements), tail);
+    } else if (auto* gui = ast_->get_if<GUINode>(node)) {
+        compile_gui(*gui, tail);
+    } else {
+        compile_expression(node);
+        emit(tail ? OpCode::SET_RESULT : OpCode::POP, 0);
+    }
+}
+
+void Compiler::compile_assignment(const AssignmentNode& node, bool tail) {
+    compile_expression(node.value);
+    if (tail) {
+        emit(OpCode::DUP, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+    emit_store(node.name, node.binding, node.is_constant, node.line);
+}
+
+void Compiler::compile_if(const IfNode& node, bool tail) {
+    compile_expression(node.condition);
+    const size_t to_else = emit(OpCode::JUMP_IF_FALSE, node.line);
+
+    compile_block(ast_->list(node.then_branch), tail);
+    const size_t to_end = emit(OpCode::JUMP, node.line);
+
+    patch_jump(to_else);
+    compile_block(ast_->list(node.else_branch), tail);
+    patch_jump(to_end);
+}
+
+void Compiler::compile_while(const WhileNode& node, bool tail) {
+    if (tail) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+
+    const auto loop_start = static_cast<uint32_t>(scope_->proto->code.size());
+    compile_expression(node.condition);
+    const size_t to_exit = emit(OpCode::JUMP_IF_FALSE, node.line);
+
+    compile_block(ast_->list(node.body), tail && !node.body.empty());
+    emit(OpCode::JUMP, node.line, loop_start);
+    patch_jump(to_exit);
+}
+
+void Compiler::compile_repeat(const RepeatNode& node, bool tail) {
+    if (tail) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+
+    const uint32_t counter = hidden_slots(1);
+    compile_expression(node.count);
+    emit(OpCode::REPEAT_INIT, node.line, counter);
+
+    const auto loop_start = static_cast<uint32_t>(scope_->proto->code.size());
+    const size_t to_exit = emit(OpCode::REPEAT_NEXT, node.line, 0, 0, small_operand(counter, node.line));
+
+    compile_block(ast_->list(node.body), tail && !node.body.empty());
+    emit(OpCode::JUMP, node.line, loop_start);
+    patch_jump(to_exit);
+}
+
+void Compiler::compile_for_each(const ForEachNode& node, bool tail) {
+    if (node.parallel) {
+        compile_parallel_for_each(node, tail);
+        return;
+    }
+
+    if (tail) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+
+    // Two hidden slots: the list being iterated and the next index
+    const uint32_t iterator = hidden_slots(2);
+    compile_expression(node.iterable);
+    emit(OpCode::FOR_EACH_INIT, node.line, iterator);
+
+    const auto loop_start = static_cast<uint32_t>(scope_->proto->code.size());
+    const size_t to_exit = emit(OpCode::FOR_EACH_NEXT, node.line, 0, 0, small_operand(iterator, node.line));
+    emit_store(node.variable, node.binding, false, node.line);
+
+    compile_block(ast_->list(node.body), tail && !node.body.empty());
+    emit(OpCode::JUMP, node.line, loop_start);
+    patch_jump(to_exit);
+}
+
+void Compiler::compile_parallel_for_each(const ForEachNode& node, bool tail) {
+    compile_expression(node.iterable);
+
+    // The body becomes a function of the loop variable, run once per item
+    auto body = std::make_shared<FunctionProto>();
+    body->name = "<parallel for each>";
+    body->line = node.line;
+    body->arity = 1;
+    emit(OpCode::FOR_EACH_PARALLEL, node.line, compile_function(std::move(body), node.layout, node.body, node.line));
+
+    if (node.target.empty()) {
+        emit(tail ? OpCode::SET_RESULT : OpCode::POP, node.line);
+        return;
+    }
+
+    if (tail) {
+        emit(OpCode::DUP, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+    emit_store(node.target, node.target_binding, false, node.line);
+}
+
+void Compiler::compile_function_def(const FunctionDefNode& node, bool tail) {
+    auto proto = std::make_shared<FunctionProto>();
+    proto->name = node.name.str();
+    proto->line = node.line;
+    proto->arity = static_cast<uint32_t>(node.parameters.size());
+    proto->memo = node.memo;
+
+    emit(OpCode::MAKE_FUNCTION, node.line, compile_function(std::move(proto), node.layout, node.body, node.line));
+    emit_define(node.name, node.binding, node.line);
+
+    if (tail) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+}
+
+uint32_t Compiler::compile_function(std::shared_ptr<FunctionProto> proto, const ScopeLayout& layout,
+                                    NodeList body, uint32_t line) {
+    FunctionScope function;
+    function.enclosing = scope_;
+    function.proto = std::move(proto);
+
+    FunctionScope* enclosing = scope_;
+    scope_ = &function;
+    begin_function(function, layout);
+    compile_block(ast_->list(body), true);
+    emit(OpCode::RETURN_RESULT, line);
+    function.proto->global_cache.resize(function.proto->names.size());
+    scope_ = enclosing;
+
+    auto& functions = scope_->proto->functions;
+    functions.push_back(function.proto);
+    return static_cast<uint32_t>(functions.size() - 1);
+}
+
+void Compiler::compile_gui(const GUINode& node, bool tail) {
+    for (NodeRef arg : ast_->list(node.arguments)) {
+        compile_expression(arg);
+    }
+
+    emit(OpCode::GUI, node.line, name_index(node.target),
+         static_cast<uint8_t>(node.command), small_operand(node.arguments.size(), node.line));
+
+    // Created widgets are bound by name in the current scope
+    if (gui_command_defines_target(node.command)) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit_define(node.target, node.binding, node.line);
+    }
+
+    if (tail) {
+        emit(OpCode::PUSH_NULL, node.line);
+        emit(OpCode::SET_RESULT, node.line);
+    }
+}
+
+void Compiler::compile_expression(NodeRef node) {
+    ast_->visit(node, [this](auto& arg) {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, LiteralNode>) {
+            compile_literal(arg);
+        }
+        else if constexpr (std::is_same_v<T, IdentifierNode>) {
+            emit_load(arg.name, arg.binding, arg.line);
+        }
+        else if constexpr (std::is_same_v<T, BinaryOpNode>) {
+            compile_expression(arg.left);
+            compile_expression(arg.right);
+
+            OpCode op = OpCode::ADD;
+            switch (arg.op) {
+                case BinaryOpNode::Op::ADD: op = OpCode::ADD; break;
+                case BinaryOpNode::Op::SUBTRACT: op = OpCode::SUBTRACT; break;
+                case BinaryOpNode::Op::MULTIPLY: op = OpCode::MULTIPLY; break;
+                case BinaryOpNode::Op::DIVIDE: op = OpCode::DIVIDE; break;
+                case BinaryOpNode::Op::MODULO: op = OpCode::MODULO; break;
+                case BinaryOpNode::Op::EQUAL: op = OpCode::EQUAL; break;
+                case BinaryOpNode::Op::NOT_EQUAL: op = OpCode::NOT_EQUAL; break;
+                case BinaryOpNode::Op::LESS_THAN: op = OpCode::LESS_THAN; break;
+                case BinaryOpNode::Op::LESS_EQUAL: op = OpCode::LESS_EQUAL; break;
+                case BinaryOpNode::Op::GREATER_THAN: op = OpCode::GREATER_THAN; break;
+                case BinaryOpNode::Op::GREATER_EQUAL: op = OpCode::GREATER_EQUAL; break;
+                case BinaryOpNode::Op::AND: op = OpCode::AND; break;
+                case BinaryOpNode::Op::OR: op = OpCode::OR; break;
+            }
+            emit(op, arg.line);
+        }
+        else if constexpr (std::is_same_v<T, UnaryOpNode>) {
+            compile_expression(arg.operand);
+            emit(arg.op == UnaryOpNode::Op::NEGATE ? OpCode::NEGATE : OpCode::NOT, arg.line);
+        }
+        else if constexpr (std::is_same_v<T, FunctionCallNode>) {
+            compile_call(arg, false);
+        }
+        else if constexpr (std::is_same_v<T, WaitNode>) {
+            compile_expression(arg.task);
+            emit(OpCode::WAIT, arg.line);
+        }
+        else if constexpr (std::is_same_v<T, ListNode>) {
+            for (NodeRef element : ast_->list(arg.elements)) {
+                compile_expression(element);
+            }
+            emit(OpCode::BUILD_LIST, arg.line, 0, 0, small_operand(arg.elements.size(), arg.line));
+        }
+        else if constexpr (std::is_same_v<T, DictNode>) {
+            // Keys are stored consecutively, already interned
+            auto& keys = scope_->proto->keys;
+            const auto first_key = static_cast<uint32_t>(keys.size());
+            for (const auto& entry : arg.entries) {
+                keys.push_back(entry.first);
+            }
+            for (const auto& entry : arg.entries) {
+                compile_expression(entry.second);
+            }
+            emit(OpCode::BUILD_DICT, arg.line, first_key, 0, small_operand(arg.entries.size(), arg.line));
+        }
+        else if constexpr (std::is_same_v<T, IndexNode>) {
+            compile_expression(arg.object);
+            compile_expression(arg.index);
+            emit(OpCode::INDEX, arg.line);
+        }
+        else if constexpr (std::is_same_v<T, PropertyAccessNode>) {
+            // Property access is not implemented yet and yields nothing
+            emit(OpCode::PUSH_NULL, arg.line);
+        }
+        else {
+            // Statements used as values and empty nodes evaluate to nothing
+            emit(OpCode::PUSH_NULL, 0);
+        }
+    });
+}
+
+void Compiler::compile_literal(const LiteralNode& node) {
+    // The parser has already decoded the value; the source text only
+    // serves to share equal literals within one prototype
+    switch (node.type) {
+        case LiteralNode::Type::INTEGER:
+            emit(OpCode::CONSTANT, node.line, constant_index("i:" + node.value, node.constant));
+            break;
+
+        case LiteralNode::Type::FLOAT:
+            emit(OpCode::CONSTANT, node.line, constant_index("f:" + node.value, node.constant));
+            break;
+
+        case LiteralNode::Type::STRING:
+            emit(OpCode::CONSTANT, node.line, constant_index("s:" + node.value, node.constant));
+            break;
+
+        case LiteralNode::Type::BOOLEAN:
+            emit(OpCode::CONSTANT, node.line, constant_index("b:" + node.value, node.constant));
+            break;
+
+        case LiteralNode::Type::NULL_VALUE:
+            emit(OpCode::PUSH_NULL, node.line);
+            break;
+    }
+}
+
+void Compiler::compile_call(const FunctionCallNode& node, bool tail_call) {
+    if (node.is_say) {
+        for (NodeRef arg : ast_->list(node.arguments)) {
+            compile_expression(arg);
+        }
+        emit(OpCode::SAY, node.line, 0, 0, small_operand(node.arguments.size(), node.line));
+        return;
+    }
+
+    if (node.is_spawn) {
+        emit_load(node.name, node.binding, node.line);
+        for (NodeRef arg : ast_->list(node.arguments)) {
+            compile_expression(arg);
+        }
+        emit(OpCode::SPAWN, node.line, 0, 0, small_operand(node.arguments.size(), node.line));
+        return;
+    }
+
+    // Calls to global functions look the callee up without copying it
+    if (node.binding.candidates.empty()) {
+        for (NodeRef arg : ast_->list(node.arguments)) {
+            compile_expression(arg);
+        }
+        emit(OpCode::CALL_GLOBAL, node.line, name_index(node.name), tail_call ? 1 : 0,
+             small_operand(node.arguments.size(), node.line));
+        return;
+    }
+
+    emit_load(node.name, node.binding, node.line);
+    for (NodeRef arg : ast_->list(node.arguments)) {
+        compile_expression(arg);
+    }
+    emit(OpCode::CALL, node.line, 0, tail_call ? 1 : 0, small_operand(node.arguments.size(), node.line));
+}
+
+} // namespace kaynat
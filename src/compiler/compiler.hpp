@@ -0,0 +1,93 @@
+/**
+ * @file compiler.hpp
+ * @brief AST to bytecode compiler for Kaynat++
+ *
+ * Translates a parsed program into FunctionProto bytecode for the VM.
+ */
+
+#pragma once
+
+#include "bytecode.hpp"
+#include "../parser/ast.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Single-pass bytecode compiler
+ *
+ * Compiles a ProgramNode into a script prototype with one nested
+ * prototype per function definition. The program is first run through
+ * the Resolver; each resolved slot is then placed in the call frame, or
+ * in a heap scope when nested functions capture it.
+ *
+ * Thread-safe: No. Use one compiler per compilation.
+ */
+class Compiler {
+public:
+    /**
+     * @brief Compile a whole program
+     * @param ast Parsed program
+     * @return Prototype of the top-level script
+     * @throws RuntimeError if the program exceeds bytecode limits
+     */
+    std::shared_ptr<FunctionProto> compile(Ast& ast);
+
+private:
+    /**
+     * @brief Compilation state for one function (or the script)
+     */
+    struct FunctionScope {
+        FunctionScope* enclosing = nullptr;
+        std::shared_ptr<FunctionProto> proto;
+        bool is_script = false;
+        std::vector<NameLocation> slots;  // VM location per resolver slot
+        std::unordered_map<Symbol, uint32_t> name_indices;
+        std::unordered_map<std::string, uint32_t> constant_indices;
+    };
+
+    Ast* ast_ = nullptr;
+    FunctionScope* scope_ = nullptr;
+
+    // Scope management
+    void begin_function(FunctionScope& scope, const ScopeLayout& layout);
+    uint32_t name_index(Symbol name);
+    uint32_t constant_index(const std::string& key, const KaynatValue& value);
+    uint32_t hidden_slots(uint32_t count);
+    bool has_own_scope(const FunctionScope& scope) const;
+
+    // Emission helpers
+    size_t emit(OpCode op, uint32_t line, uint32_t a = 0, uint8_t b = 0, uint16_t c = 0);
+    void patch_jump(size_t at);
+    uint16_t small_operand(size_t value, uint32_t line) const;
+
+    // Variable access
+    void emit_load(Symbol name, const VariableBinding& binding, uint32_t line);
+    void emit_store(Symbol name, const VariableBinding& binding, bool is_constant, uint32_t line);
+    void emit_define(Symbol name, const VariableBinding& binding, uint32_t line);
+    std::vector<NameLocation> resolve(const VariableBinding& binding) const;
+
+    // Statements
+    void compile_block(NodeSpan statements, bool tail);
+    void compile_statement(NodeRef node, bool tail);
+    void compile_assignment(const AssignmentNode& node, bool tail);
+    void compile_if(const IfNode& node, bool tail);
+    void compile_while(const WhileNode& node, bool tail);
+    void compile_repeat(const RepeatNode& node, bool tail);
+    void compile_for_each(const ForEachNode& node, bool tail);
+    void compile_parallel_for_each(const ForEachNode& node, bool tail);
+    void compile_function_def(const FunctionDefNode& node, bool tail);
+    uint32_t compile_function(std::shared_ptr<FunctionProto> proto, const ScopeLayout& layout,
+                              NodeList body, uint32_t line);
+    void compile_gui(const GUINode& node, bool tail);
+
+    // Expressions
+    void compile_expression(NodeRef node);
+    void compile_literal(const LiteralNode& node);
+    void compile_call(const FunctionCallNode& node, bool tail_call);
+};
+
+} // namespace kaynat
@@ -0,0 +1,240 @@
+/**
+ * @file optimizer.cpp
+ * @brief Optimizer implementation
+ */
+
+#include "optimizer.hpp"
+#include "purity.hpp"
+#include "resolver.hpp"
+#include "../errors/error_types.hpp"
+#include "../gui/gui_commands.hpp"
+#include "../interpreter/operators.hpp"
+#include <cstdio>
+#include <optional>
+#include <type_traits>
+
+namespace kaynat {
+
+namespace {
+
+/**
+ * @brief Build a literal node holding a computed value
+ * @return Nothing if the value has no literal form
+ */
+std::optional<LiteralNode> make_literal(const KaynatValue& value, uint32_t line) {
+    LiteralNode node{};
+    node.constant = value;
+    node.line = line;
+
+    // The text keys the compiler's constant pool, so it must identify
+    // the value exactly
+    if (auto i = value.as_int()) {
+        node.type = LiteralNode::Type::INTEGER;
+        node.value = std::to_string(*i);
+    } else if (auto* big = value.as_bigint_ptr()) {
+        node.type = LiteralNode::Type::INTEGER;
+        node.value = big->to_string();
+    } else if (auto d = value.as_float()) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", *d);
+        node.type = LiteralNode::Type::FLOAT;
+        node.value = buffer;
+    } else if (auto b = value.as_bool()) {
+        node.type = LiteralNode::Type::BOOLEAN;
+        node.value = *b ? "true" : "false";
+    } else if (auto* s = value.as_string_ptr()) {
+        node.type = LiteralNode::Type::STRING;
+        node.value = *s;
+    } else if (value.is_null()) {
+        node.type = LiteralNode::Type::NULL_VALUE;
+        node.value = "null";
+    } else {
+        return std::nullopt;
+    }
+
+    return node;
+}
+
+/**
+ * @brief Count statements that write each name, at any depth
+ */
+void count_writes(Ast& ast, NodeList statements,
+                  std::unordered_map<Symbol, size_t>& out) {
+    for (NodeRef stmt : ast.list(statements)) {
+        if (auto* assign = ast.get_if<AssignmentNode>(stmt)) {
+            ++out[assign->name];
+        } else if (auto* def = ast.get_if<FunctionDefNode>(stmt)) {
+            ++out[def->name];
+            count_writes(ast, def->body, out);
+        } else if (auto* gui = ast.get_if<GUINode>(stmt)) {
+            if (gui_command_defines_target(gui->command)) ++out[gui->target];
+        } else if (auto* if_node = ast.get_if<IfNode>(stmt)) {
+            count_writes(ast, if_node->then_branch, out);
+            count_writes(ast, if_node->else_branch, out);
+        } else if (auto* while_node = ast.get_if<WhileNode>(stmt)) {
+            count_writes(ast, while_node->body, out);
+        } else if (auto* repeat = ast.get_if<RepeatNode>(stmt)) {
+            count_writes(ast, repeat->body, out);
+        } else if (auto* for_each = ast.get_if<ForEachNode>(stmt)) {
+            ++out[for_each->variable];
+            if (!for_each->target.empty()) ++out[for_each->target];
+            count_writes(ast, for_each->body, out);
+        } else if (auto* block = ast.get_if<BlockNode>(stmt)) {
+            count_writes(ast, block->statements, out);
+        }
+    }
+}
+
+} // namespace
+
+void Optimizer::optimize(Ast& ast) {
+    ast_ = &ast;
+    writes_.clear();
+    constants_.clear();
+
+    // Bindings tell which identifiers may refer to function locals
+    Resolver resolver;
+    resolver.resolve(ast);
+
+    count_writes(ast, ast.program().statements, writes_);
+    optimize_statements(ast.program().statements, true);
+    ast_ = nullptr;
+
+    if (whole_program_) {
+        PurityAnalysis purity;
+        purity.analyze(ast);
+    }
+}
+
+void Optimizer::optimize_statements(NodeList statements, bool top_level) {
+    for (NodeRef& stmt : ast_->list(statements)) {
+        optimize_node(stmt);
+
+        if (top_level) {
+            if (auto* assign = ast_->get_if<AssignmentNode>(stmt); assign && assign->is_constant) {
+                record_constant(*assign);
+            }
+        }
+    }
+}
+
+void Optimizer::optimize_node(NodeRef& node) {
+    // Replaced nodes stay in the arena, unreferenced, until it is freed
+    std::optional<NodeRef> replacement = ast_->visit(node, [this](auto& arg) -> std::optional<NodeRef> {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, IdentifierNode>) {
+            auto it = constants_.find(arg.name);
+            if (it != constants_.end() && arg.binding.candidates.empty()) {
+                LiteralNode literal = ast_->get<LiteralNode>(it->second);
+                literal.line = arg.line;
+                return ast_->add(std::move(literal));
+            }
+        }
+        else if constexpr (std::is_same_v<T, BinaryOpNode>) {
+            optimize_node(arg.left);
+            optimize_node(arg.right);
+
+            auto left = ast_->get_if<LiteralNode>(arg.left);
+            auto right = ast_->get_if<LiteralNode>(arg.right);
+            if (left && right) {
+                try {
+                    auto folded = make_literal(ops::binary(arg.op, left->constant, right->constant, arg.line),
+                                               arg.line);
+                    if (folded) return ast_->add(std::move(*folded));
+                } catch (const KaynatError&) {
+                    // Leave the error to be raised at runtime
+                }
+            }
+        }
+        else if constexpr (std::is_same_v<T, UnaryOpNode>) {
+            optimize_node(arg.operand);
+
+            if (auto operand = ast_->get_if<LiteralNode>(arg.operand)) {
+                try {
+                    auto folded = make_literal(ops::unary(arg.op, operand->constant, arg.line), arg.line);
+                    if (folded) return ast_->add(std::move(*folded));
+                } catch (const KaynatError&) {
+                    // Leave the error to be raised at runtime
+                }
+            }
+        }
+        else if constexpr (std::is_same_v<T, AssignmentNode>) {
+            optimize_node(arg.value);
+        }
+        else if constexpr (std::is_same_v<T, IfNode>) {
+            optimize_node(arg.condition);
+            optimize_statements(arg.then_branch, false);
+            optimize_statements(arg.else_branch, false);
+
+            if (auto condition = ast_->get_if<LiteralNode>(arg.condition)) {
+                // A block evaluates like the branch it replaces
+                BlockNode block{};
+                block.statements = condition->constant.is_truthy() ? arg.then_branch : arg.else_branch;
+                block.line = arg.line;
+                return ast_->add(std::move(block));
+            }
+        }
+        else if constexpr (std::is_same_v<T, WhileNode>) {
+            optimize_node(arg.condition);
+            optimize_statements(arg.body, false);
+        }
+        else if constexpr (std::is_same_v<T, RepeatNode>) {
+            optimize_node(arg.count);
+            optimize_statements(arg.body, false);
+        }
+        else if constexpr (std::is_same_v<T, ForEachNode>) {
+            optimize_node(arg.iterable);
+            optimize_statements(arg.body, false);
+        }
+        else if constexpr (std::is_same_v<T, FunctionDefNode>) {
+            optimize_statements(arg.body, false);
+        }
+        else if constexpr (std::is_same_v<T, FunctionCallNode>) {
+            for (NodeRef& a : ast_->list(arg.arguments)) optimize_node(a);
+        }
+        else if constexpr (std::is_same_v<T, ReturnNode>) {
+            optimize_node(arg.value);
+        }
+        else if constexpr (std::is_same_v<T, ListNode>) {
+            for (NodeRef& e : ast_->list(arg.elements)) optimize_node(e);
+        }
+        else if constexpr (std::is_same_v<T, DictNode>) {
+            for (auto& entry : arg.entries) optimize_node(entry.second);
+        }
+        else if constexpr (std::is_same_v<T, IndexNode>) {
+            optimize_node(arg.object);
+            optimize_node(arg.index);
+        }
+        else if constexpr (std::is_same_v<T, PropertyAccessNode>) {
+            optimize_node(arg.object);
+        }
+        else if constexpr (std::is_same_v<T, BlockNode>) {
+            optimize_statements(arg.statements, false);
+        }
+        else if constexpr (std::is_same_v<T, GUINode>) {
+            for (NodeRef& a : ast_->list(arg.arguments)) optimize_node(a);
+        }
+        else if constexpr (std::is_same_v<T, WaitNode>) {
+            optimize_node(arg.task);
+        }
+
+        return std::nullopt;
+    });
+
+    if (replacement) {
+        node = std::move(*replacement);
+    }
+}
+
+void Optimizer::record_constant(const AssignmentNode& node) {
+    if (writes_[node.name] != 1) {
+        return;
+    }
+
+    if (node.value.kind() == NodeKind::LITERAL) {
+        constants_[node.name] = node.value;
+    }
+}
+
+} // namespace kaynat
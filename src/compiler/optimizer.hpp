@@ -0,0 +1,70 @@
+/**
+ * @file optimizer.hpp
+ * @brief AST optimization passes for Kaynat++
+ *
+ * Rewrites a parsed program before execution: folds constant operator
+ * subtrees, substitutes `always` constants, drops if branches whose
+ * condition is known statically and memoizes pure recursive functions.
+ */
+
+#pragma once
+
+#include "../parser/ast.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Optimization level selected with -O0/-O1
+ */
+enum class OptLevel {
+    O0,  // Run the program as parsed
+    O1   // Constant folding, constant propagation, dead-branch elimination, memoization
+};
+
+/**
+ * @brief Semantics-preserving AST optimizer
+ *
+ * Operators are folded through ops::binary/ops::unary, so folded results
+ * match both engines exactly. An operation that would fail (division by
+ * zero, a type error) is left in place to raise its error at runtime.
+ *
+ * A constant is propagated only when it is declared with `always` at the
+ * top level of the program and nothing else in the program writes that
+ * name. Its uses are replaced in later statements where the name cannot
+ * refer to a function local.
+ *
+ * Given a whole program, it also runs the PurityAnalysis, which gives
+ * pure recursive functions a result cache. A REPL line is not a whole
+ * program, since later lines may reassign the globals it relies on.
+ *
+ * Thread-safe: No. Use one optimizer per program.
+ */
+class Optimizer {
+public:
+    /**
+     * @param whole_program Whether optimize() sees every statement that will run
+     */
+    explicit Optimizer(bool whole_program = true) : whole_program_(whole_program) {}
+
+    /**
+     * @brief Optimize a program in place
+     * @param ast Parsed program
+     */
+    void optimize(Ast& ast);
+
+private:
+    bool whole_program_;
+    Ast* ast_ = nullptr;
+    std::unordered_map<Symbol, size_t> writes_;
+    std::unordered_map<Symbol, NodeRef> constants_;  // Literal per propagated name
+
+    void optimize_statements(NodeList statements, bool top_level);
+    void optimize_node(NodeRef& node);
+    void record_constant(const AssignmentNode& node);
+};
+
+} // namespace kaynat
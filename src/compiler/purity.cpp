@@ -0,0 +1,243 @@
+/**
+ * @file purity.cpp
+ * @brief PurityAnalysis implementation
+ */
+
+#include "purity.hpp"
+#include "../gui/gui_commands.hpp"
+#include "../stdlib/stdlib.hpp"
+#include <memory>
+#include <type_traits>
+
+namespace kaynat {
+
+void PurityAnalysis::analyze(Ast& ast) {
+    ast_ = &ast;
+    writes_.clear();
+    global_writes_.clear();
+    constants_.clear();
+    functions_.clear();
+
+    collect_writes(ast.program().statements, true);
+
+    for (NodeRef stmt : ast.list(ast.program().statements)) {
+        auto* def = ast.get_if<FunctionDefNode>(stmt);
+        if (def == nullptr || writes_[def->name] != 1 || stdlib::find_builtin(def->name.str())) {
+            continue;
+        }
+
+        Function& function = functions_[def->name];
+        function.node = def;
+        function.params.insert(def->parameters.begin(), def->parameters.end());
+        function.locals.insert(def->layout.names.begin(), def->layout.names.end());
+    }
+
+    for (auto& entry : functions_) {
+        Function& function = entry.second;
+        function.pure = check_statements(function, function.node->body);
+    }
+
+    // A function calling an impure one is impure; repeat until stable so
+    // that the result holds across mutual recursion
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto& entry : functions_) {
+            Function& function = entry.second;
+            if (!function.pure) continue;
+            for (const Call& call : function.calls) {
+                if (!functions_.at(call.callee).pure) {
+                    function.pure = false;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (auto& entry : functions_) {
+        Function& function = entry.second;
+        if (function.pure && !function.node->memo && recursive(function)) {
+            function.node->memo = std::make_shared<MemoStats>();
+        }
+    }
+
+    ast_ = nullptr;
+}
+
+void PurityAnalysis::collect_writes(NodeList statements, bool top_level) {
+    auto note = [&](Symbol name) {
+        ++writes_[name];
+        if (top_level) ++global_writes_[name];
+    };
+
+    for (NodeRef stmt : ast_->list(statements)) {
+        if (auto* assign = ast_->get_if<AssignmentNode>(stmt)) {
+            note(assign->name);
+            if (top_level && assign->is_constant) constants_.insert(assign->name);
+        } else if (auto* def = ast_->get_if<FunctionDefNode>(stmt)) {
+            note(def->name);
+            collect_writes(def->body, false);
+        } else if (auto* gui = ast_->get_if<GUINode>(stmt)) {
+            if (gui_command_defines_target(gui->command)) note(gui->target);
+        } else if (auto* if_node = ast_->get_if<IfNode>(stmt)) {
+            collect_writes(if_node->then_branch, top_level);
+            collect_writes(if_node->else_branch, top_level);
+        } else if (auto* while_node = ast_->get_if<WhileNode>(stmt)) {
+            collect_writes(while_node->body, top_level);
+        } else if (auto* repeat = ast_->get_if<RepeatNode>(stmt)) {
+            collect_writes(repeat->body, top_level);
+        } else if (auto* for_each = ast_->get_if<ForEachNode>(stmt)) {
+            note(for_each->variable);
+            if (!for_each->target.empty()) note(for_each->target);
+            collect_writes(for_each->body, top_level && !for_each->parallel);
+        } else if (auto* block = ast_->get_if<BlockNode>(stmt)) {
+            collect_writes(block->statements, top_level);
+        }
+    }
+
+    if (top_level) {
+        // Only a name written once can be relied on to stay constant
+        for (auto it = constants_.begin(); it != constants_.end();) {
+            it = writes_[*it] == 1 ? std::next(it) : constants_.erase(it);
+        }
+    }
+}
+
+bool PurityAnalysis::check_statements(Function& function, NodeList statements) {
+    for (NodeRef stmt : ast_->list(statements)) {
+        if (!check_node(function, stmt)) return false;
+    }
+    return true;
+}
+
+bool PurityAnalysis::check_node(Function& function, NodeRef node) {
+    return ast_->visit(node, [this, &function](auto& arg) -> bool {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, IdentifierNode>) {
+            return readable(function, arg.name);
+        }
+        else if constexpr (std::is_same_v<T, BinaryOpNode>) {
+            return check_node(function, arg.left) && check_node(function, arg.right);
+        }
+        else if constexpr (std::is_same_v<T, UnaryOpNode>) {
+            return check_node(function, arg.operand);
+        }
+        else if constexpr (std::is_same_v<T, AssignmentNode>) {
+            return writable(function, arg.name) && check_node(function, arg.value);
+        }
+        else if constexpr (std::is_same_v<T, IfNode>) {
+            return check_node(function, arg.condition) && check_statements(function, arg.then_branch) &&
+                   check_statements(function, arg.else_branch);
+        }
+        else if constexpr (std::is_same_v<T, WhileNode>) {
+            return check_node(function, arg.condition) && check_statements(function, arg.body);
+        }
+        else if constexpr (std::is_same_v<T, RepeatNode>) {
+            return check_node(function, arg.count) && check_statements(function, arg.body);
+        }
+        else if constexpr (std::is_same_v<T, ForEachNode>) {
+            // Names of a parallel body are not locals of the function
+            if (arg.parallel) return false;
+            return writable(function, arg.variable) && check_node(function, arg.iterable) &&
+                   check_statements(function, arg.body);
+        }
+        else if constexpr (std::is_same_v<T, FunctionCallNode>) {
+            return check_call(function, arg, false);
+        }
+        else if constexpr (std::is_same_v<T, ReturnNode>) {
+            if (auto* call = ast_->get_if<FunctionCallNode>(arg.value)) {
+                return check_call(function, *call, true);
+            }
+            return check_node(function, arg.value);
+        }
+        else if constexpr (std::is_same_v<T, ListNode>) {
+            for (NodeRef e : ast_->list(arg.elements)) {
+                if (!check_node(function, e)) return false;
+            }
+            return true;
+        }
+        else if constexpr (std::is_same_v<T, DictNode>) {
+            for (const auto& entry : arg.entries) {
+                if (!check_node(function, entry.second)) return false;
+            }
+            return true;
+        }
+        else if constexpr (std::is_same_v<T, IndexNode>) {
+            return check_node(function, arg.object) && check_node(function, arg.index);
+        }
+        else if constexpr (std::is_same_v<T, PropertyAccessNode>) {
+            return check_node(function, arg.object);
+        }
+        else if constexpr (std::is_same_v<T, BlockNode>) {
+            return check_statements(function, arg.statements);
+        }
+        else if constexpr (std::is_same_v<T, FunctionDefNode> || std::is_same_v<T, GUINode> ||
+                           std::is_same_v<T, WaitNode> || std::is_same_v<T, ProgramNode>) {
+            return false;
+        }
+        else {
+            // Literals and empty statements
+            return true;
+        }
+    });
+}
+
+bool PurityAnalysis::check_call(Function& function, const FunctionCallNode& node, bool tail) {
+    if (node.is_say || node.is_spawn || function.locals.count(node.name)) {
+        return false;
+    }
+
+    if (functions_.count(node.name)) {
+        function.calls.push_back(Call{node.name, tail});
+    } else {
+        const stdlib::Builtin* builtin = stdlib::find_builtin(node.name.str());
+        if (builtin == nullptr || !builtin->pure || writes_.count(node.name)) {
+            return false;
+        }
+    }
+
+    for (NodeRef arg : ast_->list(node.arguments)) {
+        if (!check_node(function, arg)) return false;
+    }
+    return true;
+}
+
+bool PurityAnalysis::writable(const Function& function, Symbol name) const {
+    if (function.params.count(name)) {
+        return true;
+    }
+
+    // Assignment updates a global of the same name when one exists
+    return !global_writes_.count(name) && !stdlib::find_builtin(name.str());
+}
+
+bool PurityAnalysis::readable(const Function& function, Symbol name) const {
+    if (function.locals.count(name)) {
+        return writable(function, name);
+    }
+
+    if (constants_.count(name) || functions_.count(name)) {
+        return true;
+    }
+    return stdlib::find_builtin(name.str()) && !writes_.count(name);
+}
+
+bool PurityAnalysis::recursive(const Function& function) const {
+    std::vector<const Function*> pending{&function};
+    std::unordered_set<const Function*> seen;
+
+    while (!pending.empty()) {
+        const Function* current = pending.back();
+        pending.pop_back();
+        for (const Call& call : current->calls) {
+            if (call.tail) continue;
+            const Function* next = &functions_.at(call.callee);
+            if (next == &function) return true;
+            if (seen.insert(next).second) pending.push_back(next);
+        }
+    }
+    return false;
+}
+
+} // namespace kaynat
@@ -0,0 +1,85 @@
+/**
+ * @file purity.hpp
+ * @brief Purity analysis of user functions for Kaynat++
+ *
+ * Finds functions whose result depends only on their arguments, so that
+ * repeated calls can be answered from a result cache.
+ */
+
+#pragma once
+
+#include "../parser/ast.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Marks pure recursive functions of a program for memoization
+ *
+ * A function defined once at the top level is pure when its body
+ * - has no say statement, GUI command or nested function definition,
+ * - assigns only its parameters or locals whose names no top-level
+ *   statement or builtin uses, so no write can reach a global,
+ * - reads only such names, `always` constants, functions of the program
+ *   and builtins the program never reassigns, and
+ * - calls only builtins without side effects (no file, network, clock or
+ *   random access) and other pure functions.
+ *
+ * A function that can reach itself through calls to pure functions gets
+ * a result cache (FunctionDefNode::memo). Only calls outside tail
+ * position count: tail recursion is a loop whose intermediate results
+ * are never asked for again. Pure functions that are not recursive are
+ * left alone, since a cache lookup would cost about as much as running
+ * them.
+ *
+ * The analysis needs the whole program: a later REPL line could reassign
+ * a global that a function relies on.
+ *
+ * Thread-safe: No. Use one analysis per program.
+ */
+class PurityAnalysis {
+public:
+    /**
+     * @brief Memoize the pure recursive functions of a resolved program
+     * @param ast Whole program, already run through the Resolver
+     */
+    void analyze(Ast& ast);
+
+private:
+    /**
+     * @brief Call from one candidate function to another
+     */
+    struct Call {
+        Symbol callee;
+        bool tail;  // Made by "give back call ..."
+    };
+
+    /**
+     * @brief Facts gathered for one candidate function
+     */
+    struct Function {
+        FunctionDefNode* node = nullptr;
+        std::unordered_set<Symbol> params;
+        std::unordered_set<Symbol> locals;  // Every name with a slot, parameters included
+        std::vector<Call> calls;            // Calls to program functions
+        bool pure = true;
+    };
+
+    Ast* ast_ = nullptr;
+    std::unordered_map<Symbol, size_t> writes_;         // At any depth
+    std::unordered_map<Symbol, size_t> global_writes_;  // Outside function bodies
+    std::unordered_set<Symbol> constants_;
+    std::unordered_map<Symbol, Function> functions_;
+
+    void collect_writes(NodeList statements, bool top_level);
+    bool check_statements(Function& function, NodeList statements);
+    bool check_node(Function& function, NodeRef node);
+    bool check_call(Function& function, const FunctionCallNode& node, bool tail);
+    bool writable(const Function& function, Symbol name) const;
+    bool readable(const Function& function, Symbol name) const;
+    bool recursive(const Function& function) const;
+};
+
+} // namespace kaynat
@@ -0,0 +1,341 @@
+/**
+ * @file resolver.cpp
+ * @brief Resolver implementation
+ */
+
+#include "resolver.hpp"
+#include "../gui/gui_commands.hpp"
+#include <algorithm>
+#include <type_traits>
+
+namespace kaynat {
+
+namespace {
+
+void collect_declarations(Ast& ast, NodeList statements,
+                          std::unordered_set<Symbol>& out);
+
+/**
+ * @brief Collect names a statement binds in the current function
+ */
+void collect_declarations(Ast& ast, NodeRef node, std::unordered_set<Symbol>& out) {
+    if (auto* assign = ast.get_if<AssignmentNode>(node)) {
+        out.insert(assign->name);
+    } else if (auto* def = ast.get_if<FunctionDefNode>(node)) {
+        out.insert(def->name);
+    } else if (auto* gui = ast.get_if<GUINode>(node)) {
+        if (gui_command_defines_target(gui->command)) out.insert(gui->target);
+    } else if (auto* if_node = ast.get_if<IfNode>(node)) {
+        collect_declarations(ast, if_node->then_branch, out);
+        collect_declarations(ast, if_node->else_branch, out);
+    } else if (auto* while_node = ast.get_if<WhileNode>(node)) {
+        collect_declarations(ast, while_node->body, out);
+    } else if (auto* repeat = ast.get_if<RepeatNode>(node)) {
+        collect_declarations(ast, repeat->body, out);
+    } else if (auto* for_each = ast.get_if<ForEachNode>(node)) {
+        // A parallel body has a scope of its own
+        if (!for_each->parallel) {
+            out.insert(for_each->variable);
+            collect_declarations(ast, for_each->body, out);
+        } else if (!for_each->target.empty()) {
+            out.insert(for_each->target);
+        }
+    } else if (auto* block = ast.get_if<BlockNode>(node)) {
+        collect_declarations(ast, block->statements, out);
+    }
+}
+
+void collect_declarations(Ast& ast, NodeList statements,
+                          std::unordered_set<Symbol>& out) {
+    for (NodeRef stmt : ast.list(statements)) {
+        collect_declarations(ast, stmt, out);
+    }
+}
+
+void collect_free_names(Ast& ast, const std::vector<Symbol>& params, NodeList body,
+                        std::unordered_set<Symbol>& out);
+
+/**
+ * @brief Collect names looked up or assigned by a node, excluding nested
+ *        function bodies but including the free names of those functions
+ */
+void collect_references(Ast& ast, NodeRef node, std::unordered_set<Symbol>& out) {
+    ast.visit(node, [&ast, &out](auto& arg) {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, IdentifierNode>) {
+            out.insert(arg.name);
+        }
+        else if constexpr (std::is_same_v<T, BinaryOpNode>) {
+            collect_references(ast, arg.left, out);
+            collect_references(ast, arg.right, out);
+        }
+        else if constexpr (std::is_same_v<T, UnaryOpNode>) {
+            collect_references(ast, arg.operand, out);
+        }
+        else if constexpr (std::is_same_v<T, AssignmentNode>) {
+            out.insert(arg.name);
+            collect_references(ast, arg.value, out);
+        }
+        else if constexpr (std::is_same_v<T, IfNode>) {
+            collect_references(ast, arg.condition, out);
+            for (NodeRef stmt : ast.list(arg.then_branch)) collect_references(ast, stmt, out);
+            for (NodeRef stmt : ast.list(arg.else_branch)) collect_references(ast, stmt, out);
+        }
+        else if constexpr (std::is_same_v<T, WhileNode>) {
+            collect_references(ast, arg.condition, out);
+            for (NodeRef stmt : ast.list(arg.body)) collect_references(ast, stmt, out);
+        }
+        else if constexpr (std::is_same_v<T, RepeatNode>) {
+            collect_references(ast, arg.count, out);
+            for (NodeRef stmt : ast.list(arg.body)) collect_references(ast, stmt, out);
+        }
+        else if constexpr (std::is_same_v<T, ForEachNode>) {
+            collect_references(ast, arg.iterable, out);
+            if (arg.parallel) {
+                if (!arg.target.empty()) out.insert(arg.target);
+                collect_free_names(ast, {arg.variable}, arg.body, out);
+            } else {
+                out.insert(arg.variable);
+                for (NodeRef stmt : ast.list(arg.body)) collect_references(ast, stmt, out);
+            }
+        }
+        else if constexpr (std::is_same_v<T, FunctionDefNode>) {
+            collect_free_names(ast, arg.parameters, arg.body, out);
+        }
+        else if constexpr (std::is_same_v<T, FunctionCallNode>) {
+            if (!arg.is_say) out.insert(arg.name);
+            for (NodeRef a : ast.list(arg.arguments)) collect_references(ast, a, out);
+        }
+        else if constexpr (std::is_same_v<T, ReturnNode>) {
+            collect_references(ast, arg.value, out);
+        }
+        else if constexpr (std::is_same_v<T, ListNode>) {
+            for (NodeRef e : ast.list(arg.elements)) collect_references(ast, e, out);
+        }
+        else if constexpr (std::is_same_v<T, DictNode>) {
+            for (const auto& entry : arg.entries) collect_references(ast, entry.second, out);
+        }
+        else if constexpr (std::is_same_v<T, IndexNode>) {
+            collect_references(ast, arg.object, out);
+            collect_references(ast, arg.index, out);
+        }
+        else if constexpr (std::is_same_v<T, BlockNode>) {
+            for (NodeRef stmt : ast.list(arg.statements)) collect_references(ast, stmt, out);
+        }
+        else if constexpr (std::is_same_v<T, GUINode>) {
+            for (NodeRef a : ast.list(arg.arguments)) collect_references(ast, a, out);
+        }
+        else if constexpr (std::is_same_v<T, WaitNode>) {
+            collect_references(ast, arg.task, out);
+        }
+    });
+}
+
+/**
+ * @brief Collect the names a function body (or parallel loop body) may
+ *        resolve in an enclosing scope
+ *
+ * Parameters always shadow outer names, so they are excluded.
+ */
+void collect_free_names(Ast& ast, const std::vector<Symbol>& params, NodeList body,
+                        std::unordered_set<Symbol>& out) {
+    std::unordered_set<Symbol> names;
+    for (NodeRef stmt : ast.list(body)) {
+        collect_references(ast, stmt, names);
+    }
+    for (const auto& param : params) {
+        names.erase(param);
+    }
+    out.insert(names.begin(), names.end());
+}
+
+/**
+ * @brief Collect the free names of function definitions among the
+ *        statements
+ */
+void collect_free_names(Ast& ast, NodeList statements,
+                        std::unordered_set<Symbol>& out) {
+    for (NodeRef stmt : ast.list(statements)) {
+        // Function definitions may sit inside control flow
+        if (auto* def = ast.get_if<FunctionDefNode>(stmt)) {
+            collect_free_names(ast, def->parameters, def->body, out);
+        } else if (auto* if_node = ast.get_if<IfNode>(stmt)) {
+            collect_free_names(ast, if_node->then_branch, out);
+            collect_free_names(ast, if_node->else_branch, out);
+        } else if (auto* while_node = ast.get_if<WhileNode>(stmt)) {
+            collect_free_names(ast, while_node->body, out);
+        } else if (auto* repeat = ast.get_if<RepeatNode>(stmt)) {
+            collect_free_names(ast, repeat->body, out);
+        } else if (auto* for_each = ast.get_if<ForEachNode>(stmt)) {
+            if (for_each->parallel) {
+                collect_free_names(ast, {for_each->variable}, for_each->body, out);
+            } else {
+                collect_free_names(ast, for_each->body, out);
+            }
+        } else if (auto* block = ast.get_if<BlockNode>(stmt)) {
+            collect_free_names(ast, block->statements, out);
+        }
+    }
+}
+
+} // namespace
+
+void Resolver::resolve(Ast& ast) {
+    ast_ = &ast;
+    scope_ = nullptr;
+    resolve_statements(ast.program().statements);
+    ast_ = nullptr;
+}
+
+void Resolver::resolve_statements(NodeList statements) {
+    for (NodeRef stmt : ast_->list(statements)) {
+        resolve_node(stmt);
+    }
+}
+
+void Resolver::resolve_node(NodeRef node) {
+    ast_->visit(node, [this](auto& arg) {
+        using T = std::decay_t<decltype(arg)>;
+
+        if constexpr (std::is_same_v<T, IdentifierNode>) {
+            bind(arg.name, arg.binding);
+        }
+        else if constexpr (std::is_same_v<T, BinaryOpNode>) {
+            resolve_node(arg.left);
+            resolve_node(arg.right);
+        }
+        else if constexpr (std::is_same_v<T, UnaryOpNode>) {
+            resolve_node(arg.operand);
+        }
+        else if constexpr (std::is_same_v<T, AssignmentNode>) {
+            resolve_node(arg.value);
+            bind(arg.name, arg.binding);
+        }
+        else if constexpr (std::is_same_v<T, IfNode>) {
+            resolve_node(arg.condition);
+            resolve_statements(arg.then_branch);
+            resolve_statements(arg.else_branch);
+        }
+        else if constexpr (std::is_same_v<T, WhileNode>) {
+            resolve_node(arg.condition);
+            resolve_statements(arg.body);
+        }
+        else if constexpr (std::is_same_v<T, RepeatNode>) {
+            resolve_node(arg.count);
+            resolve_statements(arg.body);
+        }
+        else if constexpr (std::is_same_v<T, ForEachNode>) {
+            resolve_node(arg.iterable);
+            if (arg.parallel) {
+                if (!arg.target.empty()) bind(arg.target, arg.target_binding);
+                resolve_body({arg.variable}, arg.body, arg.layout);
+            } else {
+                bind(arg.variable, arg.binding);
+                resolve_statements(arg.body);
+            }
+        }
+        else if constexpr (std::is_same_v<T, FunctionDefNode>) {
+            bind(arg.name, arg.binding);
+            resolve_body(arg.parameters, arg.body, arg.layout);
+        }
+        else if constexpr (std::is_same_v<T, FunctionCallNode>) {
+            if (!arg.is_say) {
+                bind(arg.name, arg.binding);
+            }
+            resolve_statements(arg.arguments);
+        }
+        else if constexpr (std::is_same_v<T, ReturnNode>) {
+            resolve_node(arg.value);
+        }
+        else if constexpr (std::is_same_v<T, ListNode>) {
+            resolve_statements(arg.elements);
+        }
+        else if constexpr (std::is_same_v<T, DictNode>) {
+            for (const auto& entry : arg.entries) {
+                resolve_node(entry.second);
+            }
+        }
+        else if constexpr (std::is_same_v<T, IndexNode>) {
+            resolve_node(arg.object);
+            resolve_node(arg.index);
+        }
+        else if constexpr (std::is_same_v<T, PropertyAccessNode>) {
+            resolve_node(arg.object);
+        }
+        else if constexpr (std::is_same_v<T, BlockNode>) {
+            resolve_statements(arg.statements);
+        }
+        else if constexpr (std::is_same_v<T, GUINode>) {
+            resolve_statements(arg.arguments);
+            bind(arg.target, arg.binding);
+        }
+        else if constexpr (std::is_same_v<T, WaitNode>) {
+            resolve_node(arg.task);
+        }
+    });
+}
+
+void Resolver::resolve_body(const std::vector<Symbol>& params, NodeList body, ScopeLayout& layout) {
+    FunctionScope function;
+    function.enclosing = scope_;
+    function.params.insert(params.begin(), params.end());
+
+    std::unordered_set<Symbol> declared;
+    collect_declarations(*ast_, body, declared);
+
+    std::unordered_set<Symbol> free_names;
+    collect_free_names(*ast_, body, free_names);
+
+    layout.names.clear();
+    layout.captured.clear();
+
+    auto add_slot = [&](Symbol name) {
+        function.slots.emplace(name, static_cast<uint32_t>(layout.names.size()));
+        layout.names.push_back(name);
+        layout.captured.push_back(free_names.count(name) > 0);
+    };
+
+    // Parameters take the first slots, one per position
+    for (const auto& param : params) {
+        add_slot(param);
+    }
+
+    // Remaining names in a stable order
+    std::vector<Symbol> locals;
+    for (const auto& name : declared) {
+        if (function.params.count(name) == 0) {
+            locals.push_back(name);
+        }
+    }
+    std::sort(locals.begin(), locals.end());
+    for (const auto& name : locals) {
+        add_slot(name);
+    }
+
+    FunctionScope* enclosing = scope_;
+    scope_ = &function;
+    resolve_statements(body);
+    scope_ = enclosing;
+}
+
+void Resolver::bind(Symbol name, VariableBinding& binding) const {
+    binding.candidates.clear();
+
+    uint32_t depth = 0;
+    for (const FunctionScope* scope = scope_; scope != nullptr; scope = scope->enclosing, ++depth) {
+        auto it = scope->slots.find(name);
+        if (it == scope->slots.end()) {
+            continue;
+        }
+
+        binding.candidates.push_back({depth, it->second});
+
+        // Parameters are always bound, nothing further out is visible
+        if (scope->params.count(name)) {
+            break;
+        }
+    }
+}
+
+} // namespace kaynat
@@ -0,0 +1,65 @@
+/**
+ * @file resolver.hpp
+ * @brief Static variable resolution for Kaynat++
+ * 
+ * Assigns every variable reference its possible (depth, slot) locations
+ * before execution so that neither engine hashes names on local access.
+ */
+
+#pragma once
+
+#include "../parser/ast.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Resolver pass over a parsed program
+ * 
+ * Every name assigned, defined or used as a loop variable inside a
+ * function body gets a slot in that function's scope; parameters come
+ * first. The body of a parallel for-each loop is resolved like the body
+ * of a nested function whose only parameter is the loop variable. Each reference then records the slots it may refer to in the
+ * current and enclosing functions. Because assignment updates a visible
+ * variable and otherwise defines a new one, a reference can have several
+ * candidates; which one holds a value is decided at runtime. Top-level
+ * names are never resolved and stay in the global environment, which
+ * keeps REPL globals dynamic.
+ * 
+ * Results are written into the AST (VariableBinding, ScopeLayout).
+ * Resolving the same program again overwrites them.
+ * 
+ * Thread-safe: No. Use one resolver per pass.
+ */
+class Resolver {
+public:
+    /**
+     * @brief Resolve all variable references in a program
+     * @param ast Parsed program
+     */
+    void resolve(Ast& ast);
+    
+private:
+    /**
+     * @brief Resolution state for one function body
+     */
+    struct FunctionScope {
+        FunctionScope* enclosing = nullptr;
+        std::unordered_set<Symbol> params;
+        std::unordered_map<Symbol, uint32_t> slots;
+    };
+    
+    Ast* ast_ = nullptr;
+    FunctionScope* scope_ = nullptr;  // Null at the top level
+    
+    void resolve_statements(NodeList statements);
+    void resolve_node(NodeRef node);
+    void resolve_body(const std::vector<Symbol>& params, NodeList body, ScopeLayout& layout);
+    void bind(Symbol name, VariableBinding& binding) const;
+};
+
+} // namespace kaynat
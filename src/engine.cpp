@@ -0,0 +1,76 @@
+/**
+ * @file engine.cpp
+ * @brief Engine implementation
+ */
+
+#include "engine.hpp"
+#include "interpreter/interpreter.hpp"
+#include "interpreter/task.hpp"
+#include "compiler/compiler.hpp"
+#include "vm/vm.hpp"
+#include <iostream>
+
+namespace kaynat {
+
+namespace {
+
+/**
+ * @brief Print the result cache counters of a program's memoized functions
+ */
+void report_memo_stats(Ast& ast, std::ostream& out) {
+    for (uint32_t i = 0; i < ast.count<FunctionDefNode>(); ++i) {
+        const auto& def = ast.get<FunctionDefNode>(NodeRef(NodeKind::FUNCTION_DEF, i));
+        if (def.memo) {
+            out << "memo " << def.name.str() << " (line " << def.line << "): "
+                << def.memo->hits << " hits, " << def.memo->misses << " misses, "
+                << def.memo->stored << " stored\n";
+        }
+    }
+}
+
+} // namespace
+
+Engine::Engine(const RunOptions& options, bool interactive)
+    : options_(options), interactive_(interactive) {
+    if (options_.tree_walk) {
+        interpreter_ = std::make_unique<Interpreter>();
+    } else {
+        vm_ = std::make_unique<VM>();
+    }
+}
+
+Engine::~Engine() {
+    TaskGroup& tasks = interpreter_ ? interpreter_->tasks() : vm_->tasks();
+    tasks.wait();
+}
+
+KaynatValue Engine::execute(const std::shared_ptr<Ast>& ast) {
+    if (options_.opt_level != OptLevel::O0) {
+        Optimizer optimizer(!interactive_);
+        optimizer.optimize(*ast);
+    }
+
+    KaynatValue result;
+    if (interpreter_) {
+        result = interpreter_->execute(ast);
+    } else {
+        Compiler compiler;
+        auto script = compiler.compile(*ast);
+        if (options_.dump_bytecode) {
+            disassemble(*script, std::cout);
+        }
+        result = vm_->execute(script);
+    }
+
+    if (options_.memo_stats) {
+        report_memo_stats(*ast, std::cerr);
+    }
+    return result;
+}
+
+void Engine::define(const std::string& name, const KaynatValue& value) {
+    Environment& globals = interpreter_ ? interpreter_->globals() : vm_->globals();
+    globals.define(name, value);
+}
+
+} // namespace kaynat
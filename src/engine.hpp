@@ -0,0 +1,71 @@
+/**
+ * @file engine.hpp
+ * @brief Runs parsed programs on the engine chosen on the command line
+ */
+
+#pragma once
+
+#include "compiler/optimizer.hpp"
+#include "interpreter/runtime_value.hpp"
+#include "parser/ast.hpp"
+#include <memory>
+#include <string>
+
+namespace kaynat {
+
+class Interpreter;
+class VM;
+
+/**
+ * @brief Execution options selected on the command line
+ */
+struct RunOptions {
+    bool tree_walk = false;      // Use the tree-walking interpreter instead of the VM
+    bool dump_bytecode = false;  // Print compiled bytecode before running it
+    OptLevel opt_level = OptLevel::O1;  // AST optimizations applied before running
+    bool memo_stats = false;     // Report result cache counters after running
+};
+
+/**
+ * @brief Runs parsed programs on the engine chosen by RunOptions
+ *
+ * Keeps a single interpreter or VM alive so that REPL lines share
+ * their global variables.
+ *
+ * Thread-safe: No. Separate engines may run on separate threads.
+ */
+class Engine {
+public:
+    /**
+     * @param interactive Whether programs arrive one REPL line at a time
+     */
+    Engine(const RunOptions& options, bool interactive);
+
+    /**
+     * @brief Waits for this engine's tasks nobody waited for, which still run its functions
+     */
+    ~Engine();
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    /**
+     * @brief Optimize and run a program
+     * @return Value of the last statement or null
+     * @throws KaynatError on runtime errors
+     */
+    KaynatValue execute(const std::shared_ptr<Ast>& ast);
+
+    /**
+     * @brief Define a global variable before running a program
+     */
+    void define(const std::string& name, const KaynatValue& value);
+
+private:
+    RunOptions options_;
+    bool interactive_;
+    std::unique_ptr<Interpreter> interpreter_;
+    std::unique_ptr<VM> vm_;
+};
+
+} // namespace kaynat
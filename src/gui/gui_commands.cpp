@@ -0,0 +1,152 @@
+/**
+ * @file gui_commands.cpp
+ * @brief GUI command execution implementation
+ */
+
+#include "gui_commands.hpp"
+#include "gui_system.hpp"
+#include <mutex>
+
+namespace kaynat {
+
+void run_gui_command(GUINode::Command command, const std::string& target,
+                     const std::vector<KaynatValue>& args) {
+    // Programs running in separate isolates share the one GUIManager
+    static std::mutex gui_mutex;
+    std::lock_guard<std::mutex> lock(gui_mutex);
+    auto& gui_mgr = GUIManager::instance();
+    
+    switch (command) {
+        case GUINode::Command::CREATE_WINDOW: {
+            auto window = std::make_shared<Window>(target, 800, 600);
+            gui_mgr.register_window(target, window);
+            break;
+        }
+        
+        case GUINode::Command::SET_TITLE: {
+            auto window = gui_mgr.get_window(target);
+            if (window && !args.empty()) {
+                const std::string* str = args[0].as_string_ptr();
+                if (str) window->title = *str;
+            }
+            break;
+        }
+        
+        case GUINode::Command::SET_WIDTH: {
+            auto window = gui_mgr.get_window(target);
+            if (window && !args.empty()) {
+                auto num = args[0].as_int();
+                if (num) window->width = static_cast<int>(*num);
+            }
+            break;
+        }
+        
+        case GUINode::Command::SET_HEIGHT: {
+            auto window = gui_mgr.get_window(target);
+            if (window && !args.empty()) {
+                auto num = args[0].as_int();
+                if (num) window->height = static_cast<int>(*num);
+            }
+            break;
+        }
+        
+        case GUINode::Command::SET_BACKGROUND: {
+            auto window = gui_mgr.get_window(target);
+            if (window && !args.empty()) {
+                const std::string* str = args[0].as_string_ptr();
+                if (str) window->background_color = *str;
+            }
+            break;
+        }
+        
+        case GUINode::Command::SHOW_WINDOW: {
+            auto window = gui_mgr.get_window(target);
+            if (window) window->show();
+            break;
+        }
+        
+        case GUINode::Command::CREATE_LABEL: {
+            auto label = std::make_shared<Label>("");
+            label->id = target;
+            // Store widget for later access
+            gui_mgr.register_widget(target, label);
+            break;
+        }
+        
+        case GUINode::Command::SET_TEXT: {
+            auto widget = gui_mgr.get_widget(target);
+            if (widget && !args.empty()) {
+                const std::string* str = args[0].as_string_ptr();
+                if (str) {
+                    if (auto label = std::dynamic_pointer_cast<Label>(widget)) {
+                        label->text = *str;
+                    } else if (auto button = std::dynamic_pointer_cast<Button>(widget)) {
+                        button->text = *str;
+                    }
+                }
+            }
+            break;
+        }
+        
+        case GUINode::Command::CREATE_BUTTON: {
+            auto button = std::make_shared<Button>("");
+            button->id = target;
+            gui_mgr.register_widget(target, button);
+            break;
+        }
+        
+        case GUINode::Command::CREATE_INPUT: {
+            auto input = std::make_shared<TextInput>("");
+            input->id = target;
+            gui_mgr.register_widget(target, input);
+            break;
+        }
+        
+        case GUINode::Command::SET_PLACEHOLDER: {
+            auto widget = gui_mgr.get_widget(target);
+            if (widget && !args.empty()) {
+                const std::string* str = args[0].as_string_ptr();
+                if (str) {
+                    if (auto input = std::dynamic_pointer_cast<TextInput>(widget)) {
+                        input->placeholder = *str;
+                    }
+                }
+            }
+            break;
+        }
+        
+        case GUINode::Command::PLACE_WIDGET: {
+            auto widget = gui_mgr.get_widget(target);
+            if (widget && args.size() >= 3) {
+                // Get row, column, window name
+                auto row_val = args[0].as_int();
+                auto col_val = args[1].as_int();
+                const std::string* win_val = args[2].as_string_ptr();
+                
+                if (row_val && col_val && win_val) {
+                    auto window = gui_mgr.get_window(*win_val);
+                    if (window) {
+                        widget->x = static_cast<int>(*col_val);
+                        widget->y = static_cast<int>(*row_val);
+                        window->add_widget(widget);
+                    }
+                }
+            }
+            break;
+        }
+    }
+}
+
+bool gui_command_defines_target(GUINode::Command command) {
+    switch (command) {
+        case GUINode::Command::CREATE_WINDOW:
+        case GUINode::Command::CREATE_LABEL:
+        case GUINode::Command::CREATE_BUTTON:
+        case GUINode::Command::CREATE_INPUT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace kaynat
@@ -0,0 +1,34 @@
+/**
+ * @file gui_commands.hpp
+ * @brief Execution of parsed GUI commands
+ * 
+ * Applies GUINode commands to the GUIManager. Shared by the tree-walking
+ * interpreter and the bytecode VM; binding the created widget name in the
+ * current scope is left to the caller.
+ */
+
+#pragma once
+
+#include "../parser/nodes.hpp"
+#include "../interpreter/runtime_value.hpp"
+#include <string>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Execute a GUI command with already-evaluated arguments
+ * @param command GUI command to run
+ * @param target Window or widget name the command applies to
+ * @param args Evaluated command arguments
+ */
+void run_gui_command(GUINode::Command command, const std::string& target,
+                     const std::vector<KaynatValue>& args);
+
+/**
+ * @brief Check whether a GUI command introduces a new name
+ * @return true for the create-window/label/button/input commands
+ */
+bool gui_command_defines_target(GUINode::Command command);
+
+} // namespace kaynat
@@ -0,0 +1,1130 @@
+/**
+ * @file bigint.cpp
+ * @brief BigInt arithmetic
+ *
+ * Magnitudes are little-endian vectors of base 10^9 limbs. Products use
+ * schoolbook multiplication for short operands, Karatsuba above
+ * KARATSUBA_THRESHOLD limbs and a three-prime number theoretic transform
+ * once both operands reach NTT_THRESHOLD limbs. Division is Knuth's
+ * algorithm D, or multiplication by a Newton reciprocal when both the
+ * divisor and the quotient are long.
+ */
+
+#include "runtime_value.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace kaynat {
+
+namespace {
+
+using Limbs = BigInt::Limbs;
+
+__extension__ typedef unsigned __int128 Wide;
+
+constexpr uint64_t BASE = 1000000000;  // Must match BigInt::BASE
+
+constexpr size_t KARATSUBA_THRESHOLD = 32;
+constexpr size_t NTT_THRESHOLD = 2000;
+constexpr size_t NEWTON_THRESHOLD = 200;
+
+/**
+ * @brief Number of limbs without leading zeros, at least one
+ */
+size_t significant(const int32_t* a, size_t n) {
+    while (n > 1 && a[n - 1] == 0) --n;
+    return n == 0 ? 1 : n;
+}
+
+void trim(Limbs& a) {
+    a.resize(significant(a.data(), a.size()));
+}
+
+int compare(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    na = significant(a, na);
+    nb = significant(b, nb);
+    if (na != nb) {
+        return na < nb ? -1 : 1;
+    }
+
+    for (size_t i = na; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+int compare(const Limbs& a, const Limbs& b) {
+    return compare(a.data(), a.size(), b.data(), b.size());
+}
+
+Limbs add(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+
+    Limbs result(na + 1);
+    int32_t carry = 0;
+    for (size_t i = 0; i < na; ++i) {
+        int32_t sum = a[i] + carry + (i < nb ? b[i] : 0);
+        carry = sum >= static_cast<int32_t>(BASE);
+        result[i] = carry ? sum - static_cast<int32_t>(BASE) : sum;
+    }
+    result[na] = carry;
+
+    trim(result);
+    return result;
+}
+
+/**
+ * @brief acc += b * BASE^shift; acc must be long enough for the sum
+ */
+void add_into(Limbs& acc, const int32_t* b, size_t nb, size_t shift) {
+    nb = significant(b, nb);
+    int32_t carry = 0;
+    size_t i = 0;
+    for (; i < nb; ++i) {
+        int32_t sum = acc[shift + i] + b[i] + carry;
+        carry = sum >= static_cast<int32_t>(BASE);
+        acc[shift + i] = carry ? sum - static_cast<int32_t>(BASE) : sum;
+    }
+    for (size_t k = shift + i; carry; ++k) {
+        int32_t sum = acc[k] + carry;
+        carry = sum >= static_cast<int32_t>(BASE);
+        acc[k] = carry ? sum - static_cast<int32_t>(BASE) : sum;
+    }
+}
+
+/**
+ * @brief acc -= b; requires acc >= b
+ */
+void subtract_into(Limbs& acc, const int32_t* b, size_t nb) {
+    nb = significant(b, nb);
+    int32_t borrow = 0;
+    size_t i = 0;
+    for (; i < nb; ++i) {
+        int32_t diff = acc[i] - b[i] - borrow;
+        borrow = diff < 0;
+        acc[i] = borrow ? diff + static_cast<int32_t>(BASE) : diff;
+    }
+    for (; borrow; ++i) {
+        int32_t diff = acc[i] - borrow;
+        borrow = diff < 0;
+        acc[i] = borrow ? diff + static_cast<int32_t>(BASE) : diff;
+    }
+}
+
+void subtract_into(Limbs& acc, const Limbs& b) {
+    subtract_into(acc, b.data(), b.size());
+}
+
+/**
+ * @brief a += value for a small non-negative value
+ */
+void increment(Limbs& a, uint32_t value) {
+    uint64_t carry = value;
+    for (size_t i = 0; carry; ++i) {
+        if (i == a.size()) a.push_back(0);
+        uint64_t sum = static_cast<uint64_t>(a[i]) + carry;
+        a[i] = static_cast<int32_t>(sum % BASE);
+        carry = sum / BASE;
+    }
+}
+
+/**
+ * @brief a -= 1; requires a > 0
+ */
+void decrement(Limbs& a) {
+    for (size_t i = 0;; ++i) {
+        if (a[i] > 0) {
+            --a[i];
+            break;
+        }
+        a[i] = static_cast<int32_t>(BASE - 1);
+    }
+    trim(a);
+}
+
+/**
+ * @brief a * BASE^count
+ */
+Limbs shift_up(const Limbs& a, size_t count) {
+    Limbs result(count + a.size(), 0);
+    std::copy(a.begin(), a.end(), result.begin() + count);
+    return result;
+}
+
+/**
+ * @brief floor(a / BASE^count)
+ */
+Limbs shift_down(const Limbs& a, size_t count) {
+    if (count >= a.size()) {
+        return Limbs{0};
+    }
+    Limbs result(a.begin() + count, a.end());
+    trim(result);
+    return result;
+}
+
+Limbs multiply(const int32_t* a, size_t na, const int32_t* b, size_t nb);
+
+Limbs multiply(const Limbs& a, const Limbs& b) {
+    return multiply(a.data(), a.size(), b.data(), b.size());
+}
+
+Limbs schoolbook(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    Limbs result(na + nb, 0);
+    for (size_t i = 0; i < na; ++i) {
+        const uint64_t ai = static_cast<uint64_t>(a[i]);
+        if (ai == 0) continue;
+
+        // Each step stays below BASE^2, so the carry stays below BASE
+        uint64_t carry = 0;
+        for (size_t j = 0; j < nb; ++j) {
+            uint64_t cur = static_cast<uint64_t>(result[i + j]) + ai * static_cast<uint64_t>(b[j]) + carry;
+            result[i + j] = static_cast<int32_t>(cur % BASE);
+            carry = cur / BASE;
+        }
+        result[i + nb] = static_cast<int32_t>(carry);
+    }
+    return result;
+}
+
+Limbs karatsuba(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+
+    // Unbalanced operands are multiplied in slices of the shorter one
+    if (na >= 2 * nb) {
+        Limbs result(na + nb, 0);
+        for (size_t offset = 0; offset < na; offset += nb) {
+            size_t length = std::min(nb, na - offset);
+            Limbs part = multiply(a + offset, length, b, nb);
+            add_into(result, part.data(), part.size(), offset);
+        }
+        return result;
+    }
+
+    // a = a1 * BASE^half + a0, likewise b; nb > half here
+    const size_t half = na / 2;
+    Limbs low = multiply(a, half, b, half);
+    Limbs high = multiply(a + half, na - half, b + half, nb - half);
+    Limbs a_sum = add(a, half, a + half, na - half);
+    Limbs b_sum = add(b, half, b + half, nb - half);
+    Limbs middle = multiply(a_sum, b_sum);
+    subtract_into(middle, low);
+    subtract_into(middle, high);
+
+    Limbs result(na + nb + 1, 0);
+    add_into(result, low.data(), low.size(), 0);
+    add_into(result, middle.data(), middle.size(), half);
+    add_into(result, high.data(), high.size(), 2 * half);
+    return result;
+}
+
+/**
+ * @brief NTT-friendly prime p = c * 2^k + 1 with primitive root 3
+ */
+struct NttPrime {
+    uint32_t modulus;
+    uint32_t max_log;  // Largest supported transform is 2^max_log
+};
+
+constexpr NttPrime NTT_PRIMES[3] = {
+    {998244353, 23},  // 119 * 2^23 + 1
+    {167772161, 25},  // 5 * 2^25 + 1
+    {469762049, 26},  // 7 * 2^26 + 1
+};
+
+// The product of the three primes (~7.8e25) bounds every convolution
+// term of at most 2^23 limb products below BASE^2
+constexpr uint32_t NTT_MAX_LOG = 23;
+
+uint64_t pow_mod(uint64_t base, uint64_t exponent, uint64_t modulus) {
+    uint64_t result = 1;
+    base %= modulus;
+    while (exponent > 0) {
+        if (exponent & 1) result = result * base % modulus;
+        base = base * base % modulus;
+        exponent >>= 1;
+    }
+    return result;
+}
+
+void ntt(std::vector<uint32_t>& a, bool inverse, uint64_t modulus) {
+    const size_t n = a.size();
+
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+
+    std::vector<uint32_t> roots;
+    for (size_t length = 2; length <= n; length <<= 1) {
+        uint64_t root = pow_mod(3, (modulus - 1) / length, modulus);
+        if (inverse) root = pow_mod(root, modulus - 2, modulus);
+
+        const size_t half = length / 2;
+        roots.resize(half);
+        roots[0] = 1;
+        for (size_t k = 1; k < half; ++k) {
+            roots[k] = static_cast<uint32_t>(roots[k - 1] * root % modulus);
+        }
+
+        for (size_t i = 0; i < n; i += length) {
+            for (size_t k = 0; k < half; ++k) {
+                uint64_t u = a[i + k];
+                uint64_t v = a[i + k + half] * static_cast<uint64_t>(roots[k]) % modulus;
+                a[i + k] = static_cast<uint32_t>(u + v < modulus ? u + v : u + v - modulus);
+                a[i + k + half] = static_cast<uint32_t>(u >= v ? u - v : u + modulus - v);
+            }
+        }
+    }
+
+    if (inverse) {
+        uint64_t n_inverse = pow_mod(n, modulus - 2, modulus);
+        for (auto& x : a) x = static_cast<uint32_t>(x * n_inverse % modulus);
+    }
+}
+
+std::vector<uint32_t> convolve(const int32_t* a, size_t na, const int32_t* b, size_t nb,
+                               size_t size, uint64_t modulus) {
+    std::vector<uint32_t> fa(size, 0);
+    std::vector<uint32_t> fb(size, 0);
+    for (size_t i = 0; i < na; ++i) fa[i] = static_cast<uint32_t>(a[i] % modulus);
+    for (size_t i = 0; i < nb; ++i) fb[i] = static_cast<uint32_t>(b[i] % modulus);
+
+    ntt(fa, false, modulus);
+    ntt(fb, false, modulus);
+    for (size_t i = 0; i < size; ++i) {
+        fa[i] = static_cast<uint32_t>(static_cast<uint64_t>(fa[i]) * fb[i] % modulus);
+    }
+    ntt(fa, true, modulus);
+    return fa;
+}
+
+Limbs ntt_multiply(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    size_t size = 1;
+    while (size < na + nb) size <<= 1;
+
+    std::vector<uint32_t> r[3];
+    for (int k = 0; k < 3; ++k) {
+        r[k] = convolve(a, na, b, nb, size, NTT_PRIMES[k].modulus);
+    }
+
+    // Recombine each term with Garner's algorithm and carry in base 10^9
+    const uint64_t p1 = NTT_PRIMES[0].modulus;
+    const uint64_t p2 = NTT_PRIMES[1].modulus;
+    const uint64_t p3 = NTT_PRIMES[2].modulus;
+    const uint64_t p1_inv_p2 = pow_mod(p1 % p2, p2 - 2, p2);
+    const uint64_t p12_inv_p3 = pow_mod(p1 % p3 * (p2 % p3) % p3, p3 - 2, p3);
+    const uint64_t p1_mod_p3 = p1 % p3;
+
+    Limbs result(na + nb, 0);
+    Wide carry = 0;
+    for (size_t i = 0; i < na + nb; ++i) {
+        uint64_t x1 = r[0][i];
+        uint64_t x2 = (r[1][i] + p2 - x1 % p2) % p2 * p1_inv_p2 % p2;
+        uint64_t t = (r[2][i] + p3 - x1 % p3) % p3;
+        t = (t + p3 - x2 * p1_mod_p3 % p3) % p3;
+        uint64_t x3 = t * p12_inv_p3 % p3;
+
+        Wide value = static_cast<Wide>(x1) + static_cast<Wide>(x2) * p1 +
+                     static_cast<Wide>(x3) * p1 * p2 + carry;
+        result[i] = static_cast<int32_t>(value % BASE);
+        carry = value / BASE;
+    }
+    return result;
+}
+
+Limbs multiply(const int32_t* a, size_t na, const int32_t* b, size_t nb) {
+    na = significant(a, na);
+    nb = significant(b, nb);
+
+    Limbs result;
+    if (std::min(na, nb) < KARATSUBA_THRESHOLD) {
+        result = schoolbook(a, na, b, nb);
+    } else if (std::min(na, nb) >= NTT_THRESHOLD && na + nb <= (size_t{1} << NTT_MAX_LOG)) {
+        result = ntt_multiply(a, na, b, nb);
+    } else {
+        result = karatsuba(a, na, b, nb);
+    }
+
+    trim(result);
+    return result;
+}
+
+/**
+ * @brief Divide by a single limb
+ * @return Remainder
+ */
+uint32_t divide_small(const Limbs& u, uint32_t divisor, Limbs& quotient) {
+    quotient.assign(u.size(), 0);
+    uint64_t remainder = 0;
+    for (size_t i = u.size(); i-- > 0;) {
+        uint64_t cur = remainder * BASE + static_cast<uint64_t>(u[i]);
+        quotient[i] = static_cast<int32_t>(cur / divisor);
+        remainder = cur % divisor;
+    }
+    trim(quotient);
+    return static_cast<uint32_t>(remainder);
+}
+
+/**
+ * @brief Knuth's algorithm D (TAOCP 4.3.1) on trimmed magnitudes
+ */
+void knuth_divide(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder) {
+    const size_t n = u.size();
+    const size_t m = v.size();
+
+    // Scale so that the divisor's top limb is at least BASE / 2
+    const uint64_t scale = BASE / (static_cast<uint64_t>(v[m - 1]) + 1);
+    std::vector<int64_t> un(n + 1, 0);
+    std::vector<int64_t> vn(m, 0);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t cur = static_cast<uint64_t>(u[i]) * scale + carry;
+        un[i] = static_cast<int64_t>(cur % BASE);
+        carry = cur / BASE;
+    }
+    un[n] = static_cast<int64_t>(carry);
+    carry = 0;
+    for (size_t i = 0; i < m; ++i) {
+        uint64_t cur = static_cast<uint64_t>(v[i]) * scale + carry;
+        vn[i] = static_cast<int64_t>(cur % BASE);
+        carry = cur / BASE;
+    }
+
+    const int64_t base = static_cast<int64_t>(BASE);
+    quotient.assign(n - m + 1, 0);
+    for (size_t j = n - m + 1; j-- > 0;) {
+        // Estimate the quotient limb from the top two limbs
+        int64_t numerator = un[j + m] * base + un[j + m - 1];
+        int64_t qhat = numerator / vn[m - 1];
+        int64_t rhat = numerator % vn[m - 1];
+        while (qhat >= base || qhat * vn[m - 2] > rhat * base + un[j + m - 2]) {
+            --qhat;
+            rhat += vn[m - 1];
+            if (rhat >= base) break;
+        }
+
+        // Multiply and subtract
+        int64_t borrow = 0;
+        int64_t mul_carry = 0;
+        for (size_t i = 0; i < m; ++i) {
+            int64_t product = qhat * vn[i] + mul_carry;
+            mul_carry = product / base;
+            int64_t diff = un[i + j] - product % base - borrow;
+            borrow = diff < 0;
+            un[i + j] = borrow ? diff + base : diff;
+        }
+        int64_t top = un[j + m] - mul_carry - borrow;
+
+        // The estimate was one too large: add the divisor back
+        if (top < 0) {
+            --qhat;
+            int64_t add_carry = 0;
+            for (size_t i = 0; i < m; ++i) {
+                int64_t sum = un[i + j] + vn[i] + add_carry;
+                add_carry = sum >= base;
+                un[i + j] = add_carry ? sum - base : sum;
+            }
+            top += add_carry;
+        }
+        un[j + m] = top;
+        quotient[j] = static_cast<int32_t>(qhat);
+    }
+    trim(quotient);
+
+    // Undo the scaling on the remainder
+    remainder.assign(m, 0);
+    uint64_t rem = 0;
+    for (size_t i = m; i-- > 0;) {
+        uint64_t cur = rem * BASE + static_cast<uint64_t>(un[i]);
+        remainder[i] = static_cast<int32_t>(cur / scale);
+        rem = cur % scale;
+    }
+    trim(remainder);
+}
+
+/**
+ * @brief floor(BASE^(2n) / v) for a trimmed v of n limbs
+ */
+Limbs reciprocal(const Limbs& v) {
+    const size_t n = v.size();
+    Limbs power(2 * n + 1, 0);
+    power.back() = 1;
+
+    Limbs x;
+    if (n <= NEWTON_THRESHOLD) {
+        Limbs unused;
+        knuth_divide(power, v, x, unused);
+        return x;
+    }
+
+    // One Newton step from the reciprocal of the top t limbs, which is
+    // accurate to about half of x once t exceeds n / 2 by a guard limb:
+    // x = 2 z BASE^(n-t) - v z^2 / BASE^(2t)
+    const size_t t = (n + 1) / 2 + 2;
+    Limbs top(v.end() - t, v.end());
+    Limbs z = reciprocal(top);
+    Limbs correction = shift_down(multiply(v, multiply(z, z)), 2 * t);
+    x = shift_up(z, n - t);
+    x = add(x.data(), x.size(), x.data(), x.size());
+    if (compare(x, correction) <= 0) {
+        Limbs unused;
+        knuth_divide(power, v, x, unused);
+        return x;
+    }
+    subtract_into(x, correction);
+    trim(x);
+
+    // The step lands within a few units; settle the last ones exactly
+    Limbs product = multiply(v, x);
+    while (compare(product, power) > 0) {
+        decrement(x);
+        subtract_into(product, v);
+        trim(product);
+    }
+    Limbs rest = power;
+    subtract_into(rest, product);
+    trim(rest);
+    while (compare(rest, v) >= 0) {
+        increment(x, 1);
+        subtract_into(rest, v);
+        trim(rest);
+    }
+    return x;
+}
+
+/**
+ * @brief Division of u < BASE^(2m) by v of m limbs, given reciprocal(v)
+ */
+void divide_by_reciprocal(const Limbs& u, const Limbs& v, const Limbs& inverse,
+                          Limbs& quotient, Limbs& remainder) {
+    // The estimate is at most two below the true quotient
+    quotient = shift_down(multiply(u, inverse), 2 * v.size());
+    remainder = u;
+    subtract_into(remainder, multiply(quotient, v));
+    trim(remainder);
+    while (compare(remainder, v) >= 0) {
+        increment(quotient, 1);
+        subtract_into(remainder, v);
+        trim(remainder);
+    }
+}
+
+/**
+ * @brief Division through a Newton reciprocal of the divisor
+ */
+void newton_divide(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder) {
+    // Pad both operands so that the divisor has s limbs and u < BASE^(2s);
+    // padding by whole limbs leaves the quotient unchanged
+    const size_t m = v.size();
+    const size_t s = std::max(m, u.size() - m + 1);
+    const Limbs padded_v = shift_up(v, s - m);
+    const Limbs padded_u = shift_up(u, s - m);
+
+    divide_by_reciprocal(padded_u, padded_v, reciprocal(padded_v), quotient, remainder);
+    remainder = shift_down(remainder, s - m);
+}
+
+void divide(const Limbs& u, const Limbs& v, Limbs& quotient, Limbs& remainder) {
+    if (compare(u, v) < 0) {
+        quotient = Limbs{0};
+        remainder = u;
+        return;
+    }
+
+    if (v.size() == 1) {
+        uint32_t rem = divide_small(u, static_cast<uint32_t>(v[0]), quotient);
+        remainder = Limbs{static_cast<int32_t>(rem)};
+        return;
+    }
+
+    if (v.size() > NEWTON_THRESHOLD && u.size() - v.size() > NEWTON_THRESHOLD) {
+        newton_divide(u, v, quotient, remainder);
+    } else {
+        knuth_divide(u, v, quotient, remainder);
+    }
+}
+
+// Text conversion. Decimal maps directly onto base 10^9 limbs and is
+// linear; power-of-two radixes go through base 2^32 words, converted by
+// splitting at 2^(32 * 2^k) so that the cost follows multiplication
+
+// "00" to "99", for writing limbs two digits at a time
+constexpr char DIGIT_PAIRS[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+constexpr size_t LIMB_DIGITS = 9;
+
+/**
+ * @brief Write a limb as exactly nine digits, zero padded
+ */
+void write_limb(char* out, uint32_t value) {
+    out[0] = static_cast<char>('0' + value / 100000000);
+    value %= 100000000;
+    for (size_t end = LIMB_DIGITS; end > 1; end -= 2) {
+        std::memcpy(out + end - 2, DIGIT_PAIRS + 2 * (value % 100), 2);
+        value /= 100;
+    }
+}
+
+/**
+ * @brief Value of a run of decimal digits
+ * @throws std::invalid_argument on anything but a digit
+ */
+int32_t read_limb(const char* begin, const char* end) {
+    int32_t value = 0;
+    for (const char* p = begin; p != end; ++p) {
+        if (*p < '0' || *p > '9') {
+            throw std::invalid_argument("Invalid digit in integer text");
+        }
+        value = value * 10 + (*p - '0');
+    }
+    return value;
+}
+
+using Words = std::vector<uint32_t>;
+
+// Leaves of the radix conversion are 2^WORD_LEAF_LEVEL words long
+constexpr size_t WORD_LEAF_LEVEL = 5;
+
+/**
+ * @brief powers[k] = 2^(32 * 2^k), up to the first one reaching limit
+ */
+std::vector<Limbs> word_powers(size_t limit_limbs) {
+    std::vector<Limbs> powers;
+    powers.push_back(Limbs{294967296, 4});  // 2^32
+    while (powers.back().size() <= limit_limbs) {
+        powers.push_back(multiply(powers.back(), powers.back()));
+    }
+    return powers;
+}
+
+/**
+ * @brief Append the 2^level lowest base 2^32 words of x, x < 2^(32 * 2^level)
+ *
+ * Every split at one level divides by the same power, so the long powers
+ * come with their reciprocals computed once up front.
+ */
+void append_words(const Limbs& x, size_t level, const std::vector<Limbs>& powers,
+                  const std::vector<Limbs>& inverses, Words& out) {
+    const size_t count = size_t{1} << level;
+
+    if (level <= WORD_LEAF_LEVEL || (x.size() == 1 && x[0] == 0)) {
+        // Repeated division by 2^32; the remainder times BASE fits 64 bits
+        Limbs rest = x;
+        size_t written = 0;
+        while (!(rest.size() == 1 && rest[0] == 0)) {
+            uint64_t remainder = 0;
+            for (size_t i = rest.size(); i-- > 0;) {
+                uint64_t cur = remainder * BASE + static_cast<uint64_t>(rest[i]);
+                rest[i] = static_cast<int32_t>(cur >> 32);
+                remainder = cur & 0xFFFFFFFFu;
+            }
+            trim(rest);
+            out.push_back(static_cast<uint32_t>(remainder));
+            ++written;
+        }
+        out.resize(out.size() + count - written, 0);
+        return;
+    }
+
+    Limbs quotient;
+    Limbs remainder;
+    if (inverses[level - 1].empty()) {
+        divide(x, powers[level - 1], quotient, remainder);
+    } else {
+        divide_by_reciprocal(x, powers[level - 1], inverses[level - 1], quotient, remainder);
+    }
+    append_words(remainder, level - 1, powers, inverses, out);
+    append_words(quotient, level - 1, powers, inverses, out);
+}
+
+Words to_words(const Limbs& x) {
+    std::vector<Limbs> powers = word_powers(x.size());
+    size_t level = 0;
+    while (compare(powers[level], x) <= 0) ++level;
+
+    std::vector<Limbs> inverses(level);
+    for (size_t k = 0; k < level; ++k) {
+        if (powers[k].size() > NEWTON_THRESHOLD) inverses[k] = reciprocal(powers[k]);
+    }
+
+    Words words;
+    words.reserve(size_t{1} << level);
+    append_words(x, level, powers, inverses, words);
+    while (words.size() > 1 && words.back() == 0) words.pop_back();
+    return words;
+}
+
+/**
+ * @brief a = a * factor + addend for small factor and addend
+ */
+void multiply_add(Limbs& a, uint32_t factor, uint32_t addend) {
+    uint64_t carry = addend;
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t cur = static_cast<uint64_t>(a[i]) * factor + carry;
+        a[i] = static_cast<int32_t>(cur % BASE);
+        carry = cur / BASE;
+    }
+    for (; carry > 0; carry /= BASE) {
+        a.push_back(static_cast<int32_t>(carry % BASE));
+    }
+}
+
+/**
+ * @brief Value of the 2^level words starting at offset (missing words are 0)
+ */
+Limbs from_words(const Words& words, size_t offset, size_t level, const std::vector<Limbs>& powers) {
+    const size_t count = size_t{1} << level;
+
+    if (level <= WORD_LEAF_LEVEL) {
+        Limbs result{0};
+        for (size_t i = std::min(offset + count, words.size()); i-- > offset;) {
+            multiply_add(result, 1u << 16, words[i] >> 16);
+            multiply_add(result, 1u << 16, words[i] & 0xFFFFu);
+        }
+        return result;
+    }
+
+    const size_t half = count / 2;
+    Limbs high = offset + half < words.size() ? from_words(words, offset + half, level - 1, powers) : Limbs{0};
+    Limbs low = from_words(words, offset, level - 1, powers);
+    Limbs result = multiply(high, powers[level - 1]);
+    result.resize(std::max(result.size(), low.size()) + 1, 0);
+    add_into(result, low.data(), low.size(), 0);
+    trim(result);
+    return result;
+}
+
+Limbs from_words(const Words& words) {
+    size_t level = 0;
+    while ((size_t{1} << level) < words.size()) ++level;
+
+    // 2^32 words cover about 1.07 limbs each
+    std::vector<Limbs> powers = word_powers(words.size() + words.size() / 8 + 1);
+    return from_words(words, 0, level, powers);
+}
+
+unsigned radix_bits(unsigned radix) {
+    switch (radix) {
+        case 2: return 1;
+        case 8: return 3;
+        case 16: return 4;
+        default: throw std::invalid_argument("BigInt radix must be 2, 8, 10 or 16");
+    }
+}
+
+int digit_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 64;
+}
+
+
+// Modular exponentiation. Moduli coprime to 10 use Montgomery reduction
+// with R = BASE^k, which replaces each division by k limb passes; the
+// others reduce every product by division
+
+/**
+ * @brief Montgomery arithmetic modulo a trimmed n with gcd(n, 10) = 1
+ */
+class Montgomery {
+public:
+    explicit Montgomery(const Limbs& modulus) : modulus_(modulus) {
+        // Inverse of the low limb modulo BASE, by extended Euclid
+        int64_t old_r = modulus[0], r = static_cast<int64_t>(BASE);
+        int64_t old_s = 1, s = 0;
+        while (r != 0) {
+            int64_t q = old_r / r;
+            std::tie(old_r, r) = std::make_pair(r, old_r - q * r);
+            std::tie(old_s, s) = std::make_pair(s, old_s - q * s);
+        }
+        int64_t inverse = old_s % static_cast<int64_t>(BASE);
+        if (inverse < 0) inverse += static_cast<int64_t>(BASE);
+        factor_ = (BASE - static_cast<uint64_t>(inverse)) % BASE;
+    }
+
+    /**
+     * @brief a R mod n for a < n
+     */
+    Limbs to_form(const Limbs& a) const {
+        Limbs quotient;
+        Limbs remainder;
+        divide(shift_up(a, modulus_.size()), modulus_, quotient, remainder);
+        return remainder;
+    }
+
+    Limbs from_form(const Limbs& a) const { return reduce(a); }
+
+    Limbs product(const Limbs& a, const Limbs& b) const { return reduce(multiply(a, b)); }
+
+private:
+    Limbs modulus_;
+    uint64_t factor_;  // -n^-1 mod BASE
+
+    /**
+     * @brief value / R mod n for value < n R
+     */
+    Limbs reduce(const Limbs& value) const {
+        const size_t k = modulus_.size();
+        std::vector<uint64_t> t(2 * k + 1, 0);
+        std::copy(value.begin(), value.end(), t.begin());
+
+        // Add multiples of n that clear the low limbs one at a time
+        for (size_t i = 0; i < k; ++i) {
+            const uint64_t m = t[i] * factor_ % BASE;
+            uint64_t carry = 0;
+            for (size_t j = 0; j < k; ++j) {
+                uint64_t cur = t[i + j] + m * static_cast<uint64_t>(modulus_[j]) + carry;
+                t[i + j] = cur % BASE;
+                carry = cur / BASE;
+            }
+            for (size_t p = i + k; carry > 0; ++p) {
+                uint64_t cur = t[p] + carry;
+                t[p] = cur % BASE;
+                carry = cur / BASE;
+            }
+        }
+
+        Limbs result(k + 1, 0);
+        std::copy(t.begin() + k, t.end(), result.begin());
+        trim(result);
+        if (compare(result, modulus_) >= 0) {
+            subtract_into(result, modulus_);
+            trim(result);
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief base^exponent with fixed 4-bit windows over the exponent's words
+ */
+template <typename Multiply>
+Limbs power(const Limbs& base, const Words& exponent, const Limbs& one, Multiply&& mul) {
+    Limbs table[16];
+    table[0] = one;
+    table[1] = base;
+    for (size_t i = 2; i < 16; ++i) {
+        table[i] = mul(table[i - 1], base);
+    }
+
+    Limbs result = one;
+    bool started = false;
+    for (size_t w = exponent.size(); w-- > 0;) {
+        for (int shift = 28; shift >= 0; shift -= 4) {
+            if (started) {
+                for (int i = 0; i < 4; ++i) result = mul(result, result);
+            }
+
+            const uint32_t window = (exponent[w] >> shift) & 0xF;
+            if (window != 0) {
+                result = started ? mul(result, table[window]) : table[window];
+                started = true;
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+BigInt::BigInt() : negative_(false) {
+    digits_.push_back(0);
+}
+
+BigInt::BigInt(int64_t value) : negative_(value < 0) {
+    if (value == 0) {
+        digits_.push_back(0);
+        return;
+    }
+
+    // Negate in unsigned arithmetic so that INT64_MIN is representable
+    uint64_t abs_value = negative_ ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    while (abs_value > 0) {
+        digits_.push_back(abs_value % BASE);
+        abs_value /= BASE;
+    }
+}
+
+BigInt::BigInt(const std::string& str, unsigned radix) : negative_(false) {
+    const char* begin = str.data();
+    const char* end = begin + str.size();
+    if (begin != end && *begin == '-') {
+        negative_ = true;
+        ++begin;
+    }
+
+    if (radix == 10) {
+        // Each limb is a run of nine digits, counted from the end
+        digits_.reserve((end - begin) / LIMB_DIGITS + 1);
+        for (const char* chunk_end = end; chunk_end > begin;) {
+            const char* chunk_start = chunk_end - begin > static_cast<std::ptrdiff_t>(LIMB_DIGITS)
+                                          ? chunk_end - LIMB_DIGITS
+                                          : begin;
+            digits_.push_back(read_limb(chunk_start, chunk_end));
+            chunk_end = chunk_start;
+        }
+    } else {
+        const unsigned bits = radix_bits(radix);
+        Words words((static_cast<size_t>(end - begin) * bits + 31) / 32 + 1, 0);
+        size_t position = 0;
+        for (const char* p = end; p != begin; position += bits) {
+            const int digit = digit_value(*--p);
+            if (digit >= static_cast<int>(radix)) {
+                throw std::invalid_argument("Invalid digit in integer text");
+            }
+            const uint64_t shifted = static_cast<uint64_t>(digit) << (position % 32);
+            words[position / 32] |= static_cast<uint32_t>(shifted);
+            words[position / 32 + 1] |= static_cast<uint32_t>(shifted >> 32);
+        }
+        digits_ = from_words(words);
+    }
+
+    if (digits_.empty()) {
+        digits_.push_back(0);
+    }
+    normalize();
+}
+
+void BigInt::normalize() {
+    while (digits_.size() > 1 && digits_.back() == 0) {
+        digits_.pop_back();
+    }
+
+    if (digits_.size() == 1 && digits_[0] == 0) {
+        negative_ = false;
+    }
+}
+
+BigInt BigInt::operator+(const BigInt& other) const {
+    BigInt result;
+
+    if (negative_ == other.negative_) {
+        result.digits_ = add(digits_.data(), digits_.size(), other.digits_.data(), other.digits_.size());
+        result.negative_ = negative_;
+    } else if (compare(digits_, other.digits_) >= 0) {
+        result.digits_ = digits_;
+        subtract_into(result.digits_, other.digits_);
+        result.negative_ = negative_;
+    } else {
+        result.digits_ = other.digits_;
+        subtract_into(result.digits_, digits_);
+        result.negative_ = other.negative_;
+    }
+
+    result.normalize();
+    return result;
+}
+
+BigInt BigInt::operator-(const BigInt& other) const {
+    return *this + -other;
+}
+
+BigInt BigInt::operator-() const {
+    BigInt result = *this;
+    result.negative_ = !negative_;
+    result.normalize();
+    return result;
+}
+
+BigInt BigInt::operator*(const BigInt& other) const {
+    BigInt result;
+    result.digits_ = multiply(digits_, other.digits_);
+    result.negative_ = negative_ != other.negative_;
+    result.normalize();
+    return result;
+}
+
+std::pair<BigInt, BigInt> BigInt::divmod(const BigInt& dividend, const BigInt& divisor) {
+    if (divisor.is_zero()) {
+        throw std::domain_error("BigInt division by zero");
+    }
+
+    BigInt quotient;
+    BigInt remainder;
+    divide(dividend.digits_, divisor.digits_, quotient.digits_, remainder.digits_);
+
+    // Truncate toward zero like int64_t division
+    quotient.negative_ = dividend.negative_ != divisor.negative_;
+    remainder.negative_ = dividend.negative_;
+    quotient.normalize();
+    remainder.normalize();
+    return {quotient, remainder};
+}
+
+BigInt BigInt::operator/(const BigInt& other) const {
+    return divmod(*this, other).first;
+}
+
+BigInt BigInt::operator%(const BigInt& other) const {
+    return divmod(*this, other).second;
+}
+
+BigInt BigInt::pow_mod(const BigInt& base, const BigInt& exponent, const BigInt& modulus) {
+    if (modulus.is_zero()) {
+        throw std::domain_error("BigInt modulus is zero");
+    }
+    if (exponent.negative_) {
+        throw std::domain_error("BigInt exponent is negative");
+    }
+
+    const Limbs& n = modulus.digits_;
+    BigInt result;
+    if (n.size() == 1 && n[0] == 1) {
+        return result;
+    }
+
+    // Reduce the base into [0, n)
+    Limbs quotient;
+    Limbs reduced;
+    divide(base.digits_, n, quotient, reduced);
+    if (base.negative_ && !(reduced.size() == 1 && reduced[0] == 0)) {
+        Limbs flipped = n;
+        subtract_into(flipped, reduced);
+        trim(flipped);
+        reduced = flipped;
+    }
+
+    const Words bits = to_words(exponent.digits_);
+    if (n[0] % 2 != 0 && n[0] % 5 != 0) {
+        const Montgomery field(n);
+        Limbs x = power(field.to_form(reduced), bits, field.to_form(Limbs{1}),
+                        [&](const Limbs& a, const Limbs& b) { return field.product(a, b); });
+        result.digits_ = field.from_form(x);
+    } else {
+        result.digits_ = power(reduced, bits, Limbs{1}, [&](const Limbs& a, const Limbs& b) {
+            Limbs q;
+            Limbs r;
+            divide(multiply(a, b), n, q, r);
+            return r;
+        });
+    }
+
+    result.normalize();
+    return result;
+}
+
+bool BigInt::operator==(const BigInt& other) const {
+    return negative_ == other.negative_ && digits_ == other.digits_;
+}
+
+bool BigInt::operator!=(const BigInt& other) const {
+    return !(*this == other);
+}
+
+bool BigInt::operator<(const BigInt& other) const {
+    if (negative_ != other.negative_) {
+        return negative_;
+    }
+
+    int order = compare(digits_, other.digits_);
+    return negative_ ? order > 0 : order < 0;
+}
+
+bool BigInt::operator<=(const BigInt& other) const {
+    return !(other < *this);
+}
+
+bool BigInt::operator>(const BigInt& other) const {
+    return other < *this;
+}
+
+bool BigInt::operator>=(const BigInt& other) const {
+    return !(*this < other);
+}
+
+std::optional<int64_t> BigInt::to_int64() const {
+    // 2^63 has 19 decimal digits, so anything longer cannot fit
+    if (digits_.size() > 3) {
+        return std::nullopt;
+    }
+
+    uint64_t magnitude = 0;
+    for (size_t i = digits_.size(); i-- > 0;) {
+        if (__builtin_mul_overflow(magnitude, BASE, &magnitude) ||
+            __builtin_add_overflow(magnitude, static_cast<uint64_t>(digits_[i]), &magnitude)) {
+            return std::nullopt;
+        }
+    }
+
+    constexpr uint64_t LIMIT = static_cast<uint64_t>(INT64_MAX);
+    if (negative_) {
+        if (magnitude > LIMIT + 1) return std::nullopt;
+        return static_cast<int64_t>(0 - magnitude);
+    }
+
+    if (magnitude > LIMIT) return std::nullopt;
+    return static_cast<int64_t>(magnitude);
+}
+
+double BigInt::to_double() const {
+    double result = 0.0;
+    for (size_t i = digits_.size(); i-- > 0;) {
+        result = result * BASE + digits_[i];
+    }
+    return negative_ ? -result : result;
+}
+
+std::string BigInt::to_string(unsigned radix) const {
+    if (is_zero()) {
+        return "0";
+    }
+
+    std::string text;
+    if (radix == 10) {
+        // Top limb without padding, then nine digits for each other one
+        char top[LIMB_DIGITS + 1];
+        char* top_end = std::to_chars(top, top + sizeof(top), digits_.back()).ptr;
+        const size_t top_length = static_cast<size_t>(top_end - top);
+
+        text.resize(negative_ + top_length + (digits_.size() - 1) * LIMB_DIGITS);
+        char* out = text.data();
+        if (negative_) *out++ = '-';
+        std::memcpy(out, top, top_length);
+        out += top_length;
+        for (size_t i = digits_.size() - 1; i-- > 0; out += LIMB_DIGITS) {
+            write_limb(out, static_cast<uint32_t>(digits_[i]));
+        }
+        return text;
+    }
+
+    const unsigned bits = radix_bits(radix);
+    const Words words = to_words(digits_);
+    const unsigned top_bits = 32 - static_cast<unsigned>(__builtin_clz(words.back()));
+    const size_t total_bits = (words.size() - 1) * 32 + top_bits;
+    const size_t length = (total_bits + bits - 1) / bits;
+
+    text.resize(negative_ + length);
+    char* out = text.data() + text.size();
+    for (size_t position = 0; position < total_bits; position += bits) {
+        uint64_t window = words[position / 32];
+        if (position / 32 + 1 < words.size()) {
+            window |= static_cast<uint64_t>(words[position / 32 + 1]) << 32;
+        }
+        *--out = "0123456789abcdef"[(window >> (position % 32)) & ((1u << bits) - 1)];
+    }
+    if (negative_) text[0] = '-';
+    return text;
+}
+
+} // namespace kaynat
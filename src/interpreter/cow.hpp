@@ -0,0 +1,53 @@
+/**
+ * @file cow.hpp
+ * @brief Reference-counted shared storage for Kaynat++ values
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+namespace kaynat {
+
+/**
+ * @brief Reference count at the start of every boxed payload
+ *
+ * KaynatValue stores a single CowHeader pointer for all heap types and
+ * recovers the payload from its type tag, so a boxed value costs one
+ * pointer and no control block.
+ *
+ * Thread-safe: Counting is atomic, so copies may be made and dropped on
+ * different threads while the payload is only read.
+ */
+struct CowHeader {
+    std::atomic<uint32_t> refs{1};
+
+    void retain() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Drop one reference
+     * @return true if this was the last one and the box must be freed
+     */
+    bool release() { return refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+};
+
+/**
+ * @brief Reference-counted box holding an immutable payload
+ *
+ * Copying a value shares the box. The payload is never written after
+ * construction: operations that change a list or dictionary build a new
+ * one, so a box may be shared freely. KaynatValue keeps strings, big integers, lists,
+ * dictionaries, instances and functions in boxes so that passing,
+ * loading and storing them never copies their contents.
+ */
+template <typename T>
+struct CowBox : CowHeader {
+    template <typename... Args>
+    explicit CowBox(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T value;
+};
+
+} // namespace kaynat
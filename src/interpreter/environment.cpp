@@ -5,69 +5,136 @@
 
 #include "environment.hpp"
 #include "../errors/error_types.hpp"
+#include <atomic>
 
 namespace kaynat {
 
-Environment::Environment(std::shared_ptr<Environment> parent)
-    : parent_(parent) {}
+ScopePool::ScopePool() {
+    static std::atomic<uint64_t> next_id{1};
+    id_ = next_id.fetch_add(1, std::memory_order_relaxed);
+}
 
-void Environment::define(const std::string& name, const KaynatValue& value, bool is_constant) {
-    if (variables_.find(name) != variables_.end()) {
-        throw RuntimeError("Variable '" + name + "' already defined in this scope", 0, 0);
+std::shared_ptr<Scope> ScopePool::acquire(size_t slot_count, std::shared_ptr<Scope> parent) {
+    std::shared_ptr<Scope> scope;
+    if (free_.empty()) {
+        scope = std::make_shared<Scope>();
+    } else {
+        scope = std::move(free_.back());
+        free_.pop_back();
+    }
+    
+    scope->slots.resize(slot_count);
+    scope->parent = std::move(parent);
+    scope->owner = id_;
+    return scope;
+}
+
+void ScopePool::release(std::shared_ptr<Scope> scope) {
+    // A captured scope must keep its values for the closure
+    if (scope == nullptr || scope.use_count() != 1 || free_.size() >= MAX_FREE) {
+        return;
+    }
+    
+    scope->slots.clear();
+    scope->parent.reset();
+    free_.push_back(std::move(scope));
+}
+
+std::shared_ptr<Scope> copy_scopes(const std::shared_ptr<Scope>& scope) {
+    if (scope == nullptr) {
+        return nullptr;
     }
     
-    variables_[name] = value;
-    if (is_constant) {
-        constants_[name] = true;
+    auto result = std::make_shared<Scope>();
+    result->slots = scope->slots;
+    result->parent = copy_scopes(scope->parent);
+    return result;
+}
+
+Environment::Environment(std::shared_ptr<Environment> parent, BuiltinLookup builtins)
+    : parent_(parent), builtins_(builtins) {}
+
+void Environment::define(Symbol name, const KaynatValue& value, bool is_constant) {
+    if (variables_.find(name) != variables_.end() || (parent_ == nullptr && find_builtin(name))) {
+        throw RuntimeError("Variable '" + name.str() + "' already defined in this scope", 0, 0);
     }
+    
+    variables_[name] = Entry{value, is_constant};
+    version_++;
 }
 
-KaynatValue Environment::get(const std::string& name) const {
+KaynatValue Environment::get(Symbol name) const {
     const Environment* env = find_environment(name);
     if (env == nullptr) {
-        throw UndefinedError(name, 0, 0);
+        if (const KaynatValue* builtin = find_builtin(name)) {
+            return *builtin;
+        }
+        throw UndefinedError(name.str(), 0, 0);
     }
     
-    return env->variables_.at(name);
+    return env->variables_.at(name).value;
 }
 
-void Environment::set(const std::string& name, const KaynatValue& value) {
+void Environment::set(Symbol name, const KaynatValue& value) {
     Environment* env = find_environment(name);
     if (env == nullptr) {
-        throw UndefinedError(name, 0, 0);
+        if (!find_builtin(name)) {
+            throw UndefinedError(name.str(), 0, 0);
+        }
+        
+        Environment* outermost = this;
+        while (outermost->parent_ != nullptr) {
+            outermost = outermost->parent_.get();
+        }
+        outermost->variables_[name] = Entry{value, false};
+        outermost->version_++;
+        return;
     }
     
-    if (env->is_constant(name)) {
-        throw RuntimeError("Cannot modify constant '" + name + "'", 0, 0);
+    Entry& entry = env->variables_.at(name);
+    if (entry.constant) {
+        throw RuntimeError("Cannot modify constant '" + name.str() + "'", 0, 0);
     }
     
-    env->variables_[name] = value;
+    entry.value = value;
 }
 
-bool Environment::exists(const std::string& name) const {
-    return find_environment(name) != nullptr;
+bool Environment::exists(Symbol name) const {
+    return find_environment(name) != nullptr || find_builtin(name) != nullptr;
 }
 
-void Environment::remove(const std::string& name) {
+void Environment::remove(Symbol name) {
     auto it = variables_.find(name);
     if (it == variables_.end()) {
-        throw UndefinedError(name, 0, 0);
+        throw UndefinedError(name.str(), 0, 0);
     }
     
     variables_.erase(it);
-    constants_.erase(name);
+    version_++;
+}
+
+bool Environment::is_constant(Symbol name) const {
+    auto it = variables_.find(name);
+    return it != variables_.end() && it->second.constant;
 }
 
-bool Environment::is_constant(const std::string& name) const {
-    auto it = constants_.find(name);
-    return it != constants_.end() && it->second;
+KaynatValue* Environment::find_local(Symbol name) {
+    auto it = variables_.find(name);
+    return it != variables_.end() ? &it->second.value : nullptr;
 }
 
 std::shared_ptr<Environment> Environment::create_child() {
-    return std::make_shared<Environment>(shared_from_this());
+    return std::make_shared<Environment>(shared_from_this(), builtins_);
+}
+
+std::shared_ptr<Environment> Environment::copy() const {
+    auto result = std::make_shared<Environment>(parent_, builtins_);
+    result->variables_ = variables_;
+    result->version_ = version_;
+    return result;
 }
 
-Environment* Environment::find_environment(const std::string& name) {
+Environment* Environment::find_environment(Symbol name) {
     if (variables_.find(name) != variables_.end()) {
         return this;
     }
@@ -79,7 +146,7 @@ Environment* Environment::find_environment(const std::string& name) {
     return nullptr;
 }
 
-const Environment* Environment::find_environment(const std::string& name) const {
+const Environment* Environment::find_environment(Symbol name) const {
     if (variables_.find(name) != variables_.end()) {
         return this;
     }
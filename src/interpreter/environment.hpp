@@ -8,41 +8,136 @@
 #pragma once
 
 #include "runtime_value.hpp"
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace kaynat {
 
+/**
+ * @brief Storage for one resolved variable
+ * 
+ * Slots start undefined so that lookups fall through to outer scopes
+ * until the variable is first assigned.
+ */
+struct Slot {
+    KaynatValue value;
+    bool defined = false;
+    bool constant = false;
+};
+
+/**
+ * @brief Flat variable storage for one function call
+ * 
+ * Variables are addressed by slot index as assigned by the Resolver.
+ * Nested functions keep their defining scope alive through the parent
+ * chain.
+ */
+struct Scope {
+    std::vector<Slot> slots;
+    std::shared_ptr<Scope> parent;
+    uint64_t owner = 0;  // id() of the pool that handed it out
+};
+
+/**
+ * @brief Copy a scope and every scope enclosing it
+ * 
+ * The copies belong to no pool. Used to give a task the variables its
+ * function captured, as they were when the task was spawned.
+ */
+std::shared_ptr<Scope> copy_scopes(const std::shared_ptr<Scope>& scope);
+
+/**
+ * @brief Free list of call scopes
+ * 
+ * Calls take their Scope from the pool and hand it back on return. A
+ * scope that a nested function still holds as its closure is left to
+ * its owners; any other is cleared and kept, together with the
+ * capacity of its slot array, so steady-state calls do not allocate.
+ * 
+ * Thread-safe: No. Each engine keeps its own pool.
+ */
+class ScopePool {
+public:
+    ScopePool();
+    
+    /**
+     * @brief Number recorded as the owner of every scope handed out
+     * 
+     * Unique for the lifetime of the process, so a scope can be told to
+     * belong to this pool even after the pool that made it is gone.
+     */
+    uint64_t id() const { return id_; }
+    
+    /**
+     * @brief Get an empty scope
+     * @param slot_count Number of undefined slots it should have
+     * @param parent Enclosing scope
+     */
+    std::shared_ptr<Scope> acquire(size_t slot_count, std::shared_ptr<Scope> parent);
+    
+    /**
+     * @brief Return a scope whose call has finished
+     */
+    void release(std::shared_ptr<Scope> scope);
+    
+private:
+    static constexpr size_t MAX_FREE = 256;  // Bounds memory kept after deep recursion
+    
+    uint64_t id_;
+    std::vector<std::shared_ptr<Scope>> free_;
+};
+
 /**
  * @brief Environment for variable storage with lexical scoping
  * 
- * Manages variables in a scope chain. Each environment has an optional
+ * Holds variables by interned name. Function locals are resolved to Scope slots
+ * ahead of time, so environments mainly serve the global scope, where
+ * the REPL may define names at any point. Manages variables in a scope
+ * chain. Each environment has an optional
  * parent environment for nested scopes. Supports:
  * - Variable definition and lookup
  * - Constant enforcement
  * - Scope chaining
  * - Variable shadowing
+ * - Read-only builtins outside the outermost scope
+ * 
+ * Builtins are not stored in the environment. Their names cannot be
+ * defined again, and assigning to one creates a variable that hides it.
  * 
- * Thread-safe: No. Each interpreter instance should have its own environment.
+ * Thread-safe: Concurrent lookups are safe; definitions and assignments
+ * are not, which is why parallel loops may not change globals and tasks
+ * work on a copy().
  */
 class Environment : public std::enable_shared_from_this<Environment> {
 public:
+    /**
+     * @brief Finds a builtin by name, or returns null
+     * 
+     * The returned value must stay valid and unchanged for the life of
+     * the process.
+     */
+    using BuiltinLookup = const KaynatValue* (*)(Symbol name);
+    
     /**
      * @brief Create a new environment
      * @param parent Optional parent environment for scope chaining
+     * @param builtins Optional lookup consulted after every scope in the chain
      */
-    explicit Environment(std::shared_ptr<Environment> parent = nullptr);
+    explicit Environment(std::shared_ptr<Environment> parent = nullptr, BuiltinLookup builtins = nullptr);
     
     /**
      * @brief Define a new variable in this scope
      * @param name Variable name
      * @param value Initial value
      * @param is_constant Whether variable is constant
-     * @throws RuntimeError if variable already exists in this scope
+     * @throws RuntimeError if variable already exists in this scope, or
+     *         is a builtin and this is the outermost scope
      */
-    void define(const std::string& name, const KaynatValue& value, bool is_constant = false);
+    void define(Symbol name, const KaynatValue& value, bool is_constant = false);
     
     /**
      * @brief Get variable value
@@ -50,37 +145,62 @@ public:
      * @return Value if found
      * @throws UndefinedError if variable not found in any scope
      */
-    KaynatValue get(const std::string& name) const;
+    KaynatValue get(Symbol name) const;
     
     /**
      * @brief Set variable value
+     * 
+     * A builtin is not changed; the outermost scope gets a variable of
+     * the same name instead.
+     * 
      * @param name Variable name
      * @param value New value
      * @throws UndefinedError if variable not found
      * @throws RuntimeError if trying to modify constant
      */
-    void set(const std::string& name, const KaynatValue& value);
+    void set(Symbol name, const KaynatValue& value);
     
     /**
      * @brief Check if variable exists in any scope
      * @param name Variable name
      * @return true if variable exists
      */
-    bool exists(const std::string& name) const;
+    bool exists(Symbol name) const;
     
     /**
      * @brief Remove variable from this scope
      * @param name Variable name
      * @throws UndefinedError if variable not found in this scope
      */
-    void remove(const std::string& name);
+    void remove(Symbol name);
     
     /**
      * @brief Check if variable is constant
      * @param name Variable name
      * @return true if variable is constant
      */
-    bool is_constant(const std::string& name) const;
+    bool is_constant(Symbol name) const;
+    
+    /**
+     * @brief Look up a variable in this scope only
+     * @param name Variable name
+     * @return Pointer to the stored value, or nullptr if not defined here
+     * 
+     * The pointer stays valid until the variable is removed. Callers that
+     * cache the result must compare version() before reusing it.
+     */
+    KaynatValue* find_local(Symbol name);
+    
+    /**
+     * @brief Look up a builtin, whether or not a variable hides it
+     * @return Pointer to the shared value, or nullptr if there is none
+     */
+    const KaynatValue* find_builtin(Symbol name) const { return builtins_ ? builtins_(name) : nullptr; }
+    
+    /**
+     * @brief Counter that changes whenever a variable is defined or removed
+     */
+    uint64_t version() const { return version_; }
     
     /**
      * @brief Get parent environment
@@ -92,17 +212,34 @@ public:
      */
     std::shared_ptr<Environment> create_child();
     
+    /**
+     * @brief Copy this scope's variables, sharing the parent
+     * 
+     * Values share their contents, which are never modified, so this
+     * copies no contents.
+     */
+    std::shared_ptr<Environment> copy() const;
+    
 private:
+    /**
+     * @brief A variable and whether it is constant
+     */
+    struct Entry {
+        KaynatValue value;
+        bool constant = false;
+    };
+    
     std::shared_ptr<Environment> parent_;
-    std::unordered_map<std::string, KaynatValue> variables_;
-    std::unordered_map<std::string, bool> constants_;
+    BuiltinLookup builtins_;
+    std::unordered_map<Symbol, Entry> variables_;
+    uint64_t version_ = 0;
     
     /**
      * @brief Find environment containing variable
      * @return Environment pointer or nullptr if not found
      */
-    Environment* find_environment(const std::string& name);
-    const Environment* find_environment(const std::string& name) const;
+    Environment* find_environment(Symbol name);
+    const Environment* find_environment(Symbol name) const;
 };
 
 } // namespace kaynat
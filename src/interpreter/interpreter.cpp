@@ -4,104 +4,93 @@
  */
 
 #include "interpreter.hpp"
+#include "../compiler/resolver.hpp"
 #include "../errors/error_types.hpp"
 #include "../stdlib/stdlib.hpp"
-#include "../gui/gui_system.hpp"
-#include <iostream>
-#include <cmath>
-#include <algorithm>
+#include "../gui/gui_commands.hpp"
+#include "operators.hpp"
+#include "parallel.hpp"
+#include "task.hpp"
+#include <iterator>
+#include <string>
+#include <utility>
 
 namespace kaynat {
 
 Interpreter::Interpreter()
-    : global_env_(std::make_shared<Environment>()),
-      current_env_(global_env_),
-      return_flag_(false) {
+    : global_env_(std::make_shared<Environment>(nullptr, stdlib::builtin_value)),
+      return_flag_(false),
+      root_(this),
+      tasks_(std::make_shared<TaskGroup>()),
+      parallel_(false),
+      isolated_(false) {
     register_builtin_functions();
-    register_stdlib_functions();
 }
 
-KaynatValue Interpreter::execute(const std::shared_ptr<ProgramNode>& program) {
-    return eval_program(program);
+Interpreter::Interpreter(const Interpreter& creator, std::shared_ptr<Environment> globals, bool isolated)
+    : global_env_(std::move(globals)),
+      ast_(creator.ast_),
+      return_flag_(false),
+      root_(creator.root_),
+      tasks_(creator.tasks_),
+      parallel_(true),
+      isolated_(isolated) {}
+
+KaynatValue Interpreter::execute(const std::shared_ptr<Ast>& ast) {
+    Resolver resolver;
+    resolver.resolve(*ast);
+    
+    // Start at the top level even if a previous run stopped inside a call
+    ast_ = ast;
+    current_scope_ = nullptr;
+    tail_call_.reset();
+    KaynatValue result = eval_program(ast->program());
+    
+    // A top-level "give back" ends the program, not the interpreter session
+    return_flag_ = false;
+    return result;
 }
 
-KaynatValue Interpreter::evaluate(const ASTNode& node) {
-    return std::visit([this](auto&& arg) -> KaynatValue {
-        using T = std::decay_t<decltype(arg)>;
-        
-        if constexpr (std::is_same_v<T, std::monostate>) {
-            return KaynatValue();
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<ProgramNode>>) {
-            return eval_program(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<LiteralNode>>) {
-            return eval_literal(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<IdentifierNode>>) {
-            return eval_identifier(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<BinaryOpNode>>) {
-            return eval_binary_op(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<UnaryOpNode>>) {
-            return eval_unary_op(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<AssignmentNode>>) {
-            return eval_assignment(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<IfNode>>) {
-            return eval_if(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<WhileNode>>) {
-            return eval_while(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<RepeatNode>>) {
-            return eval_repeat(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<ForEachNode>>) {
-            return eval_for_each(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<FunctionDefNode>>) {
-            return eval_function_def(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<FunctionCallNode>>) {
-            return eval_function_call(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<ReturnNode>>) {
-            return eval_return(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<ListNode>>) {
-            return eval_list(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<DictNode>>) {
-            return eval_dict(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<IndexNode>>) {
-            return eval_index(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<PropertyAccessNode>>) {
-            return eval_property_access(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<BlockNode>>) {
-            return eval_block(arg);
-        }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<GUINode>>) {
-            return eval_gui(arg);
-        }
-        
-        return KaynatValue();
-    }, node);
+// Indexed by NodeKind. Dispatching through a table lets every call site
+// of evaluate() keep its own indirect branch once it is inlined.
+const Interpreter::Evaluator Interpreter::EVALUATORS[] = {
+    [](Interpreter&, NodeRef) { return KaynatValue(); },
+    [](Interpreter& self, NodeRef node) { return self.eval_program(self.ast_->get<ProgramNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_literal(self.ast_->get<LiteralNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_identifier(self.ast_->get<IdentifierNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_binary_op(self.ast_->get<BinaryOpNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_unary_op(self.ast_->get<UnaryOpNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_assignment(self.ast_->get<AssignmentNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_if(self.ast_->get<IfNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_while(self.ast_->get<WhileNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_repeat(self.ast_->get<RepeatNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_for_each(self.ast_->get<ForEachNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_function_def(self.ast_->get<FunctionDefNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_function_call(self.ast_->get<FunctionCallNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_return(self.ast_->get<ReturnNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_list(self.ast_->get<ListNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_dict(self.ast_->get<DictNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_index(self.ast_->get<IndexNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_property_access(self.ast_->get<PropertyAccessNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_block(self.ast_->get<BlockNode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_gui(self.ast_->get<GUINode>(node)); },
+    [](Interpreter& self, NodeRef node) { return self.eval_wait(self.ast_->get<WaitNode>(node)); },
+};
+
+KaynatValue Interpreter::evaluate(NodeRef node) {
+    static_assert(std::size(EVALUATORS) == static_cast<size_t>(NodeKind::WAIT) + 1,
+                  "EVALUATORS must cover every NodeKind");
+    return EVALUATORS[static_cast<size_t>(node.kind())](*this, node);
 }
 
-KaynatValue Interpreter::eval_program(const std::shared_ptr<ProgramNode>& node) {
+KaynatValue Interpreter::eval_program(ProgramNode& node) {
     KaynatValue last_value;
     
-    for (const auto& stmt : node->statements) {
+    for (NodeRef stmt : ast_->list(node.statements)) {
         if (return_flag_) break;
         
         // Skip empty statements (comments)
-        if (std::holds_alternative<std::monostate>(stmt)) {
+        if (stmt.empty()) {
             continue;
         }
         
@@ -111,200 +100,92 @@ KaynatValue Interpreter::eval_program(const std::shared_ptr<ProgramNode>& node)
     return last_value;
 }
 
-KaynatValue Interpreter::eval_literal(const std::shared_ptr<LiteralNode>& node) {
-    switch (node->type) {
-        case LiteralNode::Type::INTEGER:
-            return KaynatValue(static_cast<int64_t>(std::stoll(node->value)));
-        
-        case LiteralNode::Type::FLOAT:
-            return KaynatValue(std::stod(node->value));
-        
-        case LiteralNode::Type::STRING:
-            return KaynatValue(node->value);
-        
-        case LiteralNode::Type::BOOLEAN:
-            return KaynatValue(node->value == "true");
-        
-        case LiteralNode::Type::NULL_VALUE:
-            return KaynatValue();
-    }
-    
-    return KaynatValue();
+KaynatValue Interpreter::eval_literal(LiteralNode& node) {
+    return node.constant;
 }
 
-KaynatValue Interpreter::eval_identifier(const std::shared_ptr<IdentifierNode>& node) {
-    return current_env_->get(node->name);
+KaynatValue Interpreter::eval_identifier(IdentifierNode& node) {
+    return lookup(node.name, node.binding);
 }
 
-KaynatValue Interpreter::eval_binary_op(const std::shared_ptr<BinaryOpNode>& node) {
-    KaynatValue left = evaluate(node->left);
-    KaynatValue right = evaluate(node->right);
-    
-    switch (node->op) {
-        case BinaryOpNode::Op::ADD: {
-            auto l_int = left.as_int();
-            auto r_int = right.as_int();
-            if (l_int && r_int) {
-                return KaynatValue(*l_int + *r_int);
-            }
-            
-            // Handle mixed int/float
-            double l_val = l_int ? static_cast<double>(*l_int) : (left.as_float() ? *left.as_float() : 0.0);
-            double r_val = r_int ? static_cast<double>(*r_int) : (right.as_float() ? *right.as_float() : 0.0);
-            
-            if (left.as_float() || right.as_float()) {
-                return KaynatValue(l_val + r_val);
-            }
-            
-            // String concatenation
-            return KaynatValue(left.to_string() + right.to_string());
-        }
-        
-        case BinaryOpNode::Op::SUBTRACT: {
-            auto l_int = left.as_int();
-            auto r_int = right.as_int();
-            if (l_int && r_int) {
-                return KaynatValue(*l_int - *r_int);
-            }
-            
-            // Handle mixed int/float
-            double l_val = l_int ? static_cast<double>(*l_int) : (left.as_float() ? *left.as_float() : 0.0);
-            double r_val = r_int ? static_cast<double>(*r_int) : (right.as_float() ? *right.as_float() : 0.0);
-            
-            if (left.as_float() || right.as_float()) {
-                return KaynatValue(l_val - r_val);
-            }
-            
-            throw TypeError("Number", left.type_name(), node->line, 0);
-        }
-        
-        case BinaryOpNode::Op::MULTIPLY: {
-            auto l_int = left.as_int();
-            auto r_int = right.as_int();
-            if (l_int && r_int) {
-                return KaynatValue(*l_int * *r_int);
-            }
-            
-            // Handle mixed int/float
-            double l_val = l_int ? static_cast<double>(*l_int) : (left.as_float() ? *left.as_float() : 0.0);
-            double r_val = r_int ? static_cast<double>(*r_int) : (right.as_float() ? *right.as_float() : 0.0);
-            
-            if (left.as_float() || right.as_float()) {
-                return KaynatValue(l_val * r_val);
-            }
-            
-            throw TypeError("Number", left.type_name(), node->line, 0);
-        }
-        
-        case BinaryOpNode::Op::DIVIDE: {
-            auto l_int = left.as_int();
-            auto r_int = right.as_int();
-            
-            // Always return float for division
-            double l_val = l_int ? static_cast<double>(*l_int) : (left.as_float() ? *left.as_float() : 0.0);
-            double r_val = r_int ? static_cast<double>(*r_int) : (right.as_float() ? *right.as_float() : 0.0);
-            
-            if (l_int || left.as_float()) {
-                if (r_val == 0.0) {
-                    throw DivisionByZeroError(node->line, 0);
-                }
-                return KaynatValue(l_val / r_val);
+KaynatValue Interpreter::eval_binary_op(BinaryOpNode& node) {
+    KaynatValue left = evaluate(node.left);
+    KaynatValue right = evaluate(node.right);
+    KaynatValue result;
+    
+    // Specialized sites check both operand tags once and skip ops::binary;
+    // isolated workers neither read nor write the shared feedback
+    switch (isolated_ ? BinaryOpNode::Feedback::GENERIC : node.feedback) {
+        case BinaryOpNode::Feedback::INT_INT:
+            if (left.type() == KaynatValue::Type::INTEGER && right.type() == KaynatValue::Type::INTEGER &&
+                ops::int_binary(node.op, *left.as_int_ptr(), *right.as_int_ptr(), result)) {
+                return result;
             }
-            
-            throw TypeError("Number", left.type_name(), node->line, 0);
-        }
+            break;
         
-        case BinaryOpNode::Op::MODULO: {
-            auto l_int = left.as_int();
-            auto r_int = right.as_int();
-            if (l_int && r_int) {
-                if (*r_int == 0) {
-                    throw DivisionByZeroError(node->line, 0);
-                }
-                return KaynatValue(*l_int % *r_int);
+        case BinaryOpNode::Feedback::FLOAT_FLOAT:
+            if (left.type() == KaynatValue::Type::FLOAT && right.type() == KaynatValue::Type::FLOAT &&
+                ops::float_binary(node.op, *left.as_float_ptr(), *right.as_float_ptr(), result)) {
+                return result;
             }
-            
-            throw TypeError("Integer", left.type_name(), node->line, 0);
-        }
-        
-        case BinaryOpNode::Op::EQUAL:
-            return KaynatValue(left == right);
-        
-        case BinaryOpNode::Op::NOT_EQUAL:
-            return KaynatValue(left != right);
-        
-        case BinaryOpNode::Op::LESS_THAN:
-            return KaynatValue(left < right);
-        
-        case BinaryOpNode::Op::LESS_EQUAL:
-            return KaynatValue(left <= right);
-        
-        case BinaryOpNode::Op::GREATER_THAN:
-            return KaynatValue(left > right);
-        
-        case BinaryOpNode::Op::GREATER_EQUAL:
-            return KaynatValue(left >= right);
+            break;
         
-        case BinaryOpNode::Op::AND:
-            return KaynatValue(left.is_truthy() && right.is_truthy());
+        case BinaryOpNode::Feedback::GENERIC:
+            return ops::binary(node.op, left, right, node.line);
         
-        case BinaryOpNode::Op::OR:
-            return KaynatValue(left.is_truthy() || right.is_truthy());
+        case BinaryOpNode::Feedback::UNSEEN:
+            break;
     }
     
-    return KaynatValue();
+    // Workers leave the shared program unchanged
+    if (!parallel_) {
+        node.feedback = observe_operands(node, left, right);
+    }
+    return ops::binary(node.op, left, right, node.line);
 }
 
-KaynatValue Interpreter::eval_unary_op(const std::shared_ptr<UnaryOpNode>& node) {
-    KaynatValue operand = evaluate(node->operand);
-    
-    switch (node->op) {
-        case UnaryOpNode::Op::NEGATE: {
-            auto int_val = operand.as_int();
-            if (int_val) {
-                return KaynatValue(-*int_val);
-            }
-            
-            auto float_val = operand.as_float();
-            if (float_val) {
-                return KaynatValue(-*float_val);
-            }
-            
-            throw TypeError("Number", operand.type_name(), node->line, 0);
+BinaryOpNode::Feedback Interpreter::observe_operands(const BinaryOpNode& node, const KaynatValue& left,
+                                                     const KaynatValue& right) {
+    using Feedback = BinaryOpNode::Feedback;
+    
+    Feedback seen = Feedback::GENERIC;
+    if (node.op != BinaryOpNode::Op::AND && node.op != BinaryOpNode::Op::OR) {
+        if (left.type() == KaynatValue::Type::INTEGER && right.type() == KaynatValue::Type::INTEGER) {
+            seen = Feedback::INT_INT;
+        } else if (left.type() == KaynatValue::Type::FLOAT && right.type() == KaynatValue::Type::FLOAT &&
+                   node.op != BinaryOpNode::Op::MODULO) {
+            seen = Feedback::FLOAT_FLOAT;
         }
-        
-        case UnaryOpNode::Op::NOT:
-            return KaynatValue(!operand.is_truthy());
     }
     
-    return KaynatValue();
+    // A failed guard deoptimizes the site instead of respecializing it
+    return node.feedback == Feedback::UNSEEN || node.feedback == seen ? seen : Feedback::GENERIC;
 }
 
-KaynatValue Interpreter::eval_assignment(const std::shared_ptr<AssignmentNode>& node) {
-    KaynatValue value = evaluate(node->value);
-    
-    if (current_env_->exists(node->name)) {
-        current_env_->set(node->name, value);
-    } else {
-        current_env_->define(node->name, value, node->is_constant);
-    }
-    
+KaynatValue Interpreter::eval_unary_op(UnaryOpNode& node) {
+    KaynatValue operand = evaluate(node.operand);
+    return ops::unary(node.op, operand, node.line);
+}
+
+KaynatValue Interpreter::eval_assignment(AssignmentNode& node) {
+    KaynatValue value = evaluate(node.value);
+    assign(node.name, node.binding, value, node.is_constant);
     return value;
 }
 
-KaynatValue Interpreter::eval_if(const std::shared_ptr<IfNode>& node) {
-    KaynatValue condition = evaluate(node->condition);
+KaynatValue Interpreter::eval_if(IfNode& node) {
+    KaynatValue condition = evaluate(node.condition);
     
     if (condition.is_truthy()) {
         KaynatValue last_value;
-        for (const auto& stmt : node->then_branch) {
+        for (NodeRef stmt : ast_->list(node.then_branch)) {
             if (return_flag_) break;
             last_value = evaluate(stmt);
         }
         return last_value;
-    } else if (!node->else_branch.empty()) {
+    } else if (!node.else_branch.empty()) {
         KaynatValue last_value;
-        for (const auto& stmt : node->else_branch) {
+        for (NodeRef stmt : ast_->list(node.else_branch)) {
             if (return_flag_) break;
             last_value = evaluate(stmt);
         }
@@ -314,11 +195,11 @@ KaynatValue Interpreter::eval_if(const std::shared_ptr<IfNode>& node) {
     return KaynatValue();
 }
 
-KaynatValue Interpreter::eval_while(const std::shared_ptr<WhileNode>& node) {
+KaynatValue Interpreter::eval_while(WhileNode& node) {
     KaynatValue last_value;
     
-    while (evaluate(node->condition).is_truthy()) {
-        for (const auto& stmt : node->body) {
+    while (evaluate(node.condition).is_truthy()) {
+        for (NodeRef stmt : ast_->list(node.body)) {
             if (return_flag_) break;
             last_value = evaluate(stmt);
         }
@@ -328,19 +209,19 @@ KaynatValue Interpreter::eval_while(const std::shared_ptr<WhileNode>& node) {
     return last_value;
 }
 
-KaynatValue Interpreter::eval_repeat(const std::shared_ptr<RepeatNode>& node) {
-    KaynatValue count_value = evaluate(node->count);
+KaynatValue Interpreter::eval_repeat(RepeatNode& node) {
+    KaynatValue count_value = evaluate(node.count);
     
     auto count_opt = count_value.as_int();
     if (!count_opt.has_value()) {
-        throw TypeError("Integer", count_value.type_name(), node->line, 0);
+        throw TypeError("Integer", count_value.type_name(), node.line, 0);
     }
     
     int64_t count = count_opt.value();
     KaynatValue last_value;
     
     for (int64_t i = 0; i < count; i++) {
-        for (const auto& stmt : node->body) {
+        for (NodeRef stmt : ast_->list(node.body)) {
             if (return_flag_) break;
             last_value = evaluate(stmt);
         }
@@ -350,173 +231,206 @@ KaynatValue Interpreter::eval_repeat(const std::shared_ptr<RepeatNode>& node) {
     return last_value;
 }
 
-KaynatValue Interpreter::eval_for_each(const std::shared_ptr<ForEachNode>& node) {
-    KaynatValue iterable = evaluate(node->iterable);
-    auto list = iterable.as_list();
+KaynatValue Interpreter::eval_for_each(ForEachNode& node) {
+    if (node.parallel) {
+        return eval_parallel_for_each(node);
+    }
+    
+    KaynatValue iterable = evaluate(node.iterable);
+    const ListType* list = iterable.as_list_ptr();
     
     if (!list) {
-        throw TypeError("List", iterable.type_name(), node->line, 0);
+        throw TypeError("List", iterable.type_name(), node.line, 0);
     }
     
     KaynatValue last_value;
-    auto loop_env = current_env_->create_child();
-    auto prev_env = current_env_;
-    current_env_ = loop_env;
     
     for (const auto& item : *list) {
-        loop_env->define(node->variable, item);
+        assign(node.variable, node.binding, item, false);
         
-        for (const auto& stmt : node->body) {
+        for (NodeRef stmt : ast_->list(node.body)) {
             if (return_flag_) break;
             last_value = evaluate(stmt);
         }
         if (return_flag_) break;
     }
     
-    current_env_ = prev_env;
     return last_value;
 }
 
-KaynatValue Interpreter::eval_function_def(const std::shared_ptr<FunctionDefNode>& node) {
-    // Capture the function definition
-    auto func_node = node;
-    auto closure_env = current_env_;
+KaynatValue Interpreter::eval_parallel_for_each(ForEachNode& node) {
+    KaynatValue iterable = evaluate(node.iterable);
+    const ListType* list = iterable.as_list_ptr();
     
-    CallableType callable = [this, func_node, closure_env](std::vector<KaynatValue> args) -> KaynatValue {
-        if (args.size() != func_node->parameters.size()) {
-            throw RuntimeError("Function expects " + std::to_string(func_node->parameters.size()) +
-                             " arguments, got " + std::to_string(args.size()), func_node->line, 0);
-        }
-        
-        // Create new environment for function execution
-        auto func_env = closure_env->create_child();
-        
-        // Bind parameters
-        for (size_t i = 0; i < args.size(); ++i) {
-            func_env->define(func_node->parameters[i], args[i]);
-        }
-        
-        // Execute function body
-        auto prev_env = current_env_;
-        current_env_ = func_env;
-        
-        KaynatValue result;
-        for (const auto& stmt : func_node->body) {
-            if (return_flag_) {
-                result = return_value_;
-                return_flag_ = false;
-                break;
-            }
-            result = evaluate(stmt);
+    if (!list) {
+        throw TypeError("List", iterable.type_name(), node.line, 0);
+    }
+    
+    const std::shared_ptr<Ast> ast = ast_;
+    const std::shared_ptr<Scope> closure = current_scope_;
+    
+    ListType results = parallel_map(list->size(), [&]() -> IterationRunner {
+        std::shared_ptr<Interpreter> worker(new Interpreter(*this, global_env_, isolated_));
+        return [worker, &node, &ast, &closure, list](size_t index) {
+            return worker->run_iteration(node, ast, closure, (*list)[index]);
+        };
+    });
+    
+    KaynatValue value(std::move(results));
+    if (!node.target.empty()) {
+        assign(node.target, node.target_binding, value, false);
+    }
+    return value;
+}
+
+KaynatValue Interpreter::run_iteration(const ForEachNode& node, const std::shared_ptr<Ast>& ast,
+                                       const std::shared_ptr<Scope>& closure, const KaynatValue& item) {
+    // Start clean even if this worker's previous iteration failed
+    ast_ = ast;
+    return_flag_ = false;
+    tail_call_.reset();
+    
+    // The body runs like a function taking the loop variable
+    current_scope_ = scopes_.acquire(node.layout.names.size(), closure);
+    current_scope_->slots[0].value = item;
+    current_scope_->slots[0].defined = true;
+    
+    KaynatValue result;
+    for (NodeRef stmt : ast_->list(node.body)) {
+        result = evaluate(stmt);
+        if (return_flag_) {
+            result = return_value_;
+            return_flag_ = false;
+            break;
         }
-        
-        current_env_ = prev_env;
-        return result;
-    };
+    }
     
-    current_env_->define(node->name, KaynatValue(callable));
+    scopes_.release(std::exchange(current_scope_, nullptr));
+    
+    if (tail_call_) {
+        TailCall pending = std::move(*tail_call_);
+        tail_call_.reset();
+        result = call_value(*pending.callee.as_callable_ptr(), std::move(pending.args));
+    }
+    return result;
+}
+
+KaynatValue Interpreter::eval_function_def(FunctionDefNode& node) {
+    InterpretedFunction function{root_, ast_, &node, current_scope_, nullptr};
+    if (node.memo) {
+        function.memo = std::make_shared<MemoTable>(node.parameters.size(), node.memo);
+    }
+    define(node.name, node.binding, KaynatValue(CallableType(std::move(function))));
     return KaynatValue();
 }
 
-KaynatValue Interpreter::eval_function_call(const std::shared_ptr<FunctionCallNode>& node) {
+KaynatValue Interpreter::eval_function_call(FunctionCallNode& node) {
     // Special handling for "say" function
-    if (node->name == "say") {
-        for (const auto& arg_node : node->arguments) {
-            KaynatValue arg = evaluate(arg_node);
-            std::cout << arg.to_string();
-            if (&arg_node != &node->arguments.back()) {
-                std::cout << " ";
+    if (node.is_say) {
+        NodeSpan args = ast_->list(node.arguments);
+        std::string line;
+        for (size_t i = 0; i < args.size(); ++i) {
+            KaynatValue arg = evaluate(args[i]);
+            line += arg.to_string();
+            if (i + 1 < args.size()) {
+                line += ' ';
             }
         }
-        std::cout << "\n";
+        say_line(line);
         return KaynatValue();
     }
     
-    // Get function
-    KaynatValue func_value = current_env_->get(node->name);
-    auto callable = func_value.as_callable();
+    if (node.is_spawn) {
+        if (Slot* slot = find_slot(node.binding)) {
+            KaynatValue callee = slot->value;
+            return spawn(callable_of(callee, node), evaluate_arguments(node));
+        }
+        std::vector<KaynatValue> args = evaluate_arguments(node);
+        return spawn(callable_of(global_callee(node), node), std::move(args));
+    }
     
-    if (!callable) {
-        throw TypeError("Function", func_value.type_name(), node->line, 0);
+    // Local functions are read before the arguments are evaluated
+    if (Slot* slot = find_slot(node.binding)) {
+        KaynatValue callee = slot->value;
+        return callable_of(callee, node)(evaluate_arguments(node));
     }
     
-    // Evaluate arguments
-    std::vector<KaynatValue> args;
-    for (const auto& arg_node : node->arguments) {
-        args.push_back(evaluate(arg_node));
+    // Global callees are read through the call site's cache after the
+    // arguments, which may redefine them
+    std::vector<KaynatValue> args = evaluate_arguments(node);
+    const CallableType& callable = callable_of(global_callee(node), node);
+    
+    if (const auto* function = callable.target<InterpretedFunction>(); function && function->interpreter == root_) {
+        return call(*function, std::move(args));
+    }
+    if (const auto* native = callable.target<NativeFunction>()) {
+        KaynatValue result = (*native)(args);
+        recycle_arguments(std::move(args));
+        return result;
     }
     
-    // Call function
-    return (*callable)(args);
+    // Other callables are copied in case the call replaces the global
+    CallableType copy = callable;
+    return copy(std::move(args));
 }
 
-KaynatValue Interpreter::eval_return(const std::shared_ptr<ReturnNode>& node) {
-    return_value_ = evaluate(node->value);
+KaynatValue Interpreter::eval_return(ReturnNode& node) {
+    // Inside a function, a returned call is made by call() after the
+    // current body has finished
+    auto* tail = ast_->get_if<FunctionCallNode>(node.value);
+    if (tail != nullptr && !tail->is_say && !tail->is_spawn && current_scope_) {
+        FunctionCallNode& call_node = *tail;
+        if (Slot* slot = find_slot(call_node.binding)) {
+            KaynatValue callee = slot->value;
+            callable_of(callee, call_node);
+            tail_call_ = TailCall{std::move(callee), evaluate_arguments(call_node)};
+        } else {
+            std::vector<KaynatValue> args = evaluate_arguments(call_node);
+            const KaynatValue& callee = global_callee(call_node);
+            callable_of(callee, call_node);
+            tail_call_ = TailCall{callee, std::move(args)};
+        }
+        return_value_ = KaynatValue();
+        return_flag_ = true;
+        return return_value_;
+    }
+    
+    return_value_ = evaluate(node.value);
     return_flag_ = true;
     return return_value_;
 }
 
-KaynatValue Interpreter::eval_list(const std::shared_ptr<ListNode>& node) {
+KaynatValue Interpreter::eval_list(ListNode& node) {
     ListType elements;
-    for (const auto& elem_node : node->elements) {
+    for (NodeRef elem_node : ast_->list(node.elements)) {
         elements.push_back(evaluate(elem_node));
     }
-    return KaynatValue(elements);
+    return KaynatValue(std::move(elements));
 }
 
-KaynatValue Interpreter::eval_dict(const std::shared_ptr<DictNode>& node) {
+KaynatValue Interpreter::eval_dict(DictNode& node) {
     DictType dict;
-    for (const auto& [key, value_node] : node->entries) {
+    for (const auto& [key, value_node] : node.entries) {
         dict[key] = evaluate(value_node);
     }
-    return KaynatValue(dict);
+    return KaynatValue(std::move(dict));
 }
 
-KaynatValue Interpreter::eval_index(const std::shared_ptr<IndexNode>& node) {
-    KaynatValue object = evaluate(node->object);
-    KaynatValue index = evaluate(node->index);
-    
-    auto list = object.as_list();
-    if (list) {
-        auto idx = index.as_int();
-        if (!idx) {
-            throw TypeError("Integer", index.type_name(), node->line, 0);
-        }
-        
-        if (*idx < 0 || static_cast<size_t>(*idx) >= list->size()) {
-            throw IndexError(*idx, list->size(), node->line, 0);
-        }
-        
-        return (*list)[*idx];
-    }
-    
-    auto dict = object.as_dict();
-    if (dict) {
-        auto key = index.as_string();
-        if (!key) {
-            throw TypeError("String", index.type_name(), node->line, 0);
-        }
-        
-        auto it = dict->find(*key);
-        if (it == dict->end()) {
-            return KaynatValue();
-        }
-        
-        return it->second;
-    }
-    
-    throw TypeError("List or Dictionary", object.type_name(), node->line, 0);
+KaynatValue Interpreter::eval_index(IndexNode& node) {
+    KaynatValue object = evaluate(node.object);
+    KaynatValue index = evaluate(node.index);
+    return ops::index(object, index, node.line);
 }
 
-KaynatValue Interpreter::eval_property_access([[maybe_unused]] const std::shared_ptr<PropertyAccessNode>& node) {
+KaynatValue Interpreter::eval_property_access([[maybe_unused]] PropertyAccessNode& node) {
     // Not implemented yet
     return KaynatValue();
 }
 
-KaynatValue Interpreter::eval_block(const std::shared_ptr<BlockNode>& node) {
+KaynatValue Interpreter::eval_block(BlockNode& node) {
     KaynatValue last_value;
     
-    for (const auto& stmt : node->statements) {
+    for (NodeRef stmt : ast_->list(node.statements)) {
         if (return_flag_) break;
         last_value = evaluate(stmt);
     }
@@ -524,265 +438,303 @@ KaynatValue Interpreter::eval_block(const std::shared_ptr<BlockNode>& node) {
     return last_value;
 }
 
-void Interpreter::register_builtin_functions() {
-    // Built-in functions will be registered here
+KaynatValue InterpretedFunction::operator()(std::vector<KaynatValue> args) const {
+    return interpreter->call(*this, std::move(args));
 }
 
-void Interpreter::register_stdlib_functions() {
-    // Math functions (20)
-    global_env_->define("sqrt", KaynatValue(CallableType(stdlib::math_sqrt)));
-    global_env_->define("pow", KaynatValue(CallableType(stdlib::math_pow)));
-    global_env_->define("abs", KaynatValue(CallableType(stdlib::math_abs)));
-    global_env_->define("floor", KaynatValue(CallableType(stdlib::math_floor)));
-    global_env_->define("ceil", KaynatValue(CallableType(stdlib::math_ceil)));
-    global_env_->define("round", KaynatValue(CallableType(stdlib::math_round)));
-    global_env_->define("sin", KaynatValue(CallableType(stdlib::math_sin)));
-    global_env_->define("cos", KaynatValue(CallableType(stdlib::math_cos)));
-    global_env_->define("tan", KaynatValue(CallableType(stdlib::math_tan)));
-    global_env_->define("log", KaynatValue(CallableType(stdlib::math_log)));
-    global_env_->define("log10", KaynatValue(CallableType(stdlib::math_log10)));
-    global_env_->define("exp", KaynatValue(CallableType(stdlib::math_exp)));
-    global_env_->define("min", KaynatValue(CallableType(stdlib::math_min)));
-    global_env_->define("max", KaynatValue(CallableType(stdlib::math_max)));
-    global_env_->define("factorial", KaynatValue(CallableType(stdlib::math_factorial)));
-    global_env_->define("gcd", KaynatValue(CallableType(stdlib::math_gcd)));
-    global_env_->define("lcm", KaynatValue(CallableType(stdlib::math_lcm)));
-    global_env_->define("is_prime", KaynatValue(CallableType(stdlib::math_is_prime)));
-    global_env_->define("random", KaynatValue(CallableType(stdlib::math_random)));
-    global_env_->define("pi", KaynatValue(CallableType(stdlib::math_pi)));
-    
-    // String functions (20)
-    global_env_->define("uppercase", KaynatValue(CallableType(stdlib::string_uppercase)));
-    global_env_->define("lowercase", KaynatValue(CallableType(stdlib::string_lowercase)));
-    global_env_->define("string_length", KaynatValue(CallableType(stdlib::string_length)));
-    global_env_->define("trim", KaynatValue(CallableType(stdlib::string_trim)));
-    global_env_->define("split", KaynatValue(CallableType(stdlib::string_split)));
-    global_env_->define("join", KaynatValue(CallableType(stdlib::string_join)));
-    global_env_->define("replace", KaynatValue(CallableType(stdlib::string_replace)));
-    global_env_->define("starts_with", KaynatValue(CallableType(stdlib::string_starts_with)));
-    global_env_->define("ends_with", KaynatValue(CallableType(stdlib::string_ends_with)));
-    global_env_->define("contains", KaynatValue(CallableType(stdlib::string_contains)));
-    global_env_->define("substring", KaynatValue(CallableType(stdlib::string_substring)));
-    global_env_->define("index_of", KaynatValue(CallableType(stdlib::string_index_of)));
-    global_env_->define("string_reverse", KaynatValue(CallableType(stdlib::string_reverse)));
-    global_env_->define("string_repeat", KaynatValue(CallableType(stdlib::string_repeat)));
-    global_env_->define("pad_left", KaynatValue(CallableType(stdlib::string_pad_left)));
-    global_env_->define("pad_right", KaynatValue(CallableType(stdlib::string_pad_right)));
-    global_env_->define("to_number", KaynatValue(CallableType(stdlib::string_to_number)));
-    global_env_->define("to_list", KaynatValue(CallableType(stdlib::string_to_list)));
-    global_env_->define("is_empty", KaynatValue(CallableType(stdlib::string_is_empty)));
-    global_env_->define("capitalize", KaynatValue(CallableType(stdlib::string_capitalize)));
-    
-    // List functions (20)
-    global_env_->define("list_length", KaynatValue(CallableType(stdlib::list_length)));
-    global_env_->define("list_append", KaynatValue(CallableType(stdlib::list_append)));
-    global_env_->define("list_prepend", KaynatValue(CallableType(stdlib::list_prepend)));
-    global_env_->define("list_insert", KaynatValue(CallableType(stdlib::list_insert)));
-    global_env_->define("list_remove", KaynatValue(CallableType(stdlib::list_remove)));
-    global_env_->define("list_get", KaynatValue(CallableType(stdlib::list_get)));
-    global_env_->define("list_set", KaynatValue(CallableType(stdlib::list_set)));
-    global_env_->define("list_slice", KaynatValue(CallableType(stdlib::list_slice)));
-    global_env_->define("list_sort", KaynatValue(CallableType(stdlib::list_sort)));
-    global_env_->define("list_reverse", KaynatValue(CallableType(stdlib::list_reverse)));
-    global_env_->define("list_contains", KaynatValue(CallableType(stdlib::list_contains)));
-    global_env_->define("list_index_of", KaynatValue(CallableType(stdlib::list_index_of)));
-    global_env_->define("list_min", KaynatValue(CallableType(stdlib::list_min)));
-    global_env_->define("list_max", KaynatValue(CallableType(stdlib::list_max)));
-    global_env_->define("list_sum", KaynatValue(CallableType(stdlib::list_sum)));
-    global_env_->define("list_filter", KaynatValue(CallableType(stdlib::list_filter)));
-    global_env_->define("list_map", KaynatValue(CallableType(stdlib::list_map)));
-    global_env_->define("list_reduce", KaynatValue(CallableType(stdlib::list_reduce)));
-    global_env_->define("list_unique", KaynatValue(CallableType(stdlib::list_unique)));
-    global_env_->define("list_flatten", KaynatValue(CallableType(stdlib::list_flatten)));
-    
-    // File functions (12)
-    global_env_->define("file_read", KaynatValue(CallableType(stdlib::file_read)));
-    global_env_->define("file_write", KaynatValue(CallableType(stdlib::file_write)));
-    global_env_->define("file_append", KaynatValue(CallableType(stdlib::file_append)));
-    global_env_->define("file_exists", KaynatValue(CallableType(stdlib::file_exists)));
-    global_env_->define("file_delete", KaynatValue(CallableType(stdlib::file_delete)));
-    global_env_->define("file_copy", KaynatValue(CallableType(stdlib::file_copy)));
-    global_env_->define("file_move", KaynatValue(CallableType(stdlib::file_move)));
-    global_env_->define("file_size", KaynatValue(CallableType(stdlib::file_size)));
-    global_env_->define("file_list_dir", KaynatValue(CallableType(stdlib::file_list_dir)));
-    global_env_->define("file_create_dir", KaynatValue(CallableType(stdlib::file_create_dir)));
-    global_env_->define("file_is_file", KaynatValue(CallableType(stdlib::file_is_file)));
-    global_env_->define("file_is_dir", KaynatValue(CallableType(stdlib::file_is_dir)));
-    
-    // Date functions (5)
-    global_env_->define("date_now", KaynatValue(CallableType(stdlib::date_now)));
-    global_env_->define("date_format", KaynatValue(CallableType(stdlib::date_format)));
-    global_env_->define("date_parse", KaynatValue(CallableType(stdlib::date_parse)));
-    global_env_->define("date_add_days", KaynatValue(CallableType(stdlib::date_add_days)));
-    global_env_->define("date_diff_days", KaynatValue(CallableType(stdlib::date_diff_days)));
-    
-    // Random functions (6)
-    global_env_->define("random_int", KaynatValue(CallableType(stdlib::random_int)));
-    global_env_->define("random_float", KaynatValue(CallableType(stdlib::random_float)));
-    global_env_->define("random_choice", KaynatValue(CallableType(stdlib::random_choice)));
-    global_env_->define("random_shuffle", KaynatValue(CallableType(stdlib::random_shuffle)));
-    global_env_->define("random_sample", KaynatValue(CallableType(stdlib::random_sample)));
-    global_env_->define("random_seed", KaynatValue(CallableType(stdlib::random_seed)));
-    
-    // Network functions (2)
-    global_env_->define("http_get", KaynatValue(CallableType(stdlib::network_http_get)));
-    global_env_->define("http_post", KaynatValue(CallableType(stdlib::network_http_post)));
-    
-    // JSON functions (3)
-    global_env_->define("json_parse", KaynatValue(CallableType(stdlib::json_parse)));
-    global_env_->define("json_stringify", KaynatValue(CallableType(stdlib::json_stringify)));
-    global_env_->define("json_format", KaynatValue(CallableType(stdlib::json_format)));
-    
-    // Crypto functions (5)
-    global_env_->define("sha256", KaynatValue(CallableType(stdlib::crypto_sha256)));
-    global_env_->define("md5", KaynatValue(CallableType(stdlib::crypto_md5)));
-    global_env_->define("base64_encode", KaynatValue(CallableType(stdlib::crypto_base64_encode)));
-    global_env_->define("base64_decode", KaynatValue(CallableType(stdlib::crypto_base64_decode)));
-    global_env_->define("random_token", KaynatValue(CallableType(stdlib::crypto_random_token)));
-    
-    // Pattern functions (6)
-    global_env_->define("pattern_match", KaynatValue(CallableType(stdlib::pattern_match)));
-    global_env_->define("pattern_find_all", KaynatValue(CallableType(stdlib::pattern_find_all)));
-    global_env_->define("pattern_replace", KaynatValue(CallableType(stdlib::pattern_replace)));
-    global_env_->define("pattern_split", KaynatValue(CallableType(stdlib::pattern_split)));
-    global_env_->define("is_email", KaynatValue(CallableType(stdlib::pattern_is_email)));
-    global_env_->define("is_url", KaynatValue(CallableType(stdlib::pattern_is_url)));
-}
-
-
-KaynatValue Interpreter::eval_gui(const std::shared_ptr<GUINode>& node) {
-    auto& gui_mgr = GUIManager::instance();
-    
-    switch (node->command) {
-        case GUINode::Command::CREATE_WINDOW: {
-            auto window = std::make_shared<Window>(node->target, 800, 600);
-            gui_mgr.register_window(node->target, window);
-            current_env_->define(node->target, KaynatValue());  // Store reference
-            break;
+KaynatValue Interpreter::call(const InterpretedFunction& function, std::vector<KaynatValue> args) {
+    const FunctionDefNode* func_node = function.node;
+    std::shared_ptr<Scope> closure = function.closure;
+    std::shared_ptr<MemoTable> memo = function.memo;
+    std::vector<KaynatValue> key;  // Arguments the result is stored under
+    auto prev_scope = current_scope_;
+    
+    // The body's children live in the program that defined it
+    std::shared_ptr<Ast> prev_ast = std::exchange(ast_, function.ast);
+    
+    for (;;) {
+        if (args.size() != func_node->parameters.size()) {
+            throw RuntimeError("Function expects " + std::to_string(func_node->parameters.size()) +
+                             " arguments, got " + std::to_string(args.size()), func_node->line, 0);
         }
         
-        case GUINode::Command::SET_TITLE: {
-            auto window = gui_mgr.get_window(node->target);
-            if (window && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto str = val.as_string();
-                if (str) window->title = *str;
+        bool store = false;
+        if (memo) {
+            KaynatValue cached;
+            if (memo->find(args, cached)) {
+                recycle_arguments(std::move(args));
+                ast_ = std::move(prev_ast);
+                return cached;
             }
-            break;
+            store = MemoTable::keyable(args);
+            if (store) key.assign(args.begin(), args.end());
         }
         
-        case GUINode::Command::SET_WIDTH: {
-            auto window = gui_mgr.get_window(node->target);
-            if (window && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto num = val.as_int();
-                if (num) window->width = static_cast<int>(*num);
-            }
-            break;
-        }
+        // Take a recycled flat scope for the function body
+        auto func_scope = scopes_.acquire(func_node->layout.names.size(), std::move(closure));
         
-        case GUINode::Command::SET_HEIGHT: {
-            auto window = gui_mgr.get_window(node->target);
-            if (window && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto num = val.as_int();
-                if (num) window->height = static_cast<int>(*num);
-            }
-            break;
+        // Bind parameters to the leading slots
+        for (size_t i = 0; i < args.size(); ++i) {
+            func_scope->slots[i].value = std::move(args[i]);
+            func_scope->slots[i].defined = true;
         }
+        recycle_arguments(std::move(args));
         
-        case GUINode::Command::SET_BACKGROUND: {
-            auto window = gui_mgr.get_window(node->target);
-            if (window && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto str = val.as_string();
-                if (str) window->background_color = *str;
+        // Execute function body
+        current_scope_ = std::move(func_scope);
+        
+        KaynatValue result;
+        for (NodeRef stmt : ast_->list(func_node->body)) {
+            result = evaluate(stmt);
+            if (return_flag_) {
+                result = return_value_;
+                return_flag_ = false;
+                break;
             }
-            break;
         }
         
-        case GUINode::Command::SHOW_WINDOW: {
-            auto window = gui_mgr.get_window(node->target);
-            if (window) window->show();
-            break;
-        }
+        scopes_.release(std::exchange(current_scope_, prev_scope));
         
-        case GUINode::Command::CREATE_LABEL: {
-            auto label = std::make_shared<Label>("");
-            label->id = node->target;
-            current_env_->define(node->target, KaynatValue());
-            // Store widget for later access
-            gui_mgr.register_widget(node->target, label);
-            break;
+        if (!tail_call_) {
+            if (store) memo->insert(key, result);
+            ast_ = std::move(prev_ast);
+            return result;
         }
         
-        case GUINode::Command::SET_TEXT: {
-            auto widget = gui_mgr.get_widget(node->target);
-            if (widget && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto str = val.as_string();
-                if (str) {
-                    if (auto label = std::dynamic_pointer_cast<Label>(widget)) {
-                        label->text = *str;
-                    } else if (auto button = std::dynamic_pointer_cast<Button>(widget)) {
-                        button->text = *str;
-                    }
-                }
-            }
-            break;
-        }
+        TailCall pending = std::move(*tail_call_);
+        tail_call_.reset();
         
-        case GUINode::Command::CREATE_BUTTON: {
-            auto button = std::make_shared<Button>("");
-            button->id = node->target;
-            current_env_->define(node->target, KaynatValue());
-            gui_mgr.register_widget(node->target, button);
-            break;
+        // Run the next user function in this loop; anything else is called normally
+        const CallableType& callee = *pending.callee.as_callable_ptr();
+        const auto* next = callee.target<InterpretedFunction>();
+        if (next == nullptr || next->interpreter != root_) {
+            ast_ = std::move(prev_ast);
+            return call_value(callee, std::move(pending.args));
         }
         
-        case GUINode::Command::CREATE_INPUT: {
-            auto input = std::make_shared<TextInput>("");
-            input->id = node->target;
-            current_env_->define(node->target, KaynatValue());
-            gui_mgr.register_widget(node->target, input);
-            break;
+        func_node = next->node;
+        closure = next->closure;
+        memo = next->memo;
+        ast_ = next->ast;
+        args = std::move(pending.args);
+    }
+}
+
+const KaynatValue& Interpreter::global_callee(FunctionCallNode& node) {
+    CallSiteCache& cache = node.cache;
+    if (!isolated_ && cache.owner == global_env_.get() && cache.version == global_env_->version()) {
+        return *cache.value;
+    }
+    
+    const KaynatValue* value = global_env_->find_local(node.name);
+    if (value == nullptr) {
+        value = global_env_->find_builtin(node.name);
+    }
+    if (value == nullptr) {
+        throw UndefinedError(node.name.str(), 0, 0);
+    }
+    
+    // Workers leave the shared program unchanged
+    if (parallel_) {
+        return *value;
+    }
+    
+    cache.owner = global_env_.get();
+    cache.version = global_env_->version();
+    cache.value = value;
+    return *value;
+}
+
+const CallableType& Interpreter::callable_of(const KaynatValue& callee, const FunctionCallNode& node) const {
+    const CallableType* callable = callee.as_callable_ptr();
+    if (callable == nullptr) {
+        throw TypeError("Function", callee.type_name(), node.line, 0);
+    }
+    
+    return *callable;
+}
+
+KaynatValue Interpreter::call_value(const CallableType& callee, std::vector<KaynatValue> args) {
+    if (const auto* function = callee.target<InterpretedFunction>(); function && function->interpreter == root_) {
+        return call(*function, std::move(args));
+    }
+    if (const auto* native = callee.target<NativeFunction>()) {
+        KaynatValue result = (*native)(args);
+        recycle_arguments(std::move(args));
+        return result;
+    }
+    return callee(std::move(args));
+}
+
+KaynatValue Interpreter::spawn(const CallableType& callee, std::vector<KaynatValue> args) {
+    // The task reads copies, so the spawning code may go on changing the
+    // globals and the function's captured variables
+    std::shared_ptr<Interpreter> worker(new Interpreter(*this, global_env_->copy(), true));
+    CallableType target = callee;
+    if (const auto* function = callee.target<InterpretedFunction>(); function && function->interpreter == root_) {
+        InterpretedFunction copy = *function;
+        copy.closure = copy_scopes(function->closure);
+        target = std::move(copy);
+    }
+    
+    return KaynatValue(Task::spawn(tasks_, [worker, target, args = std::move(args)]() mutable {
+        return worker->call_value(target, std::move(args));
+    }));
+}
+
+std::vector<KaynatValue> Interpreter::evaluate_arguments(const FunctionCallNode& node) {
+    std::vector<KaynatValue> args;
+    if (!spare_args_.empty()) {
+        args = std::move(spare_args_.back());
+        spare_args_.pop_back();
+    }
+    args.reserve(node.arguments.size());
+    for (NodeRef arg_node : ast_->list(node.arguments)) {
+        args.push_back(evaluate(arg_node));
+    }
+    return args;
+}
+
+void Interpreter::recycle_arguments(std::vector<KaynatValue> args) {
+    if (spare_args_.size() < MAX_SPARE_ARGS) {
+        args.clear();
+        spare_args_.push_back(std::move(args));
+    }
+}
+
+Slot* Interpreter::find_slot(const VariableBinding& binding) const {
+    for (const auto& candidate : binding.candidates) {
+        Scope* scope = current_scope_.get();
+        for (uint32_t i = 0; i < candidate.depth; ++i) {
+            scope = scope->parent.get();
         }
         
-        case GUINode::Command::SET_PLACEHOLDER: {
-            auto widget = gui_mgr.get_widget(node->target);
-            if (widget && !node->arguments.empty()) {
-                KaynatValue val = evaluate(node->arguments[0]);
-                auto str = val.as_string();
-                if (str) {
-                    if (auto input = std::dynamic_pointer_cast<TextInput>(widget)) {
-                        input->placeholder = *str;
-                    }
-                }
-            }
-            break;
+        Slot& slot = scope->slots[candidate.slot];
+        if (slot.defined) {
+            return &slot;
+        }
+    }
+    
+    return nullptr;
+}
+
+Slot& Interpreter::local_slot(const VariableBinding& binding) const {
+    // Names bound in a function always have a slot in its own scope first
+    return current_scope_->slots[binding.candidates.front().slot];
+}
+
+KaynatValue Interpreter::lookup(Symbol name, const VariableBinding& binding) const {
+    if (Slot* slot = find_slot(binding)) {
+        return slot->value;
+    }
+    
+    return global_env_->get(name);
+}
+
+void Interpreter::assign(Symbol name, const VariableBinding& binding,
+                         const KaynatValue& value, bool is_constant) {
+    if (parallel_) {
+        check_parallel_write(name, binding);
+    }
+    
+    if (Slot* slot = find_slot(binding)) {
+        if (slot->constant) {
+            throw RuntimeError("Cannot modify constant '" + name.str() + "'", 0, 0);
+        }
+        slot->value = value;
+        return;
+    }
+    
+    if (global_env_->exists(name)) {
+        global_env_->set(name, value);
+        return;
+    }
+    
+    if (binding.candidates.empty()) {
+        global_env_->define(name, value, is_constant);
+        return;
+    }
+    
+    Slot& slot = local_slot(binding);
+    slot.value = value;
+    slot.defined = true;
+    slot.constant = is_constant;
+}
+
+void Interpreter::define(Symbol name, const VariableBinding& binding, const KaynatValue& value) {
+    if (binding.candidates.empty()) {
+        if (parallel_) {
+            check_parallel_write(name, binding);
+        }
+        global_env_->define(name, value);
+        return;
+    }
+    
+    Slot& slot = local_slot(binding);
+    if (slot.defined) {
+        throw RuntimeError("Variable '" + name.str() + "' already defined in this scope", 0, 0);
+    }
+    slot.value = value;
+    slot.defined = true;
+}
+
+void Interpreter::check_parallel_write(Symbol name, const VariableBinding& binding) const {
+    // Only variables of scopes this worker created may change
+    for (const auto& candidate : binding.candidates) {
+        Scope* scope = current_scope_.get();
+        for (uint32_t i = 0; i < candidate.depth; ++i) {
+            scope = scope->parent.get();
         }
         
-        case GUINode::Command::PLACE_WIDGET: {
-            auto widget = gui_mgr.get_widget(node->target);
-            if (widget && node->arguments.size() >= 3) {
-                // Get row, column, window name
-                auto row_val = evaluate(node->arguments[0]).as_int();
-                auto col_val = evaluate(node->arguments[1]).as_int();
-                auto win_val = evaluate(node->arguments[2]).as_string();
-                
-                if (row_val && col_val && win_val) {
-                    auto window = gui_mgr.get_window(*win_val);
-                    if (window) {
-                        widget->x = static_cast<int>(*col_val);
-                        widget->y = static_cast<int>(*row_val);
-                        window->add_widget(widget);
-                    }
-                }
+        if (scope->slots[candidate.slot].defined) {
+            if (scope->owner == scopes_.id()) {
+                return;
             }
             break;
         }
     }
     
+    // A new name becomes a local of the iteration, unless it is a global
+    if (!binding.candidates.empty() && !find_slot(binding) && !global_env_->exists(name)) {
+        return;
+    }
+    throw RuntimeError("Cannot change '" + name.str() + "' from a parallel loop or task; it was defined outside it",
+                       0, 0);
+}
+
+void Interpreter::register_builtin_functions() {
+    // Built-in functions will be registered here
+}
+
+
+KaynatValue Interpreter::eval_gui(GUINode& node) {
+    if (parallel_) {
+        throw RuntimeError("GUI commands cannot run inside a parallel loop or task", node.line, 0);
+    }
+    
+    std::vector<KaynatValue> args;
+    for (NodeRef arg_node : ast_->list(node.arguments)) {
+        args.push_back(evaluate(arg_node));
+    }
+    
+    run_gui_command(node.command, node.target.str(), args);
+    
+    // Created widgets are bound by name in the current scope
+    if (gui_command_defines_target(node.command)) {
+        define(node.target, node.binding, KaynatValue());
+    }
+    
     return KaynatValue();
 }
+
+KaynatValue Interpreter::eval_wait(WaitNode& node) {
+    KaynatValue value = evaluate(node.task);
+    const std::shared_ptr<Task>* task = value.as_task_ptr();
+    if (task == nullptr) {
+        throw TypeError("Task", value.type_name(), node.line, 0);
+    }
+    
+    return (*task)->wait();
+}
+
 } // namespace kaynat
@@ -9,16 +9,54 @@
 
 #include "runtime_value.hpp"
 #include "environment.hpp"
-#include "../parser/nodes.hpp"
+#include "memo_table.hpp"
+#include "../parser/ast.hpp"
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace kaynat {
 
+class Interpreter;
+class TaskGroup;
+
+/**
+ * @brief Function value created by a function definition
+ * 
+ * Stored inside a CallableType like native functions. The interpreter
+ * recognises its own functions so that a tail call can reuse the
+ * running call instead of nesting a new one. The function keeps the
+ * program that defined it alive, since its body lives in that Ast.
+ */
+struct InterpretedFunction {
+    Interpreter* interpreter;
+    std::shared_ptr<Ast> ast;
+    const FunctionDefNode* node;
+    std::shared_ptr<Scope> closure;
+    std::shared_ptr<MemoTable> memo;  // Result cache of a memoized function
+    
+    /**
+     * @brief Call the function from native code
+     */
+    KaynatValue operator()(std::vector<KaynatValue> args) const;
+};
+
 /**
  * @brief Tree-walking interpreter for Kaynat++
  * 
  * Executes AST by recursively evaluating nodes.
- * Manages global environment and function call stack.
+ * Manages global environment and function call stack. Programs are run
+ * through the Resolver first; function locals then live in flat Scope
+ * slots and only globals are looked up by name.
+ * 
+ * Parallel for-each loops run their iterations on worker interpreters,
+ * one per thread, which share the globals and the functions of the
+ * interpreter that started the loop. A spawned task runs on a worker of
+ * its own, with a copy of the globals and of the variables its function
+ * captured. Workers keep the globals, and the variables of scopes they
+ * did not create, read-only.
+ * 
+ * Thread-safe: No. Each thread runs its own (worker) interpreter.
  */
 class Interpreter {
 public:
@@ -29,48 +67,124 @@ public:
     
     /**
      * @brief Execute a program
-     * @param program Root program node
+     * @param ast Parsed program
      * @return Last expression value or null
      */
-    KaynatValue execute(const std::shared_ptr<ProgramNode>& program);
+    KaynatValue execute(const std::shared_ptr<Ast>& ast);
     
     /**
      * @brief Evaluate an AST node
-     * @param node Node to evaluate
+     * @param node Node of the program being run
      * @return Resulting value
      */
-    KaynatValue evaluate(const ASTNode& node);
+    KaynatValue evaluate(NodeRef node);
+    
+    /**
+     * @brief Call a user-defined function with arguments
+     * 
+     * Calls made by "give back call ..." inside the function run in this
+     * same loop, so tail recursion uses constant native stack. A memoized
+     * function whose body ends in such a call does not store its result;
+     * the function that finally returns a value does.
+     * 
+     * @param function Function to call
+     * @param args Argument values
+     * @return Function result
+     * @throws KaynatError on runtime errors
+     */
+    KaynatValue call(const InterpretedFunction& function, std::vector<KaynatValue> args);
+    
+    /**
+     * @brief Global scope, for hosts defining inputs before a run
+     */
+    Environment& globals() { return *global_env_; }
+    
+    /**
+     * @brief Tasks spawned by this interpreter and its workers
+     */
+    TaskGroup& tasks() { return *tasks_; }
     
 private:
+    /**
+     * @brief Call requested by a return in tail position
+     */
+    struct TailCall {
+        KaynatValue callee;  // Checked to be callable
+        std::vector<KaynatValue> args;
+    };
+    
+
     std::shared_ptr<Environment> global_env_;
-    std::shared_ptr<Environment> current_env_;
+    std::shared_ptr<Ast> ast_;  // Program whose nodes are being evaluated
+    std::shared_ptr<Scope> current_scope_;  // Null at the top level
+    ScopePool scopes_;
+    std::vector<std::vector<KaynatValue>> spare_args_;  // Emptied argument buffers
     bool return_flag_;
     KaynatValue return_value_;
+    std::optional<TailCall> tail_call_;  // Left for call() by eval_return
+    Interpreter* root_;  // Interpreter whose functions this one runs
+    std::shared_ptr<TaskGroup> tasks_;  // Shared with the root and its workers
+    bool parallel_;      // Runs a parallel loop iteration or a task
+    bool isolated_;      // Runs alongside the root, so leaves its caches alone
+    
+    static constexpr size_t MAX_SPARE_ARGS = 64;
+    
+    using Evaluator = KaynatValue (*)(Interpreter&, NodeRef);
+    static const Evaluator EVALUATORS[];
+    
+    /**
+     * @brief Worker for a parallel loop or task started by `creator`
+     */
+    Interpreter(const Interpreter& creator, std::shared_ptr<Environment> globals, bool isolated);
     
     // Node evaluation methods
-    KaynatValue eval_program(const std::shared_ptr<ProgramNode>& node);
-    KaynatValue eval_literal(const std::shared_ptr<LiteralNode>& node);
-    KaynatValue eval_identifier(const std::shared_ptr<IdentifierNode>& node);
-    KaynatValue eval_binary_op(const std::shared_ptr<BinaryOpNode>& node);
-    KaynatValue eval_unary_op(const std::shared_ptr<UnaryOpNode>& node);
-    KaynatValue eval_assignment(const std::shared_ptr<AssignmentNode>& node);
-    KaynatValue eval_if(const std::shared_ptr<IfNode>& node);
-    KaynatValue eval_while(const std::shared_ptr<WhileNode>& node);
-    KaynatValue eval_repeat(const std::shared_ptr<RepeatNode>& node);
-    KaynatValue eval_for_each(const std::shared_ptr<ForEachNode>& node);
-    KaynatValue eval_function_def(const std::shared_ptr<FunctionDefNode>& node);
-    KaynatValue eval_function_call(const std::shared_ptr<FunctionCallNode>& node);
-    KaynatValue eval_return(const std::shared_ptr<ReturnNode>& node);
-    KaynatValue eval_list(const std::shared_ptr<ListNode>& node);
-    KaynatValue eval_dict(const std::shared_ptr<DictNode>& node);
-    KaynatValue eval_index(const std::shared_ptr<IndexNode>& node);
-    KaynatValue eval_property_access(const std::shared_ptr<PropertyAccessNode>& node);
-    KaynatValue eval_block(const std::shared_ptr<BlockNode>& node);
-    KaynatValue eval_gui(const std::shared_ptr<GUINode>& node);
+    KaynatValue eval_program(ProgramNode& node);
+    KaynatValue eval_literal(LiteralNode& node);
+    KaynatValue eval_identifier(IdentifierNode& node);
+    KaynatValue eval_binary_op(BinaryOpNode& node);
+    KaynatValue eval_unary_op(UnaryOpNode& node);
+    KaynatValue eval_assignment(AssignmentNode& node);
+    KaynatValue eval_if(IfNode& node);
+    KaynatValue eval_while(WhileNode& node);
+    KaynatValue eval_repeat(RepeatNode& node);
+    KaynatValue eval_for_each(ForEachNode& node);
+    KaynatValue eval_parallel_for_each(ForEachNode& node);
+    KaynatValue run_iteration(const ForEachNode& node, const std::shared_ptr<Ast>& ast,
+                              const std::shared_ptr<Scope>& closure, const KaynatValue& item);
+    KaynatValue eval_function_def(FunctionDefNode& node);
+    KaynatValue eval_function_call(FunctionCallNode& node);
+    KaynatValue eval_return(ReturnNode& node);
+    KaynatValue eval_list(ListNode& node);
+    KaynatValue eval_dict(DictNode& node);
+    KaynatValue eval_index(IndexNode& node);
+    KaynatValue eval_property_access(PropertyAccessNode& node);
+    KaynatValue eval_block(BlockNode& node);
+    KaynatValue eval_gui(GUINode& node);
+    KaynatValue eval_wait(WaitNode& node);
+    
+    // Type feedback
+    static BinaryOpNode::Feedback observe_operands(const BinaryOpNode& node, const KaynatValue& left,
+                                                   const KaynatValue& right);
+    
+    // Calls
+    const KaynatValue& global_callee(FunctionCallNode& node);
+    const CallableType& callable_of(const KaynatValue& callee, const FunctionCallNode& node) const;
+    KaynatValue call_value(const CallableType& callee, std::vector<KaynatValue> args);
+    KaynatValue spawn(const CallableType& callee, std::vector<KaynatValue> args);
+    std::vector<KaynatValue> evaluate_arguments(const FunctionCallNode& node);
+    void recycle_arguments(std::vector<KaynatValue> args);
+    
+    // Variable access through resolved bindings
+    Slot* find_slot(const VariableBinding& binding) const;
+    Slot& local_slot(const VariableBinding& binding) const;
+    KaynatValue lookup(Symbol name, const VariableBinding& binding) const;
+    void assign(Symbol name, const VariableBinding& binding,
+                const KaynatValue& value, bool is_constant);
+    void define(Symbol name, const VariableBinding& binding, const KaynatValue& value);
+    void check_parallel_write(Symbol name, const VariableBinding& binding) const;
     
     // Helper methods
     void register_builtin_functions();
-    void register_stdlib_functions();
 };
 
 } // namespace kaynat
@@ -0,0 +1,143 @@
+/**
+ * @file memo_table.cpp
+ * @brief MemoTable implementation
+ */
+
+#include "memo_table.hpp"
+#include <cstring>
+#include <functional>
+#include <string>
+
+namespace kaynat {
+
+namespace {
+
+uint64_t float_bits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+size_t hash_value(const KaynatValue& value) {
+    switch (value.type()) {
+        case KaynatValue::Type::INTEGER:
+            return std::hash<int64_t>()(*value.as_int_ptr());
+        case KaynatValue::Type::FLOAT:
+            return std::hash<uint64_t>()(float_bits(*value.as_float_ptr()));
+        case KaynatValue::Type::BOOLEAN:
+            return *value.as_bool() ? 1 : 2;
+        case KaynatValue::Type::CHARACTER:
+            return std::hash<char32_t>()(*value.as_char());
+        case KaynatValue::Type::STRING:
+            return std::hash<std::string>()(*value.as_string_ptr());
+        case KaynatValue::Type::BIGINT:
+            // Equal big integers convert to the same double
+            return std::hash<double>()(value.as_bigint_ptr()->to_double());
+        default:
+            return 0;
+    }
+}
+
+bool same_key(const KaynatValue& a, const KaynatValue& b) {
+    // operator== equates values of different types, such as 1 and 1.0
+    if (a.type() != b.type()) {
+        return false;
+    }
+    if (a.type() == KaynatValue::Type::FLOAT) {
+        return float_bits(*a.as_float_ptr()) == float_bits(*b.as_float_ptr());
+    }
+    return a == b;
+}
+
+} // namespace
+
+MemoTable::MemoTable(size_t arity, std::shared_ptr<MemoStats> stats)
+    : arity_(arity), stats_(std::move(stats)) {}
+
+bool MemoTable::keyable(ArgSpan args) {
+    for (const KaynatValue& arg : args) {
+        switch (arg.type()) {
+            case KaynatValue::Type::LIST:
+            case KaynatValue::Type::DICT:
+            case KaynatValue::Type::INSTANCE:
+            case KaynatValue::Type::CALLABLE:
+            case KaynatValue::Type::TASK:
+                return false;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool MemoTable::find(ArgSpan args, KaynatValue& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!buckets_.empty() && args.size() == arity_ && keyable(args)) {
+        const size_t h = hash(args);
+        const size_t mask = buckets_.size() - 1;
+        for (size_t i = h & mask; buckets_[i] != 0; i = (i + 1) & mask) {
+            const size_t entry = buckets_[i] - 1;
+            if (hashes_[entry] == h && matches(entry, args)) {
+                stats_->hits.fetch_add(1, std::memory_order_relaxed);
+                result = results_[entry];
+                return true;
+            }
+        }
+    }
+
+    stats_->misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void MemoTable::insert(ArgSpan args, const KaynatValue& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (results_.size() >= MAX_ENTRIES) return;
+    if ((results_.size() + 1) * 2 > buckets_.size()) grow();
+
+    const size_t h = hash(args);
+    const size_t mask = buckets_.size() - 1;
+    size_t i = h & mask;
+    for (; buckets_[i] != 0; i = (i + 1) & mask) {
+        // A recursive call may already have stored the same arguments
+        if (hashes_[buckets_[i] - 1] == h && matches(buckets_[i] - 1, args)) return;
+    }
+
+    keys_.insert(keys_.end(), args.begin(), args.end());
+    results_.push_back(result);
+    hashes_.push_back(h);
+    buckets_[i] = static_cast<uint32_t>(results_.size());
+    stats_->stored.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t MemoTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_.size();
+}
+
+size_t MemoTable::hash(ArgSpan args) {
+    size_t h = args.size();
+    for (const KaynatValue& arg : args) {
+        h ^= hash_value(arg) + static_cast<size_t>(arg.type()) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+bool MemoTable::matches(size_t entry, ArgSpan args) const {
+    const KaynatValue* key = keys_.data() + entry * arity_;
+    for (size_t i = 0; i < arity_; ++i) {
+        if (!same_key(key[i], args[i])) return false;
+    }
+    return true;
+}
+
+void MemoTable::grow() {
+    buckets_.assign(buckets_.empty() ? 16 : buckets_.size() * 2, 0);
+    const size_t mask = buckets_.size() - 1;
+    for (size_t entry = 0; entry < hashes_.size(); ++entry) {
+        size_t i = hashes_[entry] & mask;
+        while (buckets_[i] != 0) i = (i + 1) & mask;
+        buckets_[i] = static_cast<uint32_t>(entry + 1);
+    }
+}
+
+} // namespace kaynat
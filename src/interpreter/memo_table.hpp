@@ -0,0 +1,83 @@
+/**
+ * @file memo_table.hpp
+ * @brief Argument-keyed result caches for memoized functions
+ */
+
+#pragma once
+
+#include "runtime_value.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Counters shared by every result cache of one function definition
+ */
+struct MemoStats {
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};  // Calls that ran the body, including uncacheable ones
+    std::atomic<uint64_t> stored{0};
+};
+
+/**
+ * @brief Results of a memoized function, keyed by its arguments
+ *
+ * Each function value owns one table, so functions with different
+ * closures never share results. Only calls whose arguments are all
+ * scalars (null, numbers, booleans, characters and strings) are cached;
+ * keys compare by type and exact value, so 1 and 1.0 or 0.0 and -0.0
+ * are different keys. Once MAX_ENTRIES results are held, new results
+ * are no longer stored.
+ *
+ * Thread-safe: Yes. Iterations of a parallel loop may call the same
+ * function; each lookup or insert holds the table's lock.
+ */
+class MemoTable {
+public:
+    static constexpr size_t MAX_ENTRIES = size_t{1} << 16;
+
+    /**
+     * @param arity Number of arguments of the function
+     * @param stats Counters of the function's definition
+     */
+    MemoTable(size_t arity, std::shared_ptr<MemoStats> stats);
+
+    /**
+     * @brief Whether a call with these arguments can be cached
+     */
+    static bool keyable(ArgSpan args);
+
+    /**
+     * @brief Find the result of an earlier call, counting a hit or miss
+     * @param result Receives the cached result on a hit
+     * @return Whether the call was found
+     */
+    bool find(ArgSpan args, KaynatValue& result);
+
+    /**
+     * @brief Store the result of a call whose arguments are keyable
+     */
+    void insert(ArgSpan args, const KaynatValue& result);
+
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    size_t arity_;
+    std::shared_ptr<MemoStats> stats_;
+    std::vector<KaynatValue> keys_;     // arity_ arguments per entry
+    std::vector<KaynatValue> results_;
+    std::vector<size_t> hashes_;
+    std::vector<uint32_t> buckets_;     // Entry index + 1, or 0 when empty
+
+    static size_t hash(ArgSpan args);
+    bool matches(size_t entry, ArgSpan args) const;
+    void grow();
+};
+
+} // namespace kaynat
@@ -0,0 +1,225 @@
+/**
+ * @file operators.cpp
+ * @brief Operator semantics implementation
+ */
+
+#include "operators.hpp"
+#include "../errors/error_types.hpp"
+
+namespace kaynat {
+namespace ops {
+
+namespace {
+
+bool is_integral(const KaynatValue& value) {
+    return value.type() == KaynatValue::Type::INTEGER || value.type() == KaynatValue::Type::BIGINT;
+}
+
+BigInt to_bigint(const KaynatValue& value) {
+    if (const BigInt* big = value.as_bigint_ptr()) {
+        return *big;
+    }
+    return BigInt(*value.as_int_ptr());
+}
+
+/**
+ * @brief Numeric value as a double; 0 for non-numbers
+ */
+double to_double(const KaynatValue& value) {
+    if (const int64_t* i = value.as_int_ptr()) return static_cast<double>(*i);
+    if (const double* d = value.as_float_ptr()) return *d;
+    if (const BigInt* big = value.as_bigint_ptr()) return big->to_double();
+    return 0.0;
+}
+
+bool is_float(const KaynatValue& value) {
+    return value.type() == KaynatValue::Type::FLOAT;
+}
+
+/**
+ * @brief Order two integers of which at least one is a BigInt
+ */
+int compare_integral(const KaynatValue& left, const KaynatValue& right) {
+    BigInt l = to_bigint(left);
+    BigInt r = to_bigint(right);
+    return l < r ? -1 : (r < l ? 1 : 0);
+}
+
+} // namespace
+
+KaynatValue binary(BinaryOpNode::Op op, const KaynatValue& left,
+                   const KaynatValue& right, uint32_t line) {
+    KaynatValue result;
+    const int64_t* l_num = left.as_int_ptr();
+    const int64_t* r_num = right.as_int_ptr();
+    if (l_num && r_num && int_binary(op, *l_num, *r_num, result)) {
+        return result;
+    }
+
+    // Integer results that overflowed int64_t, or had a BigInt operand,
+    // are computed exactly and demoted again when they fit
+    const bool integral = is_integral(left) && is_integral(right);
+
+    switch (op) {
+        case BinaryOpNode::Op::ADD:
+            if (integral) {
+                return KaynatValue::integer(to_bigint(left) + to_bigint(right));
+            }
+
+            if (is_float(left) || is_float(right)) {
+                return KaynatValue(to_double(left) + to_double(right));
+            }
+
+            // String concatenation
+            return KaynatValue(left.to_string() + right.to_string());
+
+        case BinaryOpNode::Op::SUBTRACT:
+            if (integral) {
+                return KaynatValue::integer(to_bigint(left) - to_bigint(right));
+            }
+
+            if (is_float(left) || is_float(right)) {
+                return KaynatValue(to_double(left) - to_double(right));
+            }
+
+            throw TypeError("Number", left.type_name(), line, 0);
+
+        case BinaryOpNode::Op::MULTIPLY:
+            if (integral) {
+                return KaynatValue::integer(to_bigint(left) * to_bigint(right));
+            }
+
+            if (is_float(left) || is_float(right)) {
+                return KaynatValue(to_double(left) * to_double(right));
+            }
+
+            throw TypeError("Number", left.type_name(), line, 0);
+
+        case BinaryOpNode::Op::DIVIDE:
+            // Always return float for division
+            if (is_integral(left) || is_float(left)) {
+                double r_val = to_double(right);
+                if (r_val == 0.0) {
+                    throw DivisionByZeroError(line, 0);
+                }
+                return KaynatValue(to_double(left) / r_val);
+            }
+
+            throw TypeError("Number", left.type_name(), line, 0);
+
+        case BinaryOpNode::Op::MODULO:
+            if (integral) {
+                BigInt divisor = to_bigint(right);
+                if (divisor.is_zero()) {
+                    throw DivisionByZeroError(line, 0);
+                }
+                return KaynatValue::integer(to_bigint(left) % divisor);
+            }
+
+            throw TypeError("Integer", left.type_name(), line, 0);
+
+        case BinaryOpNode::Op::EQUAL:
+            return KaynatValue(left == right);
+
+        case BinaryOpNode::Op::NOT_EQUAL:
+            return KaynatValue(left != right);
+
+        case BinaryOpNode::Op::LESS_THAN:
+            if (integral && left.type() != right.type()) {
+                return KaynatValue(compare_integral(left, right) < 0);
+            }
+            return KaynatValue(left < right);
+
+        case BinaryOpNode::Op::LESS_EQUAL:
+            if (integral && left.type() != right.type()) {
+                return KaynatValue(compare_integral(left, right) <= 0);
+            }
+            return KaynatValue(left <= right);
+
+        case BinaryOpNode::Op::GREATER_THAN:
+            if (integral && left.type() != right.type()) {
+                return KaynatValue(compare_integral(left, right) > 0);
+            }
+            return KaynatValue(left > right);
+
+        case BinaryOpNode::Op::GREATER_EQUAL:
+            if (integral && left.type() != right.type()) {
+                return KaynatValue(compare_integral(left, right) >= 0);
+            }
+            return KaynatValue(left >= right);
+
+        case BinaryOpNode::Op::AND:
+            return KaynatValue(left.is_truthy() && right.is_truthy());
+
+        case BinaryOpNode::Op::OR:
+            return KaynatValue(left.is_truthy() || right.is_truthy());
+    }
+
+    return KaynatValue();
+}
+
+KaynatValue unary(UnaryOpNode::Op op, const KaynatValue& operand, uint32_t line) {
+    switch (op) {
+        case UnaryOpNode::Op::NEGATE: {
+            if (const int64_t* int_val = operand.as_int_ptr()) {
+                if (*int_val == INT64_MIN) {
+                    return KaynatValue(-BigInt(*int_val));
+                }
+                return KaynatValue(-*int_val);
+            }
+
+            if (const BigInt* big = operand.as_bigint_ptr()) {
+                return KaynatValue::integer(-*big);
+            }
+
+            auto float_val = operand.as_float();
+            if (float_val) {
+                return KaynatValue(-*float_val);
+            }
+
+            throw TypeError("Number", operand.type_name(), line, 0);
+        }
+
+        case UnaryOpNode::Op::NOT:
+            return KaynatValue(!operand.is_truthy());
+    }
+
+    return KaynatValue();
+}
+
+KaynatValue index(const KaynatValue& object, const KaynatValue& index, uint32_t line) {
+    const ListType* list = object.as_list_ptr();
+    if (list) {
+        auto idx = index.as_int();
+        if (!idx) {
+            throw TypeError("Integer", index.type_name(), line, 0);
+        }
+        
+        if (*idx < 0 || static_cast<size_t>(*idx) >= list->size()) {
+            throw IndexError(*idx, list->size(), line, 0);
+        }
+        
+        return (*list)[*idx];
+    }
+    
+    const DictType* dict = object.as_dict_ptr();
+    if (dict) {
+        const std::string* key = index.as_string_ptr();
+        if (!key) {
+            throw TypeError("String", index.type_name(), line, 0);
+        }
+        
+        auto symbol = Symbol::find(*key);
+        auto it = symbol ? dict->find(*symbol) : dict->end();
+        if (it == dict->end()) {
+            return KaynatValue();
+        }
+        
+        return it->second;
+    }
+    
+    throw TypeError("List or Dictionary", object.type_name(), line, 0);
+}
+
+} // namespace ops
+} // namespace kaynat
@@ -0,0 +1,123 @@
+/**
+ * @file operators.hpp
+ * @brief Shared operator semantics for Kaynat++ execution engines
+ *
+ * Both the tree-walking interpreter and the bytecode VM evaluate
+ * operators through these functions so that their results match.
+ */
+
+#pragma once
+
+#include "runtime_value.hpp"
+#include "../parser/nodes.hpp"
+#include <cstdint>
+
+namespace kaynat {
+namespace ops {
+
+/**
+ * @brief Apply a binary operator to two integers
+ * @param[out] result Set when the function returns true
+ * @return false for AND/OR, for results that overflow int64_t and must
+ *         be promoted to BigInt by binary(), and for operations that
+ *         must go through binary() to report an error, such as division
+ *         by zero
+ */
+inline bool int_binary(BinaryOpNode::Op op, int64_t left, int64_t right, KaynatValue& result) {
+    int64_t value;
+    switch (op) {
+        case BinaryOpNode::Op::ADD:
+            if (__builtin_add_overflow(left, right, &value)) return false;
+            result = KaynatValue(value);
+            return true;
+        case BinaryOpNode::Op::SUBTRACT:
+            if (__builtin_sub_overflow(left, right, &value)) return false;
+            result = KaynatValue(value);
+            return true;
+        case BinaryOpNode::Op::MULTIPLY:
+            if (__builtin_mul_overflow(left, right, &value)) return false;
+            result = KaynatValue(value);
+            return true;
+        case BinaryOpNode::Op::DIVIDE:
+            if (right == 0) return false;
+            result = KaynatValue(static_cast<double>(left) / static_cast<double>(right));
+            return true;
+        case BinaryOpNode::Op::MODULO:
+            if (right == 0) return false;
+            // INT64_MIN % -1 traps on x86
+            result = KaynatValue(right == -1 ? int64_t{0} : left % right);
+            return true;
+        case BinaryOpNode::Op::EQUAL: result = KaynatValue(left == right); return true;
+        case BinaryOpNode::Op::NOT_EQUAL: result = KaynatValue(left != right); return true;
+        case BinaryOpNode::Op::LESS_THAN: result = KaynatValue(left < right); return true;
+        case BinaryOpNode::Op::LESS_EQUAL: result = KaynatValue(left <= right); return true;
+        case BinaryOpNode::Op::GREATER_THAN: result = KaynatValue(left > right); return true;
+        case BinaryOpNode::Op::GREATER_EQUAL: result = KaynatValue(left >= right); return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Apply a binary operator to two floats
+ * 
+ * Comparisons are phrased like KaynatValue's operators so that NaN
+ * compares the same way on every path.
+ * 
+ * @param[out] result Set when the function returns true
+ * @return false for AND/OR, MODULO and division by zero
+ */
+inline bool float_binary(BinaryOpNode::Op op, double left, double right, KaynatValue& result) {
+    switch (op) {
+        case BinaryOpNode::Op::ADD: result = KaynatValue(left + right); return true;
+        case BinaryOpNode::Op::SUBTRACT: result = KaynatValue(left - right); return true;
+        case BinaryOpNode::Op::MULTIPLY: result = KaynatValue(left * right); return true;
+        case BinaryOpNode::Op::DIVIDE:
+            if (right == 0.0) return false;
+            result = KaynatValue(left / right);
+            return true;
+        case BinaryOpNode::Op::EQUAL: result = KaynatValue(left == right); return true;
+        case BinaryOpNode::Op::NOT_EQUAL: result = KaynatValue(!(left == right)); return true;
+        case BinaryOpNode::Op::LESS_THAN: result = KaynatValue(left < right); return true;
+        case BinaryOpNode::Op::LESS_EQUAL: result = KaynatValue(left < right || left == right); return true;
+        case BinaryOpNode::Op::GREATER_THAN: result = KaynatValue(!(left < right || left == right)); return true;
+        case BinaryOpNode::Op::GREATER_EQUAL: result = KaynatValue(!(left < right)); return true;
+        default: return false;
+    }
+}
+
+/**
+ * @brief Apply a binary operator to two evaluated operands
+ * @param op Operator to apply
+ * @param left Left operand
+ * @param right Right operand
+ * @param line Source line used for error reporting
+ * @return Result value
+ * @throws TypeError if the operands are not valid for the operator
+ * @throws DivisionByZeroError on division or modulo by zero
+ */
+KaynatValue binary(BinaryOpNode::Op op, const KaynatValue& left,
+                   const KaynatValue& right, uint32_t line);
+
+/**
+ * @brief Apply a unary operator to an evaluated operand
+ * @param op Operator to apply
+ * @param operand Operand value
+ * @param line Source line used for error reporting
+ * @return Result value
+ * @throws TypeError if the operand is not valid for the operator
+ */
+KaynatValue unary(UnaryOpNode::Op op, const KaynatValue& operand, uint32_t line);
+
+/**
+ * @brief Index into a list or dictionary
+ * @param object List or dictionary value
+ * @param index Integer position or string key
+ * @param line Source line used for error reporting
+ * @return Element value, or null for a missing dictionary key
+ * @throws TypeError if the object or index has the wrong type
+ * @throws IndexError if a list position is out of range
+ */
+KaynatValue index(const KaynatValue& object, const KaynatValue& index, uint32_t line);
+
+} // namespace ops
+} // namespace kaynat
@@ -0,0 +1,59 @@
+/**
+ * @file parallel.cpp
+ * @brief Parallel iteration and serialized output
+ */
+
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <mutex>
+
+namespace kaynat {
+
+ListType parallel_map(size_t count, const std::function<IterationRunner()>& make_runner) {
+    ListType results(count);
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed_at{count};  // Lowest failing index so far
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto work = [&]() {
+        // Claim the first index before making a context, so that helpers
+        // started after the loop has run out make none
+        size_t index = next.fetch_add(1);
+        if (index >= count) return;
+
+        IterationRunner run = make_runner();
+        for (; index < count && index < failed_at.load(); index = next.fetch_add(1)) {
+            try {
+                results[index] = run(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (index < failed_at.load()) {
+                    failed_at.store(index);
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    ThreadPool& pool = ThreadPool::shared();
+    pool.run_together(count > 1 ? count - 1 : 0, work);
+
+    // Indices are claimed in order, so every iteration before the lowest
+    // failure has run by now
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+void say_line(const std::string& line) {
+    static std::mutex output_mutex;
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::cout << line << '\n';
+}
+
+} // namespace kaynat
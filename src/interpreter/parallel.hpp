@@ -0,0 +1,45 @@
+/**
+ * @file parallel.hpp
+ * @brief Support shared by the engines for running iterations in parallel
+ */
+
+#pragma once
+
+#include "runtime_value.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace kaynat {
+
+/**
+ * @brief Runs iterations of one parallel loop on the calling thread
+ *
+ * Made once per thread taking part in the loop, so that it can keep an
+ * execution context of its own across the iterations it runs.
+ */
+using IterationRunner = std::function<KaynatValue(size_t index)>;
+
+/**
+ * @brief Run `count` iterations on the shared thread pool
+ *
+ * Iterations are handed out one at a time, in index order, to the
+ * calling thread and to pool workers; each thread first calls
+ * make_runner to get its own IterationRunner. When iterations fail, no
+ * further ones are started, and after the running ones have finished
+ * the error of the failing iteration with the lowest index is rethrown,
+ * so the reported error does not depend on scheduling.
+ *
+ * @return Result of each iteration, in index order
+ */
+ListType parallel_map(size_t count, const std::function<IterationRunner()>& make_runner);
+
+/**
+ * @brief Write one line of "say" output
+ *
+ * Lines are written whole, so output of parallel iterations may come in
+ * any order but is never interleaved within a line.
+ */
+void say_line(const std::string& line);
+
+} // namespace kaynat
@@ -9,378 +9,253 @@
 
 namespace kaynat {
 
-// BigInt implementation
-BigInt::BigInt() : negative_(false) {
-    digits_.push_back(0);
-}
-
-BigInt::BigInt(int64_t value) : negative_(value < 0) {
-    if (value == 0) {
-        digits_.push_back(0);
-        return;
+// KaynatValue implementation
+KaynatValue::KaynatValue(const std::string& value) { box<std::string>(Type::STRING, value); }
+KaynatValue::KaynatValue(std::string&& value) { box<std::string>(Type::STRING, std::move(value)); }
+KaynatValue::KaynatValue(const char* value) { box<std::string>(Type::STRING, value); }
+KaynatValue::KaynatValue(const BigInt& value) { box<BigInt>(Type::BIGINT, value); }
+KaynatValue::KaynatValue(const ListType& value) { box<ListType>(Type::LIST, value); }
+KaynatValue::KaynatValue(ListType&& value) { box<ListType>(Type::LIST, std::move(value)); }
+KaynatValue::KaynatValue(const DictType& value) { box<DictType>(Type::DICT, value); }
+KaynatValue::KaynatValue(DictType&& value) { box<DictType>(Type::DICT, std::move(value)); }
+KaynatValue::KaynatValue(std::shared_ptr<KaynatInstance> value) {
+    box<std::shared_ptr<KaynatInstance>>(Type::INSTANCE, std::move(value));
+}
+KaynatValue::KaynatValue(CallableType value) { box<CallableType>(Type::CALLABLE, std::move(value)); }
+KaynatValue::KaynatValue(std::shared_ptr<Task> value) { box<std::shared_ptr<Task>>(Type::TASK, std::move(value)); }
+
+KaynatValue KaynatValue::integer(const BigInt& value) {
+    if (auto small = value.to_int64()) {
+        return KaynatValue(*small);
     }
-    
-    uint64_t abs_value = negative_ ? -value : value;
-    while (abs_value > 0) {
-        digits_.push_back(abs_value % BASE);
-        abs_value /= BASE;
+    return KaynatValue(value);
+}
+
+void KaynatValue::destroy() {
+    CowHeader* header = payload_.box_;
+    switch (type_) {
+        case Type::STRING: delete static_cast<CowBox<std::string>*>(header); break;
+        case Type::BIGINT: delete static_cast<CowBox<BigInt>*>(header); break;
+        case Type::LIST: delete static_cast<CowBox<ListType>*>(header); break;
+        case Type::DICT: delete static_cast<CowBox<DictType>*>(header); break;
+        case Type::INSTANCE: delete static_cast<CowBox<std::shared_ptr<KaynatInstance>>*>(header); break;
+        case Type::CALLABLE: delete static_cast<CowBox<CallableType>*>(header); break;
+        case Type::TASK: delete static_cast<CowBox<std::shared_ptr<Task>>*>(header); break;
+        default: break;
     }
 }
 
-BigInt::BigInt(const std::string& str) : negative_(false) {
-    if (str.empty() || str == "0") {
-        digits_.push_back(0);
-        return;
-    }
-    
-    size_t start = 0;
-    if (str[0] == '-') {
-        negative_ = true;
-        start = 1;
-    }
-    
-    // Parse in chunks of 9 digits
-    for (size_t i = str.length(); i > start; i -= 9) {
-        size_t chunk_start = (i >= start + 9) ? (i - 9) : start;
-        std::string chunk = str.substr(chunk_start, i - chunk_start);
-        digits_.push_back(std::stoi(chunk));
+std::string KaynatValue::type_name() const {
+    switch (type_) {
+        case Type::NULL_VALUE: return "Null";
+        case Type::INTEGER: return "Integer";
+        case Type::FLOAT: return "Float";
+        case Type::BOOLEAN: return "Boolean";
+        case Type::CHARACTER: return "Character";
+        case Type::STRING: return "String";
+        case Type::BIGINT: return "BigInteger";
+        case Type::LIST: return "List";
+        case Type::DICT: return "Dictionary";
+        case Type::INSTANCE: return "Instance";
+        case Type::CALLABLE: return "Function";
+        case Type::TASK: return "Task";
     }
     
-    normalize();
+    return "Unknown";
 }
 
-void BigInt::normalize() {
-    while (digits_.size() > 1 && digits_.back() == 0) {
-        digits_.pop_back();
-    }
-    
-    if (digits_.size() == 1 && digits_[0] == 0) {
-        negative_ = false;
+bool KaynatValue::is_truthy() const {
+    switch (type_) {
+        case Type::NULL_VALUE: return false;
+        case Type::BOOLEAN: return payload_.bool_;
+        case Type::INTEGER: return payload_.int_ != 0;
+        case Type::FLOAT: return payload_.float_ != 0.0;
+        case Type::STRING: return !unbox<std::string>().empty();
+        case Type::LIST: return !unbox<ListType>().empty();
+        case Type::DICT: return !unbox<DictType>().empty();
+        default: return true;
     }
 }
 
-BigInt BigInt::operator+(const BigInt& other) const {
-    BigInt result;
-    result.digits_.clear();
-    
-    int carry = 0;
-    size_t max_size = std::max(digits_.size(), other.digits_.size());
-    
-    for (size_t i = 0; i < max_size || carry; ++i) {
-        int sum = carry;
-        if (i < digits_.size()) sum += digits_[i];
-        if (i < other.digits_.size()) sum += other.digits_[i];
+std::string KaynatValue::to_string() const {
+    switch (type_) {
+        case Type::NULL_VALUE:
+            return "nothing";
         
-        result.digits_.push_back(sum % BASE);
-        carry = sum / BASE;
-    }
-    
-    result.normalize();
-    return result;
-}
-
-BigInt BigInt::operator-(const BigInt& other) const {
-    // Simplified implementation
-    (void)other;  // Suppress unused warning
-    BigInt result;
-    result.digits_ = digits_;
-    result.normalize();
-    return result;
-}
-
-BigInt BigInt::operator*(const BigInt& other) const {
-    BigInt result;
-    result.digits_.assign(digits_.size() + other.digits_.size(), 0);
-    
-    for (size_t i = 0; i < digits_.size(); ++i) {
-        int64_t carry = 0;
-        for (size_t j = 0; j < other.digits_.size() || carry; ++j) {
-            if (i + j >= result.digits_.size()) {
-                result.digits_.push_back(0);
-            }
-            int64_t cur = result.digits_[i + j] + 
-                         digits_[i] * 1LL * (j < other.digits_.size() ? other.digits_[j] : 0) + carry;
-            result.digits_[i + j] = cur % BASE;
-            carry = cur / BASE;
-        }
-    }
-    
-    result.negative_ = negative_ != other.negative_;
-    result.normalize();
-    return result;
-}
-
-BigInt BigInt::operator/(const BigInt& other) const {
-    // Simplified implementation
-    (void)other;  // Suppress unused warning
-    BigInt result;
-    result.digits_ = {0};
-    return result;
-}
-
-BigInt BigInt::operator%(const BigInt& other) const {
-    // Simplified implementation
-    (void)other;  // Suppress unused warning
-    BigInt result;
-    result.digits_ = {0};
-    return result;
-}
-
-bool BigInt::operator==(const BigInt& other) const {
-    return negative_ == other.negative_ && digits_ == other.digits_;
-}
-
-bool BigInt::operator!=(const BigInt& other) const {
-    return !(*this == other);
-}
-
-bool BigInt::operator<(const BigInt& other) const {
-    if (negative_ != other.negative_) {
-        return negative_;
-    }
-    
-    if (digits_.size() != other.digits_.size()) {
-        return negative_ ? digits_.size() > other.digits_.size() : digits_.size() < other.digits_.size();
-    }
-    
-    for (int i = digits_.size() - 1; i >= 0; --i) {
-        if (digits_[i] != other.digits_[i]) {
-            return negative_ ? digits_[i] > other.digits_[i] : digits_[i] < other.digits_[i];
+        case Type::INTEGER:
+            return std::to_string(payload_.int_);
+        
+        case Type::FLOAT: {
+            std::ostringstream oss;
+            oss << payload_.float_;
+            return oss.str();
         }
-    }
-    
-    return false;
-}
-
-bool BigInt::operator<=(const BigInt& other) const {
-    return *this < other || *this == other;
-}
-
-bool BigInt::operator>(const BigInt& other) const {
-    return !(*this <= other);
-}
-
-bool BigInt::operator>=(const BigInt& other) const {
-    return !(*this < other);
-}
-
-std::string BigInt::to_string() const {
-    if (digits_.empty() || (digits_.size() == 1 && digits_[0] == 0)) {
-        return "0";
-    }
-    
-    std::ostringstream oss;
-    if (negative_) oss << '-';
-    
-    oss << digits_.back();
-    for (int i = digits_.size() - 2; i >= 0; --i) {
-        oss << std::setw(9) << std::setfill('0') << digits_[i];
-    }
-    
-    return oss.str();
-}
-
-// KaynatValue implementation
-KaynatValue::KaynatValue() : value_(NullType{}) {}
-KaynatValue::KaynatValue(NullType) : value_(NullType{}) {}
-KaynatValue::KaynatValue(int64_t value) : value_(value) {}
-KaynatValue::KaynatValue(double value) : value_(value) {}
-KaynatValue::KaynatValue(bool value) : value_(value) {}
-KaynatValue::KaynatValue(char32_t value) : value_(value) {}
-KaynatValue::KaynatValue(const std::string& value) : value_(value) {}
-KaynatValue::KaynatValue(const char* value) : value_(std::string(value)) {}
-KaynatValue::KaynatValue(const BigInt& value) : value_(value) {}
-KaynatValue::KaynatValue(const ListType& value) : value_(value) {}
-KaynatValue::KaynatValue(const DictType& value) : value_(value) {}
-KaynatValue::KaynatValue(std::shared_ptr<KaynatInstance> value) : value_(value) {}
-KaynatValue::KaynatValue(CallableType value) : value_(value) {}
-
-std::string KaynatValue::type_name() const {
-    return std::visit([](auto&& arg) -> std::string {
-        using T = std::decay_t<decltype(arg)>;
         
-        if constexpr (std::is_same_v<T, NullType>) return "Null";
-        else if constexpr (std::is_same_v<T, int64_t>) return "Integer";
-        else if constexpr (std::is_same_v<T, double>) return "Float";
-        else if constexpr (std::is_same_v<T, bool>) return "Boolean";
-        else if constexpr (std::is_same_v<T, char32_t>) return "Character";
-        else if constexpr (std::is_same_v<T, std::string>) return "String";
-        else if constexpr (std::is_same_v<T, BigInt>) return "BigInteger";
-        else if constexpr (std::is_same_v<T, ListType>) return "List";
-        else if constexpr (std::is_same_v<T, DictType>) return "Dictionary";
-        else if constexpr (std::is_same_v<T, std::shared_ptr<KaynatInstance>>) return "Instance";
-        else if constexpr (std::is_same_v<T, CallableType>) return "Function";
+        case Type::BOOLEAN:
+            return payload_.bool_ ? "true" : "false";
         
-        return "Unknown";
-    }, value_);
-}
-
-bool KaynatValue::is_null() const {
-    return std::holds_alternative<NullType>(value_);
-}
-
-bool KaynatValue::is_truthy() const {
-    return std::visit([](auto&& arg) -> bool {
-        using T = std::decay_t<decltype(arg)>;
+        case Type::CHARACTER:
+            // Convert UTF-32 to UTF-8 (simplified)
+            return std::string(1, static_cast<char>(payload_.char_));
         
-        if constexpr (std::is_same_v<T, NullType>) return false;
-        else if constexpr (std::is_same_v<T, bool>) return arg;
-        else if constexpr (std::is_same_v<T, int64_t>) return arg != 0;
-        else if constexpr (std::is_same_v<T, double>) return arg != 0.0;
-        else if constexpr (std::is_same_v<T, std::string>) return !arg.empty();
-        else if constexpr (std::is_same_v<T, ListType>) return !arg.empty();
-        else if constexpr (std::is_same_v<T, DictType>) return !arg.empty();
+        case Type::STRING:
+            return unbox<std::string>();
         
-        return true;
-    }, value_);
-}
-
-std::string KaynatValue::to_string() const {
-    return std::visit([](auto&& arg) -> std::string {
-        using T = std::decay_t<decltype(arg)>;
+        case Type::BIGINT:
+            return unbox<BigInt>().to_string();
         
-        if constexpr (std::is_same_v<T, NullType>) {
-            return "nothing";
-        }
-        else if constexpr (std::is_same_v<T, int64_t>) {
-            return std::to_string(arg);
-        }
-        else if constexpr (std::is_same_v<T, double>) {
-            std::ostringstream oss;
-            oss << arg;
-            return oss.str();
-        }
-        else if constexpr (std::is_same_v<T, bool>) {
-            return arg ? "true" : "false";
-        }
-        else if constexpr (std::is_same_v<T, char32_t>) {
-            // Convert UTF-32 to UTF-8 (simplified)
-            return std::string(1, static_cast<char>(arg));
-        }
-        else if constexpr (std::is_same_v<T, std::string>) {
-            return arg;
-        }
-        else if constexpr (std::is_same_v<T, BigInt>) {
-            return arg.to_string();
-        }
-        else if constexpr (std::is_same_v<T, ListType>) {
+        case Type::LIST: {
+            const ListType& list = unbox<ListType>();
             std::ostringstream oss;
             oss << "[";
-            for (size_t i = 0; i < arg.size(); ++i) {
+            for (size_t i = 0; i < list.size(); ++i) {
                 if (i > 0) oss << ", ";
-                oss << arg[i].to_string();
+                oss << list[i].to_string();
             }
             oss << "]";
             return oss.str();
         }
-        else if constexpr (std::is_same_v<T, DictType>) {
+        
+        case Type::DICT: {
             std::ostringstream oss;
             oss << "{";
             size_t i = 0;
-            for (const auto& [key, value] : arg) {
+            for (const auto& [key, value] : unbox<DictType>()) {
                 if (i++ > 0) oss << ", ";
-                oss << key << ": " << value.to_string();
+                oss << key.str() << ": " << value.to_string();
             }
             oss << "}";
             return oss.str();
         }
-        else if constexpr (std::is_same_v<T, std::shared_ptr<KaynatInstance>>) {
+        
+        case Type::INSTANCE:
             return "<instance>";
-        }
-        else if constexpr (std::is_same_v<T, CallableType>) {
+        
+        case Type::CALLABLE:
             return "<function>";
-        }
         
-        return "<unknown>";
-    }, value_);
+        case Type::TASK:
+            return "<task>";
+    }
+    
+    return "<unknown>";
 }
 
 std::optional<int64_t> KaynatValue::as_int() const {
-    if (auto* val = std::get_if<int64_t>(&value_)) {
-        return *val;
+    if (type_ == Type::INTEGER) {
+        return payload_.int_;
     }
     return std::nullopt;
 }
 
 std::optional<double> KaynatValue::as_float() const {
-    if (auto* val = std::get_if<double>(&value_)) {
-        return *val;
+    if (type_ == Type::FLOAT) {
+        return payload_.float_;
     }
     return std::nullopt;
 }
 
 std::optional<bool> KaynatValue::as_bool() const {
-    if (auto* val = std::get_if<bool>(&value_)) {
-        return *val;
+    if (type_ == Type::BOOLEAN) {
+        return payload_.bool_;
     }
     return std::nullopt;
 }
 
 std::optional<char32_t> KaynatValue::as_char() const {
-    if (auto* val = std::get_if<char32_t>(&value_)) {
-        return *val;
+    if (type_ == Type::CHARACTER) {
+        return payload_.char_;
     }
     return std::nullopt;
 }
 
 std::optional<std::string> KaynatValue::as_string() const {
-    if (auto* val = std::get_if<std::string>(&value_)) {
+    if (auto* val = as_string_ptr()) {
         return *val;
     }
     return std::nullopt;
 }
 
 std::optional<BigInt> KaynatValue::as_bigint() const {
-    if (auto* val = std::get_if<BigInt>(&value_)) {
+    if (auto* val = as_bigint_ptr()) {
         return *val;
     }
     return std::nullopt;
 }
 
 std::optional<ListType> KaynatValue::as_list() const {
-    if (auto* val = std::get_if<ListType>(&value_)) {
+    if (auto* val = as_list_ptr()) {
         return *val;
     }
     return std::nullopt;
 }
 
 std::optional<DictType> KaynatValue::as_dict() const {
-    if (auto* val = std::get_if<DictType>(&value_)) {
+    if (auto* val = as_dict_ptr()) {
         return *val;
     }
     return std::nullopt;
 }
 
+const std::string* KaynatValue::as_string_ptr() const {
+    return type_ == Type::STRING ? &unbox<std::string>() : nullptr;
+}
+
+const BigInt* KaynatValue::as_bigint_ptr() const {
+    return type_ == Type::BIGINT ? &unbox<BigInt>() : nullptr;
+}
+
+const ListType* KaynatValue::as_list_ptr() const {
+    return type_ == Type::LIST ? &unbox<ListType>() : nullptr;
+}
+
+const DictType* KaynatValue::as_dict_ptr() const {
+    return type_ == Type::DICT ? &unbox<DictType>() : nullptr;
+}
+
+const CallableType* KaynatValue::as_callable_ptr() const {
+    return type_ == Type::CALLABLE ? &unbox<CallableType>() : nullptr;
+}
+
+const std::shared_ptr<Task>* KaynatValue::as_task_ptr() const {
+    return type_ == Type::TASK ? &unbox<std::shared_ptr<Task>>() : nullptr;
+}
+
 std::optional<std::shared_ptr<KaynatInstance>> KaynatValue::as_instance() const {
-    if (auto* val = std::get_if<std::shared_ptr<KaynatInstance>>(&value_)) {
-        return *val;
+    if (type_ == Type::INSTANCE) {
+        return unbox<std::shared_ptr<KaynatInstance>>();
     }
     return std::nullopt;
 }
 
 std::optional<CallableType> KaynatValue::as_callable() const {
-    if (auto* val = std::get_if<CallableType>(&value_)) {
+    if (auto* val = as_callable_ptr()) {
         return *val;
     }
     return std::nullopt;
 }
 
 bool KaynatValue::operator==(const KaynatValue& other) const {
-    if (value_.index() != other.value_.index()) {
+    if (type_ != other.type_) {
         return false;
     }
     
-    return std::visit([&other](auto&& arg) -> bool {
-        using T = std::decay_t<decltype(arg)>;
-        
-        if constexpr (std::is_same_v<T, std::shared_ptr<KaynatInstance>> ||
-                      std::is_same_v<T, CallableType>) {
-            return false; // Can't compare instances or functions
-        } else {
-            auto* other_val = std::get_if<T>(&other.value_);
-            return other_val && arg == *other_val;
-        }
-    }, value_);
+    if (is_boxed() && payload_.box_ == other.payload_.box_) {
+        return type_ != Type::INSTANCE && type_ != Type::CALLABLE && type_ != Type::TASK;
+    }
+    
+    switch (type_) {
+        case Type::NULL_VALUE: return true;
+        case Type::INTEGER: return payload_.int_ == other.payload_.int_;
+        case Type::FLOAT: return payload_.float_ == other.payload_.float_;
+        case Type::BOOLEAN: return payload_.bool_ == other.payload_.bool_;
+        case Type::CHARACTER: return payload_.char_ == other.payload_.char_;
+        case Type::STRING: return unbox<std::string>() == other.unbox<std::string>();
+        case Type::BIGINT: return unbox<BigInt>() == other.unbox<BigInt>();
+        case Type::LIST: return unbox<ListType>() == other.unbox<ListType>();
+        case Type::DICT: return unbox<DictType>() == other.unbox<DictType>();
+        default: return false; // Can't compare instances, functions or tasks
+    }
 }
 
 bool KaynatValue::operator!=(const KaynatValue& other) const {
@@ -388,21 +263,17 @@ bool KaynatValue::operator!=(const KaynatValue& other) const {
 }
 
 bool KaynatValue::operator<(const KaynatValue& other) const {
-    if (value_.index() != other.value_.index()) {
+    if (type_ != other.type_) {
         return false;
     }
     
-    return std::visit([&other](auto&& arg) -> bool {
-        using T = std::decay_t<decltype(arg)>;
-        
-        if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, double> ||
-                      std::is_same_v<T, std::string> || std::is_same_v<T, BigInt>) {
-            auto* other_val = std::get_if<T>(&other.value_);
-            return other_val && arg < *other_val;
-        }
-        
-        return false;
-    }, value_);
+    switch (type_) {
+        case Type::INTEGER: return payload_.int_ < other.payload_.int_;
+        case Type::FLOAT: return payload_.float_ < other.payload_.float_;
+        case Type::STRING: return unbox<std::string>() < other.unbox<std::string>();
+        case Type::BIGINT: return unbox<BigInt>() < other.unbox<BigInt>();
+        default: return false;
+    }
 }
 
 bool KaynatValue::operator<=(const KaynatValue& other) const {
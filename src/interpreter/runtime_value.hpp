@@ -2,20 +2,24 @@
  * @file runtime_value.hpp
  * @brief Core runtime value type for Kaynat++ interpreter
  * 
- * Defines KaynatValue as a std::variant holding all possible runtime types.
+ * Defines KaynatValue as a compact tagged value holding all runtime types.
  * Supports integers, floats, booleans, strings, lists, dictionaries, and more.
  */
 
 #pragma once
 
+#include "cow.hpp"
+#include "small_vector.hpp"
+#include "symbol.hpp"
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <memory>
 #include <functional>
-#include <variant>
 #include <optional>
+#include <utility>
 
 namespace kaynat {
 
@@ -23,6 +27,7 @@ namespace kaynat {
 class KaynatValue;
 class BigInt;
 class KaynatInstance;
+class Task;
 
 /**
  * @brief Null type representation
@@ -43,28 +48,57 @@ using CallableType = std::function<KaynatValue(std::vector<KaynatValue>)>;
 using ListType = std::vector<KaynatValue>;
 
 /**
- * @brief Dictionary type - string keys to values
+ * @brief Dictionary type - interned string keys to values
  */
-using DictType = std::unordered_map<std::string, KaynatValue>;
+using DictType = std::unordered_map<Symbol, KaynatValue>;
 
 /**
  * @brief Big integer implementation using base 10^9 representation
  * 
  * Stores large integers as vector of 9-digit chunks for efficient arithmetic.
+ * Values of up to four chunks (36 digits) are kept inline without any
+ * heap allocation.
  * Thread-safe for read operations, not thread-safe for modifications.
  */
 class BigInt {
 public:
+    /**
+     * @brief Little-endian base 10^9 chunks of the magnitude
+     */
+    using Limbs = SmallVector<int32_t, 4>;
+    
     BigInt();
     explicit BigInt(int64_t value);
-    explicit BigInt(const std::string& str);
+    
+    /**
+     * @brief Parse an optional '-' followed by digits in the given radix
+     * @param radix 2, 8, 10 or 16; hex digits may be either case
+     * @throws std::invalid_argument on an unsupported radix or bad digit
+     */
+    explicit BigInt(const std::string& str, unsigned radix = 10);
     
     BigInt operator+(const BigInt& other) const;
     BigInt operator-(const BigInt& other) const;
+    BigInt operator-() const;
     BigInt operator*(const BigInt& other) const;
     BigInt operator/(const BigInt& other) const;
     BigInt operator%(const BigInt& other) const;
     
+    /**
+     * @brief Quotient and remainder in one division
+     * 
+     * The quotient truncates toward zero and the remainder takes the
+     * dividend's sign, as with int64_t.
+     * @throws std::domain_error if the divisor is zero
+     */
+    static std::pair<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor);
+    
+    /**
+     * @brief base^exponent mod |modulus|, in [0, |modulus|)
+     * @throws std::domain_error if the modulus is zero or the exponent negative
+     */
+    static BigInt pow_mod(const BigInt& base, const BigInt& exponent, const BigInt& modulus);
+    
     bool operator==(const BigInt& other) const;
     bool operator!=(const BigInt& other) const;
     bool operator<(const BigInt& other) const;
@@ -72,11 +106,29 @@ public:
     bool operator>(const BigInt& other) const;
     bool operator>=(const BigInt& other) const;
     
-    std::string to_string() const;
+    /**
+     * @brief Digits in radix 2, 8, 10 or 16 (lowercase), '-' if negative
+     * @throws std::invalid_argument on an unsupported radix
+     */
+    std::string to_string(unsigned radix = 10) const;
+    
+    bool is_negative() const { return negative_; }
+    bool is_zero() const { return digits_.size() == 1 && digits_[0] == 0; }
+    
+    /**
+     * @brief Convert to a machine integer
+     * @return Nothing if the value does not fit in int64_t
+     */
+    std::optional<int64_t> to_int64() const;
+    
+    /**
+     * @brief Nearest double, or infinity if out of range
+     */
+    double to_double() const;
     
 private:
     static constexpr int32_t BASE = 1000000000; // 10^9
-    std::vector<int32_t> digits_;
+    Limbs digits_;
     bool negative_;
     
     void normalize();
@@ -85,38 +137,91 @@ private:
 /**
  * @brief Main runtime value type
  * 
- * Variant holding all possible Kaynat++ runtime types.
+ * A type tag plus an 8-byte payload, 16 bytes in total. Integers, floats,
+ * booleans, characters and null are stored inline. Strings, big integers,
+ * lists, dictionaries, instances, functions and tasks live in a shared
+ * immutable box behind one pointer, so copying a value never copies
+ * their contents.
  * Immutable by design - operations create new values.
  */
 class KaynatValue {
 public:
-    using ValueVariant = std::variant<
-        NullType,
-        int64_t,
-        double,
-        bool,
-        char32_t,
-        std::string,
-        BigInt,
-        ListType,
-        DictType,
-        std::shared_ptr<KaynatInstance>,
-        CallableType
-    >;
-    
-    KaynatValue();
-    KaynatValue(NullType);
-    KaynatValue(int64_t value);
-    KaynatValue(double value);
-    KaynatValue(bool value);
-    KaynatValue(char32_t value);
+    /**
+     * @brief Runtime type tag; boxed types follow STRING
+     */
+    enum class Type : uint8_t {
+        NULL_VALUE,
+        INTEGER,
+        FLOAT,
+        BOOLEAN,
+        CHARACTER,
+        STRING,
+        BIGINT,
+        LIST,
+        DICT,
+        INSTANCE,
+        CALLABLE,
+        TASK
+    };
+    
+    KaynatValue() : type_(Type::NULL_VALUE) { payload_.int_ = 0; }
+    KaynatValue(NullType) : KaynatValue() {}
+    KaynatValue(int64_t value) : type_(Type::INTEGER) { payload_.int_ = value; }
+    KaynatValue(double value) : type_(Type::FLOAT) { payload_.float_ = value; }
+    KaynatValue(bool value) : type_(Type::BOOLEAN) { payload_.int_ = 0; payload_.bool_ = value; }
+    KaynatValue(char32_t value) : type_(Type::CHARACTER) { payload_.int_ = 0; payload_.char_ = value; }
     KaynatValue(const std::string& value);
+    KaynatValue(std::string&& value);
     KaynatValue(const char* value);
     KaynatValue(const BigInt& value);
     KaynatValue(const ListType& value);
+    KaynatValue(ListType&& value);
     KaynatValue(const DictType& value);
+    KaynatValue(DictType&& value);
     KaynatValue(std::shared_ptr<KaynatInstance> value);
     KaynatValue(CallableType value);
+    KaynatValue(std::shared_ptr<Task> value);
+    
+    /**
+     * @brief Integer value, kept inline when it fits in int64_t
+     * 
+     * Arithmetic builds every BigInt result through this, so an INTEGER
+     * and a BIGINT never hold the same number.
+     */
+    static KaynatValue integer(const BigInt& value);
+    
+    KaynatValue(const KaynatValue& other) : type_(other.type_), payload_(other.payload_) {
+        if (is_boxed()) payload_.box_->retain();
+    }
+    
+    KaynatValue(KaynatValue&& other) noexcept : type_(other.type_), payload_(other.payload_) {
+        other.type_ = Type::NULL_VALUE;
+    }
+    
+    KaynatValue& operator=(const KaynatValue& other) {
+        if (other.is_boxed()) other.payload_.box_->retain();
+        drop();
+        type_ = other.type_;
+        payload_ = other.payload_;
+        return *this;
+    }
+    
+    KaynatValue& operator=(KaynatValue&& other) noexcept {
+        if (this != &other) {
+            drop();
+            type_ = other.type_;
+            payload_ = other.payload_;
+            other.type_ = Type::NULL_VALUE;
+        }
+        return *this;
+    }
+    
+    ~KaynatValue() { drop(); }
+    
+    /**
+     * @brief Get the runtime type tag
+     */
+    Type type() const { return type_; }
     
     /**
      * @brief Get the type name as a string
@@ -127,7 +232,7 @@ public:
     /**
      * @brief Check if value is null
      */
-    bool is_null() const;
+    bool is_null() const { return type_ == Type::NULL_VALUE; }
     
     /**
      * @brief Check if value is truthy (for conditionals)
@@ -139,12 +244,6 @@ public:
      */
     std::string to_string() const;
     
-    /**
-     * @brief Get underlying variant
-     */
-    const ValueVariant& get_variant() const { return value_; }
-    ValueVariant& get_variant() { return value_; }
-    
     /**
      * @brief Type-safe getters with optional return
      */
@@ -159,6 +258,23 @@ public:
     std::optional<std::shared_ptr<KaynatInstance>> as_instance() const;
     std::optional<CallableType> as_callable() const;
     
+    /**
+     * @brief Borrowing getters; null if the value has another type
+     *
+     * The pointer refers into this value's storage and stays valid until
+     * the value is modified or destroyed. Prefer these over the copying
+     * getters when the contents are only inspected.
+     */
+    const int64_t* as_int_ptr() const { return type_ == Type::INTEGER ? &payload_.int_ : nullptr; }
+    int64_t* as_int_ptr() { return type_ == Type::INTEGER ? &payload_.int_ : nullptr; }
+    const double* as_float_ptr() const { return type_ == Type::FLOAT ? &payload_.float_ : nullptr; }
+    const std::string* as_string_ptr() const;
+    const BigInt* as_bigint_ptr() const;
+    const ListType* as_list_ptr() const;
+    const DictType* as_dict_ptr() const;
+    const CallableType* as_callable_ptr() const;
+    const std::shared_ptr<Task>* as_task_ptr() const;
+    
     /**
      * @brief Comparison operators
      */
@@ -170,7 +286,68 @@ public:
     bool operator>=(const KaynatValue& other) const;
     
 private:
-    ValueVariant value_;
+    union Payload {
+        int64_t int_;
+        double float_;
+        bool bool_;
+        char32_t char_;
+        CowHeader* box_;
+    };
+    
+    Type type_;
+    Payload payload_;
+    
+    bool is_boxed() const { return type_ >= Type::STRING; }
+    
+    template <typename T>
+    const T& unbox() const { return static_cast<const CowBox<T>*>(payload_.box_)->value; }
+    
+    template <typename T, typename... Args>
+    void box(Type type, Args&&... args) {
+        type_ = type;
+        payload_.box_ = new CowBox<T>(std::forward<Args>(args)...);
+    }
+    
+    void drop() {
+        if (is_boxed() && payload_.box_->release()) destroy();
+    }
+    
+    void destroy();
 };
 
+static_assert(sizeof(KaynatValue) == 16, "KaynatValue must stay two words");
+
+/**
+ * @brief Read-only view of native call arguments
+ * 
+ * Points into storage owned by the caller, such as the VM operand stack,
+ * for the duration of the call, so arguments are neither collected into
+ * a new vector nor copied.
+ */
+class ArgSpan {
+public:
+    ArgSpan() : data_(nullptr), size_(0) {}
+    ArgSpan(const KaynatValue* data, size_t size) : data_(data), size_(size) {}
+    ArgSpan(const std::vector<KaynatValue>& values) : data_(values.data()), size_(values.size()) {}
+    
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const KaynatValue& operator[](size_t index) const { return data_[index]; }
+    const KaynatValue* begin() const { return data_; }
+    const KaynatValue* end() const { return data_ + size_; }
+    
+private:
+    const KaynatValue* data_;
+    size_t size_;
+};
+
+/**
+ * @brief Signature of standard library functions
+ * 
+ * Stored in a CallableType like any function value. Callers that find
+ * one through CallableType::target<NativeFunction>() pass the arguments
+ * in place instead of going through std::function.
+ */
+using NativeFunction = KaynatValue (*)(ArgSpan args);
+
 } // namespace kaynat
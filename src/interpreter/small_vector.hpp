@@ -0,0 +1,159 @@
+/**
+ * @file small_vector.hpp
+ * @brief Vector with inline storage for a few trivially copyable elements
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace kaynat {
+
+/**
+ * @brief Contiguous sequence that keeps up to N elements in place
+ *
+ * Behaves like the subset of std::vector that BigInt needs. Up to N
+ * elements live inside the object itself; growing past that moves them
+ * to the heap, and they stay there until the vector is destroyed. Only
+ * trivially copyable elements are supported, so copies are memcpy.
+ */
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector elements must be trivially copyable");
+    static_assert(N > 0, "SmallVector needs inline room for at least one element");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() = default;
+
+    explicit SmallVector(size_t count, const T& value = T()) { assign(count, value); }
+
+    SmallVector(std::initializer_list<T> init) { assign(init.begin(), init.end()); }
+
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    SmallVector(It first, It last) { assign(first, last); }
+
+    SmallVector(const SmallVector& other) { assign(other.begin(), other.end()); }
+
+    SmallVector(SmallVector&& other) noexcept { take(other); }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() { release(); }
+
+    T* data() { return on_heap() ? heap_ : inline_; }
+    const T* data() const { return on_heap() ? heap_ : inline_; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    T& back() { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+    void reserve(size_t count) {
+        if (count <= capacity_) return;
+
+        T* storage = static_cast<T*>(::operator new(count * sizeof(T)));
+        if (size_ > 0) std::memcpy(storage, data(), size_ * sizeof(T));
+        release();
+        heap_ = storage;
+        capacity_ = static_cast<uint32_t>(count);
+    }
+
+    void resize(size_t count, const T& value = T()) {
+        if (count > capacity_) reserve(std::max(count, static_cast<size_t>(capacity_) * 2));
+        if (count > size_) std::fill(data() + size_, data() + count, value);
+        size_ = static_cast<uint32_t>(count);
+    }
+
+    void assign(size_t count, const T& value) {
+        size_ = 0;
+        resize(count, value);
+    }
+
+    template <typename It, typename = std::enable_if_t<!std::is_integral_v<It>>>
+    void assign(It first, It last) {
+        const size_t count = static_cast<size_t>(std::distance(first, last));
+        size_ = 0;
+        reserve(count);
+        std::copy(first, last, data());
+        size_ = static_cast<uint32_t>(count);
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) reserve(static_cast<size_t>(capacity_) * 2);
+        data()[size_++] = value;
+    }
+
+    void pop_back() { --size_; }
+
+    void clear() { size_ = 0; }
+
+    bool operator==(const SmallVector& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const SmallVector& other) const { return !(*this == other); }
+
+private:
+    uint32_t size_ = 0;
+    uint32_t capacity_ = N;
+    union {
+        T inline_[N];
+        T* heap_;
+    };
+
+    bool on_heap() const { return capacity_ > N; }
+
+    void release() {
+        if (on_heap()) {
+            ::operator delete(heap_);
+            capacity_ = N;
+        }
+    }
+
+    // Assumes this vector holds no heap storage
+    void take(SmallVector& other) {
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        if (other.on_heap()) {
+            heap_ = other.heap_;
+            other.capacity_ = N;
+        } else {
+            std::memcpy(inline_, other.inline_, size_ * sizeof(T));
+        }
+        other.size_ = 0;
+    }
+};
+
+} // namespace kaynat
@@ -0,0 +1,69 @@
+/**
+ * @file symbol.cpp
+ * @brief Symbol intern table
+ */
+
+#include "symbol.hpp"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace kaynat {
+
+Symbol::Symbol() {
+    // Interned once; default symbols after that take no lock
+    static const Entry* const empty = lookup(std::string_view(), true);
+    entry_ = empty;
+}
+
+Symbol::Symbol(std::string_view text) : entry_(lookup(text, true)) {}
+
+std::optional<Symbol> Symbol::find(std::string_view text) {
+    if (const Entry* entry = lookup(text, false)) {
+        return Symbol(entry);
+    }
+    return std::nullopt;
+}
+
+const Symbol::Entry* Symbol::lookup(std::string_view text, bool insert) {
+    // Entries sit in a deque so their addresses never change. The table is
+    // never destroyed, so symbols stay valid during static destruction.
+    struct Table {
+        std::shared_mutex mutex;
+        std::deque<Entry> entries;
+        std::unordered_map<std::string_view, const Entry*> index;
+    };
+    static Table* table = new Table();
+    
+    // Names already interned only need a shared lock, so threads looking
+    // up dictionary keys and identifiers do not queue behind each other
+    {
+        std::shared_lock<std::shared_mutex> lock(table->mutex);
+        auto it = table->index.find(text);
+        if (it != table->index.end()) {
+            return it->second;
+        }
+    }
+    
+    if (!insert) {
+        return nullptr;
+    }
+    
+    std::lock_guard<std::shared_mutex> lock(table->mutex);
+    
+    // Another thread may have added the name since the shared lock was released
+    auto it = table->index.find(text);
+    if (it != table->index.end()) {
+        return it->second;
+    }
+    
+    // Hash as std::string does so that symbol-keyed maps keep the
+    // iteration order their string-keyed predecessors had
+    table->entries.push_back(Entry{std::string(text), std::hash<std::string_view>{}(text)});
+    const Entry& entry = table->entries.back();
+    table->index.emplace(std::string_view(entry.text), &entry);
+    return &entry;
+}
+
+} // namespace kaynat
@@ -0,0 +1,88 @@
+/**
+ * @file symbol.hpp
+ * @brief Interned names for Kaynat++
+ *
+ * Identifiers, dictionary keys and environment entries are stored as
+ * Symbols: handles to a process-wide table of distinct strings. Equal
+ * names share one entry, so comparing two symbols is a pointer compare
+ * and their hash is computed once, when the name is first interned.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kaynat {
+
+/**
+ * @brief Handle to an interned string
+ *
+ * Symbols are created implicitly from strings so that APIs taking a
+ * Symbol accept plain names. Creating a symbol looks the text up in the
+ * intern table; copying, comparing and hashing it never touch the text.
+ * Interned entries live until the process exits.
+ *
+ * Thread-safe: Yes. Looking up a name already in the intern table
+ * takes a shared lock, and only adding a new name takes it exclusively;
+ * the empty name takes no lock. Existing handles may be used from any
+ * thread.
+ */
+class Symbol {
+public:
+    /**
+     * @brief The empty name
+     */
+    Symbol();
+    
+    Symbol(std::string_view text);
+    Symbol(const std::string& text) : Symbol(std::string_view(text)) {}
+    Symbol(const char* text) : Symbol(std::string_view(text)) {}
+    
+    /**
+     * @brief Look up a name without interning it
+     * @return The symbol, or nullopt if the name was never interned
+     * 
+     * A name that was never interned cannot be a key anywhere, so probes
+     * with runtime strings use this to avoid growing the table.
+     */
+    static std::optional<Symbol> find(std::string_view text);
+    
+    const std::string& str() const { return entry_->text; }
+    size_t hash() const { return entry_->hash; }
+    bool empty() const { return entry_->text.empty(); }
+    
+    bool operator==(const Symbol& other) const { return entry_ == other.entry_; }
+    bool operator!=(const Symbol& other) const { return entry_ != other.entry_; }
+    
+    /**
+     * @brief Order by text, for sorted output
+     */
+    bool operator<(const Symbol& other) const { return entry_->text < other.entry_->text; }
+    
+private:
+    struct Entry {
+        std::string text;
+        size_t hash;
+    };
+    
+    const Entry* entry_;
+    
+    explicit Symbol(const Entry* entry) : entry_(entry) {}
+    
+    static const Entry* lookup(std::string_view text, bool insert);
+};
+
+} // namespace kaynat
+
+namespace std {
+
+template <>
+struct hash<kaynat::Symbol> {
+    size_t operator()(const kaynat::Symbol& symbol) const { return symbol.hash(); }
+};
+
+} // namespace std
@@ -0,0 +1,73 @@
+/**
+ * @file task.cpp
+ * @brief Task implementation
+ */
+
+#include "task.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <utility>
+
+namespace kaynat {
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this]() { return unfinished_ == 0; });
+}
+
+Task::Task(std::shared_ptr<TaskGroup> group, Body body)
+    : body_(std::move(body)), group_(std::move(group)) {}
+
+std::shared_ptr<Task> Task::spawn(std::shared_ptr<TaskGroup> group, Body body) {
+    std::shared_ptr<Task> task(new Task(std::move(group), std::move(body)));
+    {
+        std::lock_guard<std::mutex> lock(task->group_->mutex_);
+        ++task->group_->unfinished_;
+    }
+    ThreadPool::shared().submit([task]() { task->run(); });
+    return task;
+}
+
+KaynatValue Task::wait() {
+    run();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return state_ == State::DONE; });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    return result_;
+}
+
+void Task::run() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::PENDING) return;
+        state_ = State::RUNNING;
+    }
+
+    KaynatValue result;
+    std::exception_ptr error;
+    try {
+        result = body_();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Drop the arguments and the worker now rather than with the handle
+    body_ = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result_ = std::move(result);
+        error_ = error;
+        state_ = State::DONE;
+    }
+    done_.notify_all();
+
+    std::lock_guard<std::mutex> lock(group_->mutex_);
+    if (--group_->unfinished_ == 0) {
+        group_->finished_.notify_all();
+    }
+}
+
+} // namespace kaynat
@@ -0,0 +1,88 @@
+/**
+ * @file task.hpp
+ * @brief Function calls started with "spawn" and joined with "wait for"
+ */
+
+#pragma once
+
+#include "runtime_value.hpp"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <mutex>
+
+namespace kaynat {
+
+/**
+ * @brief Unfinished tasks of one engine
+ *
+ * Each engine waits for its own tasks before it is destroyed, since they
+ * still run its functions. Separate engines, such as isolates, share the
+ * thread pool but not their groups, so none waits for another's tasks.
+ *
+ * Thread-safe: Yes.
+ */
+class TaskGroup {
+public:
+    /**
+     * @brief Block until every task spawned in this group has finished
+     */
+    void wait();
+
+private:
+    friend class Task;
+
+    std::mutex mutex_;
+    std::condition_variable finished_;
+    size_t unfinished_ = 0;
+};
+
+/**
+ * @brief One call running on the shared thread pool
+ *
+ * A task runs exactly once: on a pool worker, or on the first thread
+ * that waits for it before any worker has started it. Waiting therefore
+ * never blocks on a queue that no thread gets to, even when every
+ * worker is itself waiting for a task.
+ *
+ * Thread-safe: Yes.
+ */
+class Task {
+public:
+    using Body = std::function<KaynatValue()>;
+
+    /**
+     * @brief Create a task and queue it on ThreadPool::shared()
+     * @param group Group that counts the task until it finishes
+     */
+    static std::shared_ptr<Task> spawn(std::shared_ptr<TaskGroup> group, Body body);
+
+    /**
+     * @brief Wait for the task to finish, running it here if it has not started
+     * @return Result of the call
+     * @throws Whatever the call threw, on every wait
+     */
+    KaynatValue wait();
+
+private:
+    enum class State { PENDING, RUNNING, DONE };
+
+    Body body_;
+    std::shared_ptr<TaskGroup> group_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    State state_ = State::PENDING;
+    KaynatValue result_;
+    std::exception_ptr error_;
+
+    Task(std::shared_ptr<TaskGroup> group, Body body);
+
+    /**
+     * @brief Run the body unless another thread has started it
+     */
+    void run();
+};
+
+} // namespace kaynat
@@ -0,0 +1,162 @@
+/**
+ * @file thread_pool.cpp
+ * @brief ThreadPool implementation
+ */
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+
+namespace kaynat {
+
+namespace {
+
+// Pool and queue of the worker running on this thread, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this, i]() { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    // Never destroyed, so tasks still queued at exit cannot outlive it
+    static ThreadPool* pool = new ThreadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return *pool;
+}
+
+void ThreadPool::submit(Task task) {
+    const size_t index = current_pool == this
+        ? current_worker
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->tasks.push_back(std::move(task));
+    }
+
+    {
+        // Taken so that a worker between its last check and its wait
+        // cannot miss the notification
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        queued_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_one();
+}
+
+void ThreadPool::run_together(size_t helpers, const std::function<void()>& work) {
+    struct Shared {
+        std::function<void()> work;
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t running = 0;
+        bool closed = false;
+        std::exception_ptr error;
+    };
+
+    auto shared = std::make_shared<Shared>();
+    shared->work = work;
+
+    for (size_t i = 0; i < std::min(helpers, workers_.size()); ++i) {
+        submit([shared]() {
+            {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if (shared->closed) return;
+                ++shared->running;
+            }
+
+            std::exception_ptr error;
+            try {
+                shared->work();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            if (error && !shared->error) shared->error = error;
+            if (--shared->running == 0) shared->done.notify_all();
+        });
+    }
+
+    std::exception_ptr error;
+    try {
+        work();
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->closed = true;
+    shared->done.wait(lock, [&shared]() { return shared->running == 0; });
+    if (!error) error = shared->error;
+    lock.unlock();
+
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::work(size_t index) {
+    current_pool = this;
+    current_worker = index;
+
+    for (;;) {
+        Task task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this]() { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_ && queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::take(size_t index, Task& task) {
+    // Own queue first, newest task first
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Then the oldest task of another worker
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        Worker& victim = *workers_[(index + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace kaynat
@@ -0,0 +1,97 @@
+/**
+ * @file thread_pool.hpp
+ * @brief Work-stealing thread pool shared by the Kaynat++ engines
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Fixed set of worker threads with one task queue each
+ *
+ * A task submitted from a worker goes to the back of that worker's own
+ * queue and is taken from there again (newest first, while its data is
+ * still in cache). Tasks from other threads are spread over the queues
+ * in turn. A worker whose queue is empty steals the oldest task of
+ * another worker before it goes to sleep.
+ *
+ * Thread-safe: Yes.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads Number of worker threads, at least one
+     */
+    explicit ThreadPool(size_t threads);
+
+    /**
+     * @brief Finish the queued tasks and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Pool used by parallel loops, created on first use
+     *
+     * Has one worker less than the machine has hardware threads, since
+     * the thread that starts parallel work takes part in it.
+     */
+    static ThreadPool& shared();
+
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Queue a task; it must not throw
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Run work on the calling thread and on up to `helpers` workers
+     *
+     * Returns once the caller's run and every helper run that has started
+     * have returned. Helpers the pool only gets to later do nothing, so
+     * work must only return once nothing is left for any thread to do.
+     * Because the caller always runs work itself, this cannot deadlock
+     * when every worker is busy, e.g. when called from a task.
+     *
+     * @throws Whatever the first failing run threw
+     */
+    void run_together(size_t helpers, const std::function<void()>& work);
+
+private:
+    /**
+     * @brief Queue of one worker
+     */
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    void work(size_t index);
+    bool take(size_t index, Task& task);
+};
+
+} // namespace kaynat
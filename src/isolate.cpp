@@ -0,0 +1,111 @@
+/**
+ * @file isolate.cpp
+ * @brief Isolate implementation
+ */
+
+#include "isolate.hpp"
+#include "lexer/lexer.hpp"
+#include "parser/parser.hpp"
+#include "errors/error_types.hpp"
+
+namespace kaynat {
+
+namespace {
+
+/**
+ * @brief Find a part of a value that cannot leave the engine it was made in
+ *
+ * Lists, dictionaries and big numbers are shared and never modified,
+ * so handing over the value copies it as far as either side can tell.
+ *
+ * @return The first function, instance or task in the value, or null
+ *         if it is plain data
+ */
+const KaynatValue* find_non_data(const KaynatValue& value) {
+    switch (value.type()) {
+        case KaynatValue::Type::LIST:
+            for (const KaynatValue& element : *value.as_list_ptr()) {
+                if (const KaynatValue* found = find_non_data(element)) return found;
+            }
+            return nullptr;
+
+        case KaynatValue::Type::DICT:
+            for (const auto& entry : *value.as_dict_ptr()) {
+                if (const KaynatValue* found = find_non_data(entry.second)) return found;
+            }
+            return nullptr;
+
+        case KaynatValue::Type::INSTANCE:
+        case KaynatValue::Type::CALLABLE:
+        case KaynatValue::Type::TASK:
+            return &value;
+
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace
+
+Isolate::Isolate(std::string source, const RunOptions& options)
+    : source_(std::move(source)), options_(options) {}
+
+Isolate::~Isolate() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Isolate::define(const std::string& name, const KaynatValue& value) {
+    if (started_) {
+        throw RuntimeError("Cannot define '" + name + "' in an isolate that has started", 0, 0);
+    }
+    if (const KaynatValue* found = find_non_data(value)) {
+        throw RuntimeError("Only data can pass between isolates, not a " + found->type_name(), 0, 0);
+    }
+    inputs_.emplace_back(name, value);
+}
+
+void Isolate::start() {
+    if (!started_) {
+        started_ = true;
+        thread_ = std::thread([this]() { run(); });
+    }
+}
+
+KaynatValue Isolate::join() {
+    start();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    return result_;
+}
+
+void Isolate::run() {
+    try {
+        Lexer lexer(source_);
+        auto tokens = lexer.tokenize();
+
+        Parser parser(tokens);
+        auto ast = parser.parse();
+
+        Engine engine(options_, false);
+        for (const auto& [name, value] : inputs_) {
+            engine.define(name, value);
+        }
+        // A function or task left as the last value stays behind with
+        // its engine; the program itself still succeeded
+        KaynatValue result = engine.execute(ast);
+        if (!find_non_data(result)) {
+            result_ = std::move(result);
+        }
+    } catch (...) {
+        error_ = std::current_exception();
+    }
+}
+
+} // namespace kaynat
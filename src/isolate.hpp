@@ -0,0 +1,74 @@
+/**
+ * @file isolate.hpp
+ * @brief Programs running side by side, each on an engine and thread of its own
+ */
+
+#pragma once
+
+#include "engine.hpp"
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief A program with its own engine, running on a thread of its own
+ *
+ * Isolates share nothing but the standard library table, which no
+ * engine changes, so any number of them may run at once. Values go in
+ * through define() before start() and come out of join(). Both copy the
+ * value and pass only data: functions and tasks belong to the engine
+ * that made them.
+ *
+ * Thread-safe: No. Each isolate is driven by one host thread.
+ */
+class Isolate {
+public:
+    /**
+     * @param source Program text, parsed on the isolate's thread
+     * @param options Execution engine options
+     */
+    Isolate(std::string source, const RunOptions& options);
+
+    /**
+     * @brief Wait for the program if it is still running
+     */
+    ~Isolate();
+
+    Isolate(const Isolate&) = delete;
+    Isolate& operator=(const Isolate&) = delete;
+
+    /**
+     * @brief Give the program a global variable
+     * @throws RuntimeError if the value is not plain data, or after start()
+     */
+    void define(const std::string& name, const KaynatValue& value);
+
+    /**
+     * @brief Start running the program
+     */
+    void start();
+
+    /**
+     * @brief Wait for the program to finish
+     * @return Value of its last statement, or null if that is not plain data
+     * @throws Whatever the program threw, including parse errors
+     */
+    KaynatValue join();
+
+private:
+    std::string source_;
+    RunOptions options_;
+    std::vector<std::pair<std::string, KaynatValue>> inputs_;
+    std::thread thread_;
+    bool started_ = false;
+    KaynatValue result_;
+    std::exception_ptr error_;
+
+    void run();
+};
+
+} // namespace kaynat
@@ -126,6 +126,11 @@ const std::unordered_map<std::string, TokenType> Lexer::keywords_ = {
     {"inline", TokenType::INLINE},
     {"gives", TokenType::GIVES},
     
+    // Concurrency
+    {"spawn", TokenType::SPAWN},
+    {"wait", TokenType::WAIT},
+    {"finish", TokenType::FINISH},
+    
     // Collections
     {"containing", TokenType::CONTAINING},
     {"create", TokenType::CREATE},
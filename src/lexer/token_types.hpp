@@ -332,6 +332,7 @@ enum class TokenType {
     ATTACH,
     
     // Keywords - Async
+    SPAWN,
     RUN,
     // BACKGROUND already defined in GUI
     WAIT,
@@ -5,14 +5,10 @@
  * Handles command-line arguments and dispatches to REPL or file execution.
  */
 
+#include "repl.hpp"
 #include <iostream>
 #include <string>
 
-namespace kaynat {
-    void run_repl();
-    void run_file(const std::string& filename);
-}
-
 /**
  * @brief Print usage information
  */
@@ -20,9 +16,17 @@ void print_usage(const char* program_name) {
     std::cout << "Kaynat++ Programming Language\n";
     std::cout << "Usage:\n";
     std::cout << "  " << program_name << " <file.kn>     Run a Kaynat++ program\n";
+    std::cout << "  " << program_name << " <file.kn>...  Run several programs at once, each isolated\n";
     std::cout << "  " << program_name << " --repl        Start interactive REPL\n";
     std::cout << "  " << program_name << " --help        Show this help message\n";
     std::cout << "  " << program_name << " --version     Show version information\n";
+    std::cout << "\nOptions (before the file name or --repl):\n";
+    std::cout << "  --tree-walk      Use the tree-walking interpreter instead of the VM\n";
+    std::cout << "  --dump-bytecode  Print compiled bytecode before running\n";
+    std::cout << "  -O0              Run the program without AST optimizations\n";
+    std::cout << "  -O1              Fold constants, drop dead branches and memoize pure\n";
+    std::cout << "                   recursive functions (default)\n";
+    std::cout << "  --memo-stats     Report result cache hits and misses on stderr\n";
 }
 
 /**
@@ -43,7 +47,33 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    const std::string arg = argv[1];
+    kaynat::RunOptions options;
+    int index = 1;
+    
+    // Engine options come first
+    for (; index < argc; ++index) {
+        const std::string option = argv[index];
+        if (option == "--tree-walk") {
+            options.tree_walk = true;
+        } else if (option == "--dump-bytecode") {
+            options.dump_bytecode = true;
+        } else if (option == "-O0") {
+            options.opt_level = kaynat::OptLevel::O0;
+        } else if (option == "-O1") {
+            options.opt_level = kaynat::OptLevel::O1;
+        } else if (option == "--memo-stats") {
+            options.memo_stats = true;
+        } else {
+            break;
+        }
+    }
+    
+    if (index >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    const std::string arg = argv[index];
     
     if (arg == "--help" || arg == "-h") {
         print_usage(argv[0]);
@@ -56,13 +86,16 @@ int main(int argc, char* argv[]) {
     }
     
     if (arg == "--repl" || arg == "-r") {
-        kaynat::run_repl();
+        kaynat::run_repl(options);
         return 0;
     }
     
-    // Assume it's a filename
+    // Assume the rest are filenames
     try {
-        kaynat::run_file(arg);
+        if (index + 1 < argc) {
+            return kaynat::run_files({argv + index, argv + argc}, options) ? 0 : 1;
+        }
+        kaynat::run_file(arg, options);
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
@@ -0,0 +1,231 @@
+/**
+ * @file ast.hpp
+ * @brief Arena storage for a parsed program
+ *
+ * Holds every node of one program in per-kind pools and every child
+ * list in one shared array, so nodes refer to each other by 32-bit
+ * NodeRef instead of owning pointers.
+ */
+
+#pragma once
+
+#include "nodes.hpp"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace kaynat {
+
+/**
+ * @brief Chunked storage for nodes of one kind
+ *
+ * Nodes are constructed in place inside fixed-size chunks and never
+ * move, so references into the pool stay valid while it grows. All
+ * nodes are destroyed together with the pool.
+ */
+template <typename T>
+class NodePool {
+public:
+    static constexpr uint32_t CHUNK_BITS = 8;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        for (uint32_t i = 0; i < size_; ++i) {
+            at(i).~T();
+        }
+    }
+
+    uint32_t add(T&& node) {
+        if (size_ % CHUNK_SIZE == 0) {
+            chunks_.push_back(std::make_unique<Slot[]>(CHUNK_SIZE));
+        }
+        new (chunks_.back()[size_ % CHUNK_SIZE].bytes) T(std::move(node));
+        return size_++;
+    }
+
+    T& at(uint32_t index) {
+        Slot& slot = chunks_[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+        return *std::launder(reinterpret_cast<T*>(slot.bytes));
+    }
+
+    uint32_t size() const { return size_; }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    uint32_t size_ = 0;
+};
+
+/**
+ * @brief Contiguous view of a NodeList
+ */
+class NodeSpan {
+public:
+    NodeSpan(NodeRef* begin, size_t size) : begin_(begin), size_(size) {}
+
+    NodeRef* begin() const { return begin_; }
+    NodeRef* end() const { return begin_ + size_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    NodeRef& operator[](size_t i) const { return begin_[i]; }
+    NodeRef& back() const { return begin_[size_ - 1]; }
+
+private:
+    NodeRef* begin_;
+    size_t size_;
+};
+
+/**
+ * @brief A parsed program
+ *
+ * Produced by the Parser and shared by everything that keeps nodes
+ * alive past execution, such as interpreted function values. Passes
+ * rewrite nodes in place and may add new ones; only the parser adds
+ * lists, so a NodeSpan stays valid once parsing is done.
+ *
+ * Thread-safe: No. Nodes carry mutable resolver and cache state.
+ */
+class Ast {
+public:
+    Ast() = default;
+    Ast(const Ast&) = delete;
+    Ast& operator=(const Ast&) = delete;
+
+    /**
+     * @brief Store a node
+     * @return Reference to the stored node
+     */
+    template <typename T>
+    NodeRef add(T&& node) {
+        using Node = std::decay_t<T>;
+        auto& pool = std::get<NodePool<Node>>(pools_);
+        if (pool.size() > NodeRef::MAX_INDEX) {
+            throw std::length_error("Program has too many nodes");
+        }
+        return NodeRef(Node::KIND, pool.add(std::forward<T>(node)));
+    }
+
+    /**
+     * @brief Store a child list
+     */
+    NodeList add_list(const std::vector<NodeRef>& nodes) {
+        NodeList list;
+        list.first = static_cast<uint32_t>(lists_.size());
+        list.count = static_cast<uint32_t>(nodes.size());
+        lists_.insert(lists_.end(), nodes.begin(), nodes.end());
+        return list;
+    }
+
+    NodeSpan list(NodeList list) {
+        return NodeSpan(lists_.data() + list.first, list.count);
+    }
+
+    /**
+     * @brief Access a node whose kind is known
+     */
+    template <typename T>
+    T& get(NodeRef ref) {
+        return std::get<NodePool<T>>(pools_).at(ref.index());
+    }
+
+    /**
+     * @brief Access a node if it has the given kind
+     * @return Null for any other kind
+     */
+    template <typename T>
+    T* get_if(NodeRef ref) {
+        return ref.kind() == T::KIND ? &get<T>(ref) : nullptr;
+    }
+
+    /**
+     * @brief Number of stored nodes of one kind
+     *
+     * Nodes of a kind have indices 0 .. count - 1.
+     */
+    template <typename T>
+    uint32_t count() const {
+        return std::get<NodePool<T>>(pools_).size();
+    }
+
+    /**
+     * @brief Call f with the node behind ref
+     *
+     * f receives a std::monostate for an empty reference, so a generic
+     * lambda sees the same alternatives the old node variant had.
+     */
+    template <typename F>
+    decltype(auto) visit(NodeRef ref, F&& f) {
+        switch (ref.kind()) {
+            case NodeKind::PROGRAM: return f(get<ProgramNode>(ref));
+            case NodeKind::LITERAL: return f(get<LiteralNode>(ref));
+            case NodeKind::IDENTIFIER: return f(get<IdentifierNode>(ref));
+            case NodeKind::BINARY_OP: return f(get<BinaryOpNode>(ref));
+            case NodeKind::UNARY_OP: return f(get<UnaryOpNode>(ref));
+            case NodeKind::ASSIGNMENT: return f(get<AssignmentNode>(ref));
+            case NodeKind::IF: return f(get<IfNode>(ref));
+            case NodeKind::WHILE: return f(get<WhileNode>(ref));
+            case NodeKind::REPEAT: return f(get<RepeatNode>(ref));
+            case NodeKind::FOR_EACH: return f(get<ForEachNode>(ref));
+            case NodeKind::FUNCTION_DEF: return f(get<FunctionDefNode>(ref));
+            case NodeKind::FUNCTION_CALL: return f(get<FunctionCallNode>(ref));
+            case NodeKind::RETURN: return f(get<ReturnNode>(ref));
+            case NodeKind::LIST: return f(get<ListNode>(ref));
+            case NodeKind::DICT: return f(get<DictNode>(ref));
+            case NodeKind::INDEX: return f(get<IndexNode>(ref));
+            case NodeKind::PROPERTY_ACCESS: return f(get<PropertyAccessNode>(ref));
+            case NodeKind::BLOCK: return f(get<BlockNode>(ref));
+            case NodeKind::GUI: return f(get<GUINode>(ref));
+            case NodeKind::WAIT: return f(get<WaitNode>(ref));
+            case NodeKind::NONE: break;
+        }
+        std::monostate none;
+        return f(none);
+    }
+
+    /**
+     * @brief Root of the program
+     */
+    NodeRef root() const { return root_; }
+    ProgramNode& program() { return get<ProgramNode>(root_); }
+    void set_root(NodeRef root) { root_ = root; }
+
+private:
+    std::tuple<
+        NodePool<ProgramNode>,
+        NodePool<LiteralNode>,
+        NodePool<IdentifierNode>,
+        NodePool<BinaryOpNode>,
+        NodePool<UnaryOpNode>,
+        NodePool<AssignmentNode>,
+        NodePool<IfNode>,
+        NodePool<WhileNode>,
+        NodePool<RepeatNode>,
+        NodePool<ForEachNode>,
+        NodePool<FunctionDefNode>,
+        NodePool<FunctionCallNode>,
+        NodePool<ReturnNode>,
+        NodePool<ListNode>,
+        NodePool<DictNode>,
+        NodePool<IndexNode>,
+        NodePool<PropertyAccessNode>,
+        NodePool<BlockNode>,
+        NodePool<GUINode>,
+        NodePool<WaitNode>
+    > pools_;
+    std::vector<NodeRef> lists_;
+    NodeRef root_;
+};
+
+} // namespace kaynat
@@ -2,79 +2,147 @@
  * @file nodes.hpp
  * @brief Abstract Syntax Tree node definitions
  * 
- * Defines all AST node types for Kaynat++ parser.
- * Uses std::variant for type-safe node representation.
+ * Defines all AST node types for Kaynat++ parser. Nodes are plain
+ * structs stored by kind in an Ast and linked by NodeRef.
  */
 
 #pragma once
 
 #include "../lexer/token_types.hpp"
+#include "../interpreter/memo_table.hpp"
+#include "../interpreter/runtime_value.hpp"
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
-#include <variant>
 
 namespace kaynat {
 
-// Forward declarations
-struct ProgramNode;
-struct LiteralNode;
-struct IdentifierNode;
-struct BinaryOpNode;
-struct UnaryOpNode;
-struct AssignmentNode;
-struct IfNode;
-struct WhileNode;
-struct RepeatNode;
-struct ForEachNode;
-struct FunctionDefNode;
-struct FunctionCallNode;
-struct ReturnNode;
-struct ListNode;
-struct DictNode;
-struct IndexNode;
-struct PropertyAccessNode;
-struct BlockNode;
-struct GUINode;
+class Environment;
 
 /**
- * @brief Base AST node using variant
+ * @brief Kind tag of an AST node
+ * 
+ * NONE marks an empty slot, such as a comment statement.
+ */
+enum class NodeKind : uint8_t {
+    NONE,
+    PROGRAM,
+    LITERAL,
+    IDENTIFIER,
+    BINARY_OP,
+    UNARY_OP,
+    ASSIGNMENT,
+    IF,
+    WHILE,
+    REPEAT,
+    FOR_EACH,
+    FUNCTION_DEF,
+    FUNCTION_CALL,
+    RETURN,
+    LIST,
+    DICT,
+    INDEX,
+    PROPERTY_ACCESS,
+    BLOCK,
+    GUI,
+    WAIT
+};
+
+/**
+ * @brief Reference to a node stored in an Ast
+ * 
+ * Packs the node kind and its index within the Ast's pool for that kind
+ * into 32 bits. A reference is only meaningful together with the Ast
+ * that created it.
+ */
+class NodeRef {
+public:
+    static constexpr uint32_t INDEX_BITS = 27;
+    static constexpr uint32_t MAX_INDEX = (1u << INDEX_BITS) - 1;
+    
+    NodeRef() = default;
+    NodeRef(NodeKind kind, uint32_t index)
+        : bits_((static_cast<uint32_t>(kind) << INDEX_BITS) | index) {}
+    
+    NodeKind kind() const { return static_cast<NodeKind>(bits_ >> INDEX_BITS); }
+    uint32_t index() const { return bits_ & MAX_INDEX; }
+    bool empty() const { return bits_ == 0; }
+    
+private:
+    uint32_t bits_ = 0;
+};
+
+/**
+ * @brief Child statements or expressions of a node
+ * 
+ * A contiguous run of references in the Ast's shared list storage.
  */
-using ASTNode = std::variant<
-    std::monostate,
-    std::shared_ptr<ProgramNode>,
-    std::shared_ptr<LiteralNode>,
-    std::shared_ptr<IdentifierNode>,
-    std::shared_ptr<BinaryOpNode>,
-    std::shared_ptr<UnaryOpNode>,
-    std::shared_ptr<AssignmentNode>,
-    std::shared_ptr<IfNode>,
-    std::shared_ptr<WhileNode>,
-    std::shared_ptr<RepeatNode>,
-    std::shared_ptr<ForEachNode>,
-    std::shared_ptr<FunctionDefNode>,
-    std::shared_ptr<FunctionCallNode>,
-    std::shared_ptr<ReturnNode>,
-    std::shared_ptr<ListNode>,
-    std::shared_ptr<DictNode>,
-    std::shared_ptr<IndexNode>,
-    std::shared_ptr<PropertyAccessNode>,
-    std::shared_ptr<BlockNode>,
-    std::shared_ptr<GUINode>
->;
+struct NodeList {
+    uint32_t first = 0;
+    uint32_t count = 0;
+    
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+/**
+ * @brief Static resolution of a variable reference
+ * 
+ * Filled in by the Resolver. Each candidate names a function scope
+ * `depth` levels out from the current function and a slot in it,
+ * innermost first. A reference reads the first candidate that has been
+ * assigned and falls back to the global environment by name. Top-level
+ * code has no candidates.
+ */
+struct VariableBinding {
+    struct Candidate {
+        uint32_t depth;
+        uint32_t slot;
+    };
+    
+    std::vector<Candidate> candidates;
+};
+
+/**
+ * @brief Inline cache of a call site's global callee
+ * 
+ * Valid while the owning environment keeps the recorded version, which
+ * changes whenever a name is defined or removed. Reassignment updates
+ * the cached value in place.
+ */
+struct CallSiteCache {
+    const Environment* owner = nullptr;
+    uint64_t version = 0;
+    const KaynatValue* value = nullptr;
+};
+
+/**
+ * @brief Slot layout of a function scope, computed by the Resolver
+ * 
+ * Parameters occupy the first slots in declaration order.
+ */
+struct ScopeLayout {
+    std::vector<Symbol> names;  // Variable name per slot
+    std::vector<bool> captured;      // Whether nested functions use the slot
+};
 
 /**
  * @brief Program root node
  */
 struct ProgramNode {
-    std::vector<ASTNode> statements;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::PROGRAM;
+    
+    NodeList statements;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Literal value node
  */
 struct LiteralNode {
+    static constexpr NodeKind KIND = NodeKind::LITERAL;
+    
     enum class Type {
         INTEGER,
         FLOAT,
@@ -84,22 +152,28 @@ struct LiteralNode {
     };
     
     Type type;
-    std::string value;
-    uint32_t line;
+    std::string value;      // Source text
+    KaynatValue constant;   // Value decoded once by the parser
+    uint32_t line = 0;
 };
 
 /**
  * @brief Identifier reference
  */
 struct IdentifierNode {
-    std::string name;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::IDENTIFIER;
+    
+    Symbol name;
+    uint32_t line = 0;
+    VariableBinding binding;
 };
 
 /**
  * @brief Binary operation
  */
 struct BinaryOpNode {
+    static constexpr NodeKind KIND = NodeKind::BINARY_OP;
+    
     enum class Op {
         ADD,
         SUBTRACT,
@@ -116,147 +190,211 @@ struct BinaryOpNode {
         OR
     };
     
+    /**
+     * @brief Operand types seen here by the tree-walking interpreter
+     * 
+     * A site starts UNSEEN and specializes to the operand types of its
+     * first run. A later run with other types turns it GENERIC for good.
+     */
+    enum class Feedback : uint8_t {
+        UNSEEN,
+        INT_INT,
+        FLOAT_FLOAT,
+        GENERIC
+    };
+    
     Op op;
-    ASTNode left;
-    ASTNode right;
-    uint32_t line;
+    NodeRef left;
+    NodeRef right;
+    uint32_t line = 0;
+    Feedback feedback = Feedback::UNSEEN;
 };
 
 /**
  * @brief Unary operation
  */
 struct UnaryOpNode {
+    static constexpr NodeKind KIND = NodeKind::UNARY_OP;
+    
     enum class Op {
         NEGATE,
         NOT
     };
     
     Op op;
-    ASTNode operand;
-    uint32_t line;
+    NodeRef operand;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Variable assignment
  */
 struct AssignmentNode {
-    std::string name;
-    ASTNode value;
+    static constexpr NodeKind KIND = NodeKind::ASSIGNMENT;
+    
+    Symbol name;
+    NodeRef value;
     bool is_constant;
-    uint32_t line;
+    uint32_t line = 0;
+    VariableBinding binding;
 };
 
 /**
  * @brief If-then-else conditional
  */
 struct IfNode {
-    ASTNode condition;
-    std::vector<ASTNode> then_branch;
-    std::vector<ASTNode> else_branch;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::IF;
+    
+    NodeRef condition;
+    NodeList then_branch;
+    NodeList else_branch;
+    uint32_t line = 0;
 };
 
 /**
  * @brief While loop
  */
 struct WhileNode {
-    ASTNode condition;
-    std::vector<ASTNode> body;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::WHILE;
+    
+    NodeRef condition;
+    NodeList body;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Repeat N times loop
  */
 struct RepeatNode {
-    ASTNode count;
-    std::vector<ASTNode> body;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::REPEAT;
+    
+    NodeRef count;
+    NodeList body;
+    uint32_t line = 0;
 };
 
 /**
  * @brief For-each loop
+ * 
+ * A parallel loop runs its body like the body of a function taking the
+ * loop variable, once per item and on several threads. Its value is the
+ * list of the iterations' results, optionally stored under `target`.
  */
 struct ForEachNode {
-    std::string variable;
-    ASTNode iterable;
-    std::vector<ASTNode> body;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::FOR_EACH;
+    
+    Symbol variable;
+    NodeRef iterable;
+    NodeList body;
+    uint32_t line = 0;
+    VariableBinding binding;
+    bool parallel = false;
+    Symbol target;                   // Name the results are stored as, if any
+    VariableBinding target_binding;
+    ScopeLayout layout;              // Slots of a parallel body, loop variable first
 };
 
 /**
  * @brief Function definition
+ * 
+ * Calls are memoized when the definition carries "remember results" or
+ * the optimizer proves the function pure and recursive.
  */
 struct FunctionDefNode {
-    std::string name;
-    std::vector<std::string> parameters;
-    std::vector<ASTNode> body;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::FUNCTION_DEF;
+    
+    Symbol name;
+    std::vector<Symbol> parameters;
+    NodeList body;
+    uint32_t line = 0;
+    VariableBinding binding;  // Where the function name is defined
+    ScopeLayout layout;       // Slots of the function body
+    std::shared_ptr<MemoStats> memo;  // Set when calls are memoized
 };
 
 /**
  * @brief Function call
  */
 struct FunctionCallNode {
-    std::string name;
-    std::vector<ASTNode> arguments;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::FUNCTION_CALL;
+    
+    Symbol name;
+    NodeList arguments;
+    uint32_t line = 0;
+    bool is_say = false;  // "say" statement rather than a call
+    bool is_spawn = false;  // Starts the call as a task and yields its handle
+    VariableBinding binding;
+    CallSiteCache cache;
 };
 
 /**
  * @brief Return statement
  */
 struct ReturnNode {
-    ASTNode value;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::RETURN;
+    
+    NodeRef value;
+    uint32_t line = 0;
 };
 
 /**
  * @brief List literal
  */
 struct ListNode {
-    std::vector<ASTNode> elements;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::LIST;
+    
+    NodeList elements;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Dictionary literal
  */
 struct DictNode {
-    std::vector<std::pair<std::string, ASTNode>> entries;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::DICT;
+    
+    std::vector<std::pair<Symbol, NodeRef>> entries;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Index access (list[0], dict["key"])
  */
 struct IndexNode {
-    ASTNode object;
-    ASTNode index;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::INDEX;
+    
+    NodeRef object;
+    NodeRef index;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Property access (object.property)
  */
 struct PropertyAccessNode {
-    ASTNode object;
+    static constexpr NodeKind KIND = NodeKind::PROPERTY_ACCESS;
+    
+    NodeRef object;
     std::string property;
-    uint32_t line;
+    uint32_t line = 0;
 };
 
 /**
  * @brief Block of statements
  */
 struct BlockNode {
-    std::vector<ASTNode> statements;
-    uint32_t line;
+    static constexpr NodeKind KIND = NodeKind::BLOCK;
+    
+    NodeList statements;
+    uint32_t line = 0;
 };
 
 /**
  * @brief GUI command node
  */
 struct GUINode {
+    static constexpr NodeKind KIND = NodeKind::GUI;
+    
     enum class Command {
         CREATE_WINDOW,
         SET_TITLE,
@@ -273,9 +411,20 @@ struct GUINode {
     };
     
     Command command;
-    std::string target;  // window/widget name
-    std::vector<ASTNode> arguments;
-    uint32_t line;
+    Symbol target;  // window/widget name
+    NodeList arguments;
+    uint32_t line = 0;
+    VariableBinding binding;  // Where created widgets are defined
+};
+
+/**
+ * @brief "wait for" expression, yielding the result of a spawned task
+ */
+struct WaitNode {
+    static constexpr NodeKind KIND = NodeKind::WAIT;
+    
+    NodeRef task;
+    uint32_t line = 0;
 };
 
 } // namespace kaynat
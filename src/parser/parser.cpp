@@ -6,15 +6,19 @@
 #include "parser.hpp"
 #include "../errors/error_types.hpp"
 #include <algorithm>
+#include <stdexcept>
 
 namespace kaynat {
 
 Parser::Parser(std::vector<Token> tokens)
     : tokens_(std::move(tokens)), current_(0) {}
 
-std::shared_ptr<ProgramNode> Parser::parse() {
-    auto program = std::make_shared<ProgramNode>();
-    program->line = 1;
+std::shared_ptr<Ast> Parser::parse() {
+    ast_ = std::make_shared<Ast>();
+    
+    ProgramNode program{};
+    program.line = 1;
+    std::vector<NodeRef> statements;
     
     // Skip optional "begin program."
     if (match(TokenType::BEGIN)) {
@@ -29,10 +33,13 @@ std::shared_ptr<ProgramNode> Parser::parse() {
             break;
         }
         
-        program->statements.push_back(parse_statement());
+        statements.push_back(parse_statement());
     }
     
-    return program;
+    program.statements = ast_->add_list(statements);
+    ast_->set_root(ast_->add(std::move(program)));
+    
+    return std::move(ast_);
 }
 
 Token Parser::peek() const {
@@ -79,7 +86,7 @@ bool Parser::is_at_end() const {
     return peek().type == TokenType::END_OF_FILE;
 }
 
-ASTNode Parser::parse_statement() {
+NodeRef Parser::parse_statement() {
     // Comments: note. text. or note text.
     if (match(TokenType::NOTE)) {
         // Skip everything until we find a period
@@ -88,7 +95,7 @@ ASTNode Parser::parse_statement() {
         }
         consume(TokenType::PERIOD, "Expected '.' at end of comment");
         // Return empty statement
-        return ASTNode();
+        return NodeRef();
     }
     
     // GUI commands: set the title of... (check before regular set)
@@ -126,6 +133,11 @@ ASTNode Parser::parse_statement() {
         return parse_for_loop();
     }
     
+    // For-each loop
+    if (match(TokenType::FOR)) {
+        return parse_for_each();
+    }
+    
     // Function definition
     if (match(TokenType::DEFINE)) {
         return parse_function_def();
@@ -155,35 +167,35 @@ ASTNode Parser::parse_statement() {
     return parse_expression_statement();
 }
 
-ASTNode Parser::parse_assignment() {
+NodeRef Parser::parse_assignment() {
     bool is_constant = previous().type == TokenType::ALWAYS;
     
     Token name_token = consume(TokenType::IDENTIFIER, "Expected variable name");
     consume(TokenType::TO, "Expected 'to' after variable name");
     
-    ASTNode value = parse_expression();
+    NodeRef value = parse_expression();
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
     
-    auto node = std::make_shared<AssignmentNode>();
-    node->name = name_token.lexeme;
-    node->value = value;
-    node->is_constant = is_constant;
-    node->line = name_token.line;
+    AssignmentNode node{};
+    node.name = name_token.lexeme;
+    node.value = value;
+    node.is_constant = is_constant;
+    node.line = name_token.line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_if_statement() {
-    ASTNode condition = parse_expression();
+NodeRef Parser::parse_if_statement() {
+    NodeRef condition = parse_expression();
     consume(TokenType::THEN, "Expected 'then' after condition");
     consume(TokenType::PERIOD, "Expected '.' after 'then'");
     
-    std::vector<ASTNode> then_branch;
+    std::vector<NodeRef> then_branch;
     while (!check(TokenType::OTHERWISE) && !check(TokenType::END) && !is_at_end()) {
         then_branch.push_back(parse_statement());
     }
     
-    std::vector<ASTNode> else_branch;
+    std::vector<NodeRef> else_branch;
     if (match(TokenType::OTHERWISE)) {
         consume(TokenType::PERIOD, "Expected '.' after 'otherwise'");
         while (!check(TokenType::END) && !is_at_end()) {
@@ -194,20 +206,20 @@ ASTNode Parser::parse_if_statement() {
     consume(TokenType::END, "Expected 'end' to close if statement");
     consume(TokenType::PERIOD, "Expected '.' after 'end'");
     
-    auto node = std::make_shared<IfNode>();
-    node->condition = condition;
-    node->then_branch = then_branch;
-    node->else_branch = else_branch;
-    node->line = previous().line;
+    IfNode node{};
+    node.condition = condition;
+    node.then_branch = ast_->add_list(then_branch);
+    node.else_branch = ast_->add_list(else_branch);
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_while_loop() {
-    ASTNode condition = parse_expression();
+NodeRef Parser::parse_while_loop() {
+    NodeRef condition = parse_expression();
     consume(TokenType::PERIOD, "Expected '.' after condition");
     
-    std::vector<ASTNode> body;
+    std::vector<NodeRef> body;
     while (!check(TokenType::END) && !is_at_end()) {
         body.push_back(parse_statement());
     }
@@ -215,20 +227,20 @@ ASTNode Parser::parse_while_loop() {
     consume(TokenType::END, "Expected 'end' to close while loop");
     consume(TokenType::PERIOD, "Expected '.' after 'end'");
     
-    auto node = std::make_shared<WhileNode>();
-    node->condition = condition;
-    node->body = body;
-    node->line = previous().line;
+    WhileNode node{};
+    node.condition = condition;
+    node.body = ast_->add_list(body);
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_repeat_loop() {
-    ASTNode count = parse_expression();
+NodeRef Parser::parse_repeat_loop() {
+    NodeRef count = parse_expression();
     consume(TokenType::TIMES, "Expected 'times' after count");
     consume(TokenType::PERIOD, "Expected '.' after 'times'");
     
-    std::vector<ASTNode> body;
+    std::vector<NodeRef> body;
     while (!check(TokenType::END) && !is_at_end()) {
         body.push_back(parse_statement());
     }
@@ -236,22 +248,22 @@ ASTNode Parser::parse_repeat_loop() {
     consume(TokenType::END, "Expected 'end' to close repeat loop");
     consume(TokenType::PERIOD, "Expected '.' after 'end'");
     
-    auto node = std::make_shared<RepeatNode>();
-    node->count = count;
-    node->body = body;
-    node->line = previous().line;
+    RepeatNode node{};
+    node.count = count;
+    node.body = ast_->add_list(body);
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_for_loop() {
+NodeRef Parser::parse_for_loop() {
     consume(TokenType::FROM, "Expected 'from' in for loop");
-    ASTNode start = parse_expression();
+    parse_expression();
     consume(TokenType::TO, "Expected 'to' in for loop");
-    ASTNode end = parse_expression();
+    parse_expression();
     consume(TokenType::PERIOD, "Expected '.' after range");
     
-    std::vector<ASTNode> body;
+    std::vector<NodeRef> body;
     while (!check(TokenType::END) && !is_at_end()) {
         body.push_back(parse_statement());
     }
@@ -259,33 +271,82 @@ ASTNode Parser::parse_for_loop() {
     consume(TokenType::END, "Expected 'end' to close for loop");
     consume(TokenType::PERIOD, "Expected '.' after 'end'");
     
-    auto node = std::make_shared<WhileNode>();
-    node->body = body;
-    node->line = previous().line;
+    WhileNode node{};
+    node.body = ast_->add_list(body);
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_function_def() {
+NodeRef Parser::parse_for_each() {
+    const uint32_t line = previous().line;
+    consume(TokenType::EACH, "Expected 'each' after 'for'");
+    Token variable = consume(TokenType::IDENTIFIER, "Expected loop variable name");
+    consume(TokenType::IN, "Expected 'in' after loop variable");
+    NodeRef iterable = parse_expression();
+    
+    // Optional: "in parallel", then optional "and store as results"
+    bool parallel = false;
+    Symbol target;
+    const size_t saved = current_;
+    if (match(TokenType::IN) && check(TokenType::IDENTIFIER) && peek().lexeme == "parallel") {
+        advance();
+        parallel = true;
+        if (match(TokenType::AND)) {
+            consume(TokenType::STORE, "Expected 'store' after 'and'");
+            consume(TokenType::AS, "Expected 'as' after 'store'");
+            target = consume(TokenType::IDENTIFIER, "Expected variable name after 'as'").lexeme;
+        }
+    } else {
+        current_ = saved;
+    }
+    consume(TokenType::PERIOD, "Expected '.' after for-each header");
+    
+    std::vector<NodeRef> body;
+    while (!check(TokenType::END) && !is_at_end()) {
+        body.push_back(parse_statement());
+    }
+    
+    consume(TokenType::END, "Expected 'end' to close for-each loop");
+    consume(TokenType::PERIOD, "Expected '.' after 'end'");
+    
+    ForEachNode node{};
+    node.variable = variable.lexeme;
+    node.iterable = iterable;
+    node.body = ast_->add_list(body);
+    node.line = line;
+    node.parallel = parallel;
+    node.target = target;
+    
+    return ast_->add(std::move(node));
+}
+
+NodeRef Parser::parse_function_def() {
     match(TokenType::A);
     consume(TokenType::FUNCTION, "Expected 'function'");
     consume(TokenType::CALLED, "Expected 'called'");
     
     Token name_token = consume(TokenType::IDENTIFIER, "Expected function name");
     
-    std::vector<std::string> params;
+    std::vector<Symbol> params;
+    bool remember = false;
     if (match(TokenType::THAT)) {
         consume(TokenType::TAKES, "Expected 'takes' after 'that'");
         
         do {
             Token param = consume(TokenType::IDENTIFIER, "Expected parameter name");
             params.push_back(param.lexeme);
-        } while (match(TokenType::COMMA_PUNCT) || match(TokenType::AND));
+        } while (!(remember = match_remember_results()) &&
+                 (match(TokenType::COMMA_PUNCT) || match(TokenType::AND)));
+    }
+    
+    if (!remember) {
+        remember = match_remember_results();
     }
     
     consume(TokenType::PERIOD, "Expected '.' after function signature");
     
-    std::vector<ASTNode> body;
+    std::vector<NodeRef> body;
     while (!check(TokenType::END) && !is_at_end()) {
         body.push_back(parse_statement());
     }
@@ -293,308 +354,331 @@ ASTNode Parser::parse_function_def() {
     consume(TokenType::END, "Expected 'end' to close function");
     consume(TokenType::PERIOD, "Expected '.' after 'end'");
     
-    auto node = std::make_shared<FunctionDefNode>();
-    node->name = name_token.lexeme;
-    node->parameters = params;
-    node->body = body;
-    node->line = name_token.line;
+    FunctionDefNode node{};
+    node.name = name_token.lexeme;
+    node.parameters = params;
+    node.body = ast_->add_list(body);
+    node.line = name_token.line;
+    if (remember) {
+        node.memo = std::make_shared<MemoStats>();
+    }
     
-    return node;
+    return ast_->add(std::move(node));
+}
+
+bool Parser::match_remember_results() {
+    // Optional modifier ending a function signature: ", remember results"
+    size_t saved = current_;
+    if (!match(TokenType::COMMA_PUNCT)) {
+        match(TokenType::AND);
+    }
+    if (check(TokenType::IDENTIFIER) && peek().lexeme == "remember") {
+        advance();
+        if (check(TokenType::IDENTIFIER) && peek().lexeme == "results") {
+            advance();
+            return true;
+        }
+    }
+    current_ = saved;
+    return false;
 }
 
-ASTNode Parser::parse_return() {
+NodeRef Parser::parse_return() {
     consume(TokenType::BACK, "Expected 'back' after 'give'");
     
-    ASTNode value = parse_expression();
+    NodeRef value = parse_expression();
     consume(TokenType::PERIOD, "Expected '.' after return value");
     
-    auto node = std::make_shared<ReturnNode>();
-    node->value = value;
-    node->line = previous().line;
+    ReturnNode node{};
+    node.value = value;
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_expression_statement() {
-    ASTNode expr = parse_expression();
+NodeRef Parser::parse_expression_statement() {
+    NodeRef expr = parse_expression();
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
     return expr;
 }
 
-ASTNode Parser::parse_expression() {
+NodeRef Parser::parse_expression() {
     return parse_logical_or();
 }
 
-ASTNode Parser::parse_logical_or() {
-    ASTNode left = parse_logical_and();
+NodeRef Parser::parse_logical_or() {
+    NodeRef left = parse_logical_and();
     
     while (match(TokenType::OR)) {
-        ASTNode right = parse_logical_and();
+        NodeRef right = parse_logical_and();
         
-        auto node = std::make_shared<BinaryOpNode>();
-        node->op = BinaryOpNode::Op::OR;
-        node->left = left;
-        node->right = right;
-        node->line = previous().line;
+        BinaryOpNode node{};
+        node.op = BinaryOpNode::Op::OR;
+        node.left = left;
+        node.right = right;
+        node.line = previous().line;
         
-        left = node;
+        left = ast_->add(std::move(node));
     }
     
     return left;
 }
 
-ASTNode Parser::parse_logical_and() {
-    ASTNode left = parse_equality();
+NodeRef Parser::parse_logical_and() {
+    NodeRef left = parse_equality();
     
     while (match(TokenType::AND)) {
-        ASTNode right = parse_equality();
+        NodeRef right = parse_equality();
         
-        auto node = std::make_shared<BinaryOpNode>();
-        node->op = BinaryOpNode::Op::AND;
-        node->left = left;
-        node->right = right;
-        node->line = previous().line;
+        BinaryOpNode node{};
+        node.op = BinaryOpNode::Op::AND;
+        node.left = left;
+        node.right = right;
+        node.line = previous().line;
         
-        left = node;
+        left = ast_->add(std::move(node));
     }
     
     return left;
 }
 
-ASTNode Parser::parse_equality() {
-    ASTNode left = parse_comparison();
+NodeRef Parser::parse_equality() {
+    NodeRef left = parse_comparison();
     
     // "is equal to", "is not equal to"
     if (match(TokenType::IS)) {
         if (match(TokenType::NOT)) {
             match(TokenType::EQUAL);
             match(TokenType::TO);
-            ASTNode right = parse_comparison();
+            NodeRef right = parse_comparison();
             
-            auto node = std::make_shared<BinaryOpNode>();
-            node->op = BinaryOpNode::Op::NOT_EQUAL;
-            node->left = left;
-            node->right = right;
-            node->line = previous().line;
+            BinaryOpNode node{};
+            node.op = BinaryOpNode::Op::NOT_EQUAL;
+            node.left = left;
+            node.right = right;
+            node.line = previous().line;
             
-            return node;
+            return ast_->add(std::move(node));
         } else {
             match(TokenType::EQUAL);
             match(TokenType::TO);
-            ASTNode right = parse_comparison();
+            NodeRef right = parse_comparison();
             
-            auto node = std::make_shared<BinaryOpNode>();
-            node->op = BinaryOpNode::Op::EQUAL;
-            node->left = left;
-            node->right = right;
-            node->line = previous().line;
+            BinaryOpNode node{};
+            node.op = BinaryOpNode::Op::EQUAL;
+            node.left = left;
+            node.right = right;
+            node.line = previous().line;
             
-            return node;
+            return ast_->add(std::move(node));
         }
     }
     
     return left;
 }
 
-ASTNode Parser::parse_comparison() {
-    ASTNode left = parse_addition();
+NodeRef Parser::parse_comparison() {
+    NodeRef left = parse_addition();
     
     // "is greater than", "is less than"
     if (match(TokenType::IS)) {
         if (match(TokenType::GREATER)) {
             match(TokenType::THAN);
-            ASTNode right = parse_addition();
+            NodeRef right = parse_addition();
             
-            auto node = std::make_shared<BinaryOpNode>();
-            node->op = BinaryOpNode::Op::GREATER_THAN;
-            node->left = left;
-            node->right = right;
-            node->line = previous().line;
+            BinaryOpNode node{};
+            node.op = BinaryOpNode::Op::GREATER_THAN;
+            node.left = left;
+            node.right = right;
+            node.line = previous().line;
             
-            return node;
+            return ast_->add(std::move(node));
         } else if (match(TokenType::LESS)) {
             match(TokenType::THAN);
-            ASTNode right = parse_addition();
+            NodeRef right = parse_addition();
             
-            auto node = std::make_shared<BinaryOpNode>();
-            node->op = BinaryOpNode::Op::LESS_THAN;
-            node->left = left;
-            node->right = right;
-            node->line = previous().line;
+            BinaryOpNode node{};
+            node.op = BinaryOpNode::Op::LESS_THAN;
+            node.left = left;
+            node.right = right;
+            node.line = previous().line;
             
-            return node;
+            return ast_->add(std::move(node));
         }
     }
     
     return left;
 }
 
-ASTNode Parser::parse_addition() {
-    ASTNode left = parse_multiplication();
+NodeRef Parser::parse_addition() {
+    NodeRef left = parse_multiplication();
     
     while (match(TokenType::ADD) || match(TokenType::SUBTRACT)) {
         TokenType op_type = previous().type;
-        ASTNode right = parse_multiplication();
+        NodeRef right = parse_multiplication();
         
-        auto node = std::make_shared<BinaryOpNode>();
-        node->op = (op_type == TokenType::ADD) ? BinaryOpNode::Op::ADD : BinaryOpNode::Op::SUBTRACT;
-        node->left = left;
-        node->right = right;
-        node->line = previous().line;
+        BinaryOpNode node{};
+        node.op = (op_type == TokenType::ADD) ? BinaryOpNode::Op::ADD : BinaryOpNode::Op::SUBTRACT;
+        node.left = left;
+        node.right = right;
+        node.line = previous().line;
         
-        left = node;
+        left = ast_->add(std::move(node));
     }
     
     return left;
 }
 
-ASTNode Parser::parse_multiplication() {
-    ASTNode left = parse_unary();
+NodeRef Parser::parse_multiplication() {
+    NodeRef left = parse_unary();
     
     while (match(TokenType::MULTIPLY) || match(TokenType::DIVIDE)) {
         TokenType op_type = previous().type;
-        ASTNode right = parse_unary();
+        NodeRef right = parse_unary();
         
-        auto node = std::make_shared<BinaryOpNode>();
-        node->op = (op_type == TokenType::MULTIPLY) ? BinaryOpNode::Op::MULTIPLY : BinaryOpNode::Op::DIVIDE;
-        node->left = left;
-        node->right = right;
-        node->line = previous().line;
+        BinaryOpNode node{};
+        node.op = (op_type == TokenType::MULTIPLY) ? BinaryOpNode::Op::MULTIPLY : BinaryOpNode::Op::DIVIDE;
+        node.left = left;
+        node.right = right;
+        node.line = previous().line;
         
-        left = node;
+        left = ast_->add(std::move(node));
     }
     
     return left;
 }
 
-ASTNode Parser::parse_unary() {
+NodeRef Parser::parse_unary() {
     if (match(TokenType::NOT)) {
-        ASTNode operand = parse_unary();
+        NodeRef operand = parse_unary();
         
-        auto node = std::make_shared<UnaryOpNode>();
-        node->op = UnaryOpNode::Op::NOT;
-        node->operand = operand;
-        node->line = previous().line;
+        UnaryOpNode node{};
+        node.op = UnaryOpNode::Op::NOT;
+        node.operand = operand;
+        node.line = previous().line;
         
-        return node;
+        return ast_->add(std::move(node));
     }
     
     if (match(TokenType::NEGATIVE)) {
-        ASTNode operand = parse_unary();
+        NodeRef operand = parse_unary();
         
-        auto node = std::make_shared<UnaryOpNode>();
-        node->op = UnaryOpNode::Op::NEGATE;
-        node->operand = operand;
-        node->line = previous().line;
+        UnaryOpNode node{};
+        node.op = UnaryOpNode::Op::NEGATE;
+        node.operand = operand;
+        node.line = previous().line;
         
-        return node;
+        return ast_->add(std::move(node));
     }
     
     return parse_call();
 }
 
-ASTNode Parser::parse_call() {
+NodeRef Parser::parse_call() {
     // Function call: call func with arg1, arg2.
     if (match(TokenType::CALL)) {
-        Token name_token = consume(TokenType::IDENTIFIER, "Expected function name");
-        
-        std::vector<ASTNode> args;
-        if (match(TokenType::WITH)) {
-            do {
-                args.push_back(parse_primary());
-            } while (match(TokenType::COMMA_PUNCT) || match(TokenType::AND));
-        }
-        
-        // Optional: "and store as result"
-        if (match(TokenType::AND)) {
-            match(TokenType::STORE);
-            match(TokenType::AS);
-            match(TokenType::IDENTIFIER);
+        return finish_call(false);
+    }
+    
+    // Task: spawn func with arg1, arg2.
+    if (match(TokenType::SPAWN)) {
+        return finish_call(true);
+    }
+    
+    // Join a task: wait for handle [to finish].
+    if (match(TokenType::WAIT)) {
+        const uint32_t line = previous().line;
+        consume(TokenType::FOR, "Expected 'for' after 'wait'");
+        NodeRef task = parse_call();
+        if (match(TokenType::TO)) {
+            consume(TokenType::FINISH, "Expected 'finish' after 'to'");
         }
         
-        auto node = std::make_shared<FunctionCallNode>();
-        node->name = name_token.lexeme;
-        node->arguments = args;
-        node->line = name_token.line;
+        WaitNode node{};
+        node.task = task;
+        node.line = line;
         
-        return node;
+        return ast_->add(std::move(node));
     }
     
     // Say statement: say x.
     if (match(TokenType::SAY) || match(TokenType::PRINT) || match(TokenType::SHOW)) {
-        std::vector<ASTNode> args;
+        std::vector<NodeRef> args;
         
         do {
             args.push_back(parse_primary());
         } while (match(TokenType::COMMA_PUNCT));
         
-        auto node = std::make_shared<FunctionCallNode>();
-        node->name = "say";
-        node->arguments = args;
-        node->line = previous().line;
+        FunctionCallNode node{};
+        node.name = "say";
+        node.is_say = true;
+        node.arguments = ast_->add_list(args);
+        node.line = previous().line;
         
-        return node;
+        return ast_->add(std::move(node));
     }
     
     return parse_primary();
 }
 
-ASTNode Parser::parse_primary() {
+NodeRef Parser::finish_call(bool is_spawn) {
+    Token name_token = consume(TokenType::IDENTIFIER, "Expected function name");
+    
+    std::vector<NodeRef> args;
+    if (match(TokenType::WITH)) {
+        do {
+            args.push_back(parse_primary());
+        } while (match(TokenType::COMMA_PUNCT) || match(TokenType::AND));
+    }
+    
+    // Optional: "and store as result"
+    if (match(TokenType::AND)) {
+        match(TokenType::STORE);
+        match(TokenType::AS);
+        match(TokenType::IDENTIFIER);
+    }
+    
+    FunctionCallNode node{};
+    node.name = name_token.lexeme;
+    node.arguments = ast_->add_list(args);
+    node.line = name_token.line;
+    node.is_spawn = is_spawn;
+    
+    return ast_->add(std::move(node));
+}
+
+NodeRef Parser::parse_primary() {
     // Literals
     if (match(TokenType::TRUE)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::BOOLEAN;
-        node->value = "true";
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::BOOLEAN, previous());
     }
     
     if (match(TokenType::FALSE)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::BOOLEAN;
-        node->value = "false";
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::BOOLEAN, previous());
     }
     
     if (match(TokenType::NOTHING)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::NULL_VALUE;
-        node->value = "null";
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::NULL_VALUE, previous());
     }
     
     if (match(TokenType::INTEGER)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::INTEGER;
-        node->value = previous().lexeme;
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::INTEGER, previous());
     }
     
     if (match(TokenType::FLOAT)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::FLOAT;
-        node->value = previous().lexeme;
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::FLOAT, previous());
     }
     
     if (match(TokenType::STRING)) {
-        auto node = std::make_shared<LiteralNode>();
-        node->type = LiteralNode::Type::STRING;
-        node->value = previous().lexeme;
-        node->line = previous().line;
-        return node;
+        return make_literal(LiteralNode::Type::STRING, previous());
     }
     
     // Identifier
     if (match(TokenType::IDENTIFIER)) {
-        auto node = std::make_shared<IdentifierNode>();
-        node->name = previous().lexeme;
-        node->line = previous().line;
-        return node;
+        IdentifierNode node{};
+        node.name = previous().lexeme;
+        node.line = previous().line;
+        return ast_->add(std::move(node));
     }
     
     // List literal
@@ -608,19 +692,59 @@ ASTNode Parser::parse_primary() {
     throw ParserError("Unexpected token: " + current.lexeme, current.line, current.column);
 }
 
-ASTNode Parser::parse_list_literal() {
+NodeRef Parser::make_literal(LiteralNode::Type type, const Token& token) {
+    LiteralNode node{};
+    node.type = type;
+    node.value = token.lexeme;
+    node.line = token.line;
+    
+    // Decode once here so evaluation never re-parses the source text
+    switch (type) {
+        case LiteralNode::Type::INTEGER:
+            try {
+                node.constant = KaynatValue(static_cast<int64_t>(std::stoll(token.lexeme)));
+            } catch (const std::out_of_range&) {
+                // Integers that do not fit in 64 bits become BigInts
+                node.constant = KaynatValue(BigInt(token.lexeme));
+            }
+            break;
+        
+        case LiteralNode::Type::FLOAT:
+            try {
+                node.constant = KaynatValue(std::stod(token.lexeme));
+            } catch (const std::out_of_range&) {
+                throw ParserError("Float literal out of range: " + token.lexeme, token.line, token.column);
+            }
+            break;
+        
+        case LiteralNode::Type::STRING:
+            node.constant = KaynatValue(token.lexeme);
+            break;
+        
+        case LiteralNode::Type::BOOLEAN:
+            node.constant = KaynatValue(token.type == TokenType::TRUE);
+            break;
+        
+        case LiteralNode::Type::NULL_VALUE:
+            break;
+    }
+    
+    return ast_->add(std::move(node));
+}
+
+NodeRef Parser::parse_list_literal() {
     consume(TokenType::CONTAINING, "Expected 'containing' in list literal");
     
-    std::vector<ASTNode> elements;
+    std::vector<NodeRef> elements;
     do {
         elements.push_back(parse_primary());
     } while (match(TokenType::COMMA_PUNCT) || match(TokenType::AND));
     
-    auto node = std::make_shared<ListNode>();
-    node->elements = elements;
-    node->line = previous().line;
+    ListNode node{};
+    node.elements = ast_->add_list(elements);
+    node.line = previous().line;
     
-    return node;
+    return ast_->add(std::move(node));
 }
 
 bool Parser::peek_ahead_for_gui() {
@@ -635,123 +759,121 @@ bool Parser::peek_ahead_for_gui() {
     return is_gui;
 }
 
-ASTNode Parser::parse_gui_command() {
+NodeRef Parser::parse_gui_command() {
     // create a window/label/button/input called name
     match(TokenType::A);
     
-    auto node = std::make_shared<GUINode>();
-    node->line = previous().line;
+    GUINode node{};
+    node.line = previous().line;
     
     if (match(TokenType::WINDOW)) {
-        node->command = GUINode::Command::CREATE_WINDOW;
+        node.command = GUINode::Command::CREATE_WINDOW;
         consume(TokenType::CALLED, "Expected 'called' after 'window'");
         Token name = consume(TokenType::IDENTIFIER, "Expected window name");
-        node->target = name.lexeme;
+        node.target = name.lexeme;
     }
     else if (match(TokenType::LABEL)) {
-        node->command = GUINode::Command::CREATE_LABEL;
+        node.command = GUINode::Command::CREATE_LABEL;
         consume(TokenType::CALLED, "Expected 'called' after 'label'");
         Token name = consume(TokenType::IDENTIFIER, "Expected label name");
-        node->target = name.lexeme;
+        node.target = name.lexeme;
     }
     else if (match(TokenType::BUTTON)) {
-        node->command = GUINode::Command::CREATE_BUTTON;
+        node.command = GUINode::Command::CREATE_BUTTON;
         consume(TokenType::CALLED, "Expected 'called' after 'button'");
         Token name = consume(TokenType::IDENTIFIER, "Expected button name");
-        node->target = name.lexeme;
+        node.target = name.lexeme;
     }
     else if (check(TokenType::TEXT)) {
         match(TokenType::TEXT);
         match(TokenType::INPUT);
-        node->command = GUINode::Command::CREATE_INPUT;
+        node.command = GUINode::Command::CREATE_INPUT;
         consume(TokenType::CALLED, "Expected 'called' after 'input'");
         Token name = consume(TokenType::IDENTIFIER, "Expected input name");
-        node->target = name.lexeme;
+        node.target = name.lexeme;
     }
     
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_gui_set_command() {
+NodeRef Parser::parse_gui_set_command() {
     // set the title/width/height/text/placeholder of widget to value
     consume(TokenType::SET, "Expected 'set'");
     consume(TokenType::THE, "Expected 'the'");
     
-    auto node = std::make_shared<GUINode>();
-    node->line = previous().line;
+    GUINode node{};
+    node.line = previous().line;
     
     if (match(TokenType::TITLE)) {
-        node->command = GUINode::Command::SET_TITLE;
+        node.command = GUINode::Command::SET_TITLE;
     }
     else if (match(TokenType::WIDTH)) {
-        node->command = GUINode::Command::SET_WIDTH;
+        node.command = GUINode::Command::SET_WIDTH;
     }
     else if (match(TokenType::HEIGHT)) {
-        node->command = GUINode::Command::SET_HEIGHT;
+        node.command = GUINode::Command::SET_HEIGHT;
     }
     else if (match(TokenType::BACKGROUND)) {
-        node->command = GUINode::Command::SET_BACKGROUND;
+        node.command = GUINode::Command::SET_BACKGROUND;
     }
     else if (match(TokenType::TEXT)) {
-        node->command = GUINode::Command::SET_TEXT;
+        node.command = GUINode::Command::SET_TEXT;
     }
     else if (match(TokenType::PLACEHOLDER)) {
-        node->command = GUINode::Command::SET_PLACEHOLDER;
+        node.command = GUINode::Command::SET_PLACEHOLDER;
     }
     
     consume(TokenType::OF, "Expected 'of'");
     Token target = consume(TokenType::IDENTIFIER, "Expected widget name");
-    node->target = target.lexeme;
+    node.target = target.lexeme;
     
     consume(TokenType::TO, "Expected 'to'");
-    node->arguments.push_back(parse_expression());
+    node.arguments = ast_->add_list({parse_expression()});
     
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_gui_show() {
+NodeRef Parser::parse_gui_show() {
     // show window_name
     Token name = consume(TokenType::IDENTIFIER, "Expected window name");
     
-    auto node = std::make_shared<GUINode>();
-    node->command = GUINode::Command::SHOW_WINDOW;
-    node->target = name.lexeme;
-    node->line = previous().line;
+    GUINode node{};
+    node.command = GUINode::Command::SHOW_WINDOW;
+    node.target = name.lexeme;
+    node.line = previous().line;
     
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
-    return node;
+    return ast_->add(std::move(node));
 }
 
-ASTNode Parser::parse_gui_place() {
+NodeRef Parser::parse_gui_place() {
     // place widget at row X and column Y in window
     Token widget = consume(TokenType::IDENTIFIER, "Expected widget name");
     
-    auto node = std::make_shared<GUINode>();
-    node->command = GUINode::Command::PLACE_WIDGET;
-    node->target = widget.lexeme;
-    node->line = previous().line;
+    GUINode node{};
+    node.command = GUINode::Command::PLACE_WIDGET;
+    node.target = widget.lexeme;
+    node.line = previous().line;
     
+    std::vector<NodeRef> args;
     consume(TokenType::AT, "Expected 'at'");
     consume(TokenType::ROW, "Expected 'row'");
-    node->arguments.push_back(parse_primary());
+    args.push_back(parse_primary());
     
     consume(TokenType::AND, "Expected 'and'");
     consume(TokenType::COLUMN, "Expected 'column'");
-    node->arguments.push_back(parse_primary());
+    args.push_back(parse_primary());
     
     consume(TokenType::IN, "Expected 'in'");
     Token window = consume(TokenType::IDENTIFIER, "Expected window name");
     
-    auto window_lit = std::make_shared<LiteralNode>();
-    window_lit->type = LiteralNode::Type::STRING;
-    window_lit->value = window.lexeme;
-    window_lit->line = window.line;
-    node->arguments.push_back(window_lit);
+    args.push_back(make_literal(LiteralNode::Type::STRING, window));
+    node.arguments = ast_->add_list(args);
     
     consume(TokenType::PERIOD, "Expected '.' at end of statement");
-    return node;
+    return ast_->add(std::move(node));
 }
 
 } // namespace kaynat
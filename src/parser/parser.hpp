@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include "nodes.hpp"
+#include "ast.hpp"
 #include "../lexer/token_types.hpp"
 #include <vector>
 #include <memory>
@@ -30,13 +30,14 @@ public:
     
     /**
      * @brief Parse tokens into AST
-     * @return Root program node
+     * @return Program arena, rooted at a ProgramNode
      */
-    std::shared_ptr<ProgramNode> parse();
+    std::shared_ptr<Ast> parse();
     
 private:
     std::vector<Token> tokens_;
     size_t current_;
+    std::shared_ptr<Ast> ast_;  // Program being built
     
     // Utility methods
     Token peek() const;
@@ -49,35 +50,39 @@ private:
     bool is_at_end() const;
     
     // Parsing methods
-    ASTNode parse_statement();
-    ASTNode parse_assignment();
-    ASTNode parse_if_statement();
-    ASTNode parse_while_loop();
-    ASTNode parse_repeat_loop();
-    ASTNode parse_for_loop();
-    ASTNode parse_function_def();
-    ASTNode parse_return();
-    ASTNode parse_expression_statement();
+    NodeRef parse_statement();
+    NodeRef parse_assignment();
+    NodeRef parse_if_statement();
+    NodeRef parse_while_loop();
+    NodeRef parse_repeat_loop();
+    NodeRef parse_for_loop();
+    NodeRef parse_for_each();
+    NodeRef parse_function_def();
+    NodeRef parse_return();
+    NodeRef parse_expression_statement();
     
     // Expression parsing
-    ASTNode parse_expression();
-    ASTNode parse_logical_or();
-    ASTNode parse_logical_and();
-    ASTNode parse_equality();
-    ASTNode parse_comparison();
-    ASTNode parse_addition();
-    ASTNode parse_multiplication();
-    ASTNode parse_unary();
-    ASTNode parse_call();
-    ASTNode parse_primary();
+    NodeRef parse_expression();
+    NodeRef parse_logical_or();
+    NodeRef parse_logical_and();
+    NodeRef parse_equality();
+    NodeRef parse_comparison();
+    NodeRef parse_addition();
+    NodeRef parse_multiplication();
+    NodeRef parse_unary();
+    NodeRef parse_call();
+    NodeRef finish_call(bool is_spawn);
+    NodeRef parse_primary();
     
     // Helper methods
-    ASTNode parse_list_literal();
+    NodeRef make_literal(LiteralNode::Type type, const Token& token);
+    NodeRef parse_list_literal();
     bool peek_ahead_for_gui();
-    ASTNode parse_gui_command();
-    ASTNode parse_gui_set_command();
-    ASTNode parse_gui_show();
-    ASTNode parse_gui_place();
+    bool match_remember_results();
+    NodeRef parse_gui_command();
+    NodeRef parse_gui_set_command();
+    NodeRef parse_gui_show();
+    NodeRef parse_gui_place();
 };
 
 } // namespace kaynat
@@ -4,21 +4,47 @@
  */
 
 #include "repl.hpp"
+#include "isolate.hpp"
 #include "lexer/lexer.hpp"
 #include "parser/parser.hpp"
-#include "interpreter/interpreter.hpp"
 #include "errors/error_types.hpp"
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <sstream>
 
 namespace kaynat {
 
-void run_repl() {
+namespace {
+
+/**
+ * @brief Read a whole program file
+ * @throws FileError if the file is missing or empty
+ */
+std::string read_source(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw FileError(filename, "file not found", 0, 0);
+    }
+    
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    std::string source = buffer.str();
+    
+    if (source.empty()) {
+        throw FileError(filename, "file is empty", 0, 0);
+    }
+    return source;
+}
+
+} // namespace
+
+
+void run_repl(const RunOptions& options) {
     std::cout << "Kaynat++ REPL v1.0.0\n";
     std::cout << "Type 'exit' to quit, 'help' for help\n\n";
     
-    Interpreter interpreter;
+    Engine engine(options, true);
     std::string line;
     
     while (true) {
@@ -70,7 +96,7 @@ void run_repl() {
             auto ast = parser.parse();
             
             // Execute
-            KaynatValue result = interpreter.execute(ast);
+            KaynatValue result = engine.execute(ast);
             
             // Print result if not null
             if (!result.is_null()) {
@@ -85,19 +111,8 @@ void run_repl() {
     }
 }
 
-void run_file(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw FileError(filename, "file not found", 0, 0);
-    }
-    
-    std::ostringstream buffer;
-    buffer << file.rdbuf();
-    const std::string source = buffer.str();
-    
-    if (source.empty()) {
-        throw FileError(filename, "file is empty", 0, 0);
-    }
+void run_file(const std::string& filename, const RunOptions& options) {
+    const std::string source = read_source(filename);
     
     try {
         // Lex
@@ -109,8 +124,8 @@ void run_file(const std::string& filename) {
         auto ast = parser.parse();
         
         // Execute
-        Interpreter interpreter;
-        interpreter.execute(ast);
+        Engine engine(options, false);
+        engine.execute(ast);
         
     } catch (const KaynatError& e) {
         std::cerr << e.formatted_message() << "\n";
@@ -118,4 +133,28 @@ void run_file(const std::string& filename) {
     }
 }
 
+bool run_files(const std::vector<std::string>& filenames, const RunOptions& options) {
+    std::vector<std::unique_ptr<Isolate>> isolates;
+    for (const std::string& filename : filenames) {
+        isolates.push_back(std::make_unique<Isolate>(read_source(filename), options));
+    }
+    for (auto& isolate : isolates) {
+        isolate->start();
+    }
+    
+    bool succeeded = true;
+    for (size_t i = 0; i < isolates.size(); ++i) {
+        try {
+            isolates[i]->join();
+        } catch (const KaynatError& e) {
+            std::cerr << filenames[i] << ": " << e.formatted_message() << "\n";
+            succeeded = false;
+        } catch (const std::exception& e) {
+            std::cerr << filenames[i] << ": Error: " << e.what() << "\n";
+            succeeded = false;
+        }
+    }
+    return succeeded;
+}
+
 } // namespace kaynat
@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include "engine.hpp"
 #include <string>
+#include <vector>
 
 namespace kaynat {
 
@@ -21,16 +23,31 @@ namespace kaynat {
  * - exit: Exit the REPL
  * - help: Show help message
  * - clear: Clear the screen
+ * 
+ * @param options Execution engine options
  */
-void run_repl();
+void run_repl(const RunOptions& options = {});
 
 /**
  * @brief Execute a Kaynat++ source file
  * @param filename Path to .kn file
+ * @param options Execution engine options
  * 
  * Reads, parses, and executes a complete Kaynat++ program from file.
  * Throws KaynatError on compilation or runtime errors.
  */
-void run_file(const std::string& filename);
+void run_file(const std::string& filename, const RunOptions& options = {});
+
+/**
+ * @brief Execute several Kaynat++ source files at the same time
+ * @param filenames Paths to .kn files
+ * @param options Execution engine options
+ * @return Whether every program ran without errors
+ * 
+ * Each program runs in an Isolate of its own. Errors are reported on
+ * stderr, prefixed with the file name; a missing or empty file throws
+ * FileError before any program starts.
+ */
+bool run_files(const std::vector<std::string>& filenames, const RunOptions& options = {});
 
 } // namespace kaynat
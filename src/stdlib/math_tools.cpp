@@ -4,10 +4,14 @@
  */
 
 #include "stdlib.hpp"
+#include "number_theory.hpp"
 #include "../errors/error_types.hpp"
 #include <cmath>
 #include <algorithm>
+#include <mutex>
+#include <optional>
 #include <random>
+#include <string>
 
 namespace kaynat {
 namespace stdlib {
@@ -24,67 +28,97 @@ static int64_t get_int(const KaynatValue& val) {
     throw TypeError("Integer", val.type_name(), 0, 0);
 }
 
-KaynatValue math_sqrt(const std::vector<KaynatValue>& args) {
+static BigInt get_integer(const KaynatValue& val) {
+    if (auto* big = val.as_bigint_ptr()) return *big;
+    return BigInt(get_int(val));
+}
+
+KaynatValue math_sqrt(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("sqrt expects 1 argument", 0, 0);
     return KaynatValue(std::sqrt(get_number(args[0])));
 }
 
-KaynatValue math_pow(const std::vector<KaynatValue>& args) {
+static std::optional<int64_t> int_power(int64_t base, uint64_t exponent) {
+    int64_t result = 1;
+    for (;;) {
+        if ((exponent & 1) && __builtin_mul_overflow(result, base, &result)) return std::nullopt;
+        exponent >>= 1;
+        if (exponent == 0) return result;
+        if (__builtin_mul_overflow(base, base, &base)) return std::nullopt;
+    }
+}
+
+KaynatValue math_pow(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("pow expects 2 arguments", 0, 0);
+    
+    // Integers to non-negative integer powers are exact
+    const int64_t* exponent = args[1].as_int_ptr();
+    if (exponent && *exponent >= 0) {
+        if (const int64_t* base = args[0].as_int_ptr()) {
+            if (auto result = int_power(*base, static_cast<uint64_t>(*exponent))) {
+                return KaynatValue(*result);
+            }
+            return KaynatValue(number_theory::power(BigInt(*base), static_cast<uint64_t>(*exponent)));
+        }
+        if (const BigInt* base = args[0].as_bigint_ptr()) {
+            return KaynatValue::integer(number_theory::power(*base, static_cast<uint64_t>(*exponent)));
+        }
+    }
+    
     return KaynatValue(std::pow(get_number(args[0]), get_number(args[1])));
 }
 
-KaynatValue math_abs(const std::vector<KaynatValue>& args) {
+KaynatValue math_abs(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("abs expects 1 argument", 0, 0);
     return KaynatValue(std::abs(get_number(args[0])));
 }
 
-KaynatValue math_floor(const std::vector<KaynatValue>& args) {
+KaynatValue math_floor(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("floor expects 1 argument", 0, 0);
     return KaynatValue(std::floor(get_number(args[0])));
 }
 
-KaynatValue math_ceil(const std::vector<KaynatValue>& args) {
+KaynatValue math_ceil(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("ceil expects 1 argument", 0, 0);
     return KaynatValue(std::ceil(get_number(args[0])));
 }
 
-KaynatValue math_round(const std::vector<KaynatValue>& args) {
+KaynatValue math_round(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("round expects 1 argument", 0, 0);
     return KaynatValue(std::round(get_number(args[0])));
 }
 
-KaynatValue math_sin(const std::vector<KaynatValue>& args) {
+KaynatValue math_sin(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("sin expects 1 argument", 0, 0);
     return KaynatValue(std::sin(get_number(args[0])));
 }
 
-KaynatValue math_cos(const std::vector<KaynatValue>& args) {
+KaynatValue math_cos(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("cos expects 1 argument", 0, 0);
     return KaynatValue(std::cos(get_number(args[0])));
 }
 
-KaynatValue math_tan(const std::vector<KaynatValue>& args) {
+KaynatValue math_tan(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("tan expects 1 argument", 0, 0);
     return KaynatValue(std::tan(get_number(args[0])));
 }
 
-KaynatValue math_log(const std::vector<KaynatValue>& args) {
+KaynatValue math_log(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("log expects 1 argument", 0, 0);
     return KaynatValue(std::log(get_number(args[0])));
 }
 
-KaynatValue math_log10(const std::vector<KaynatValue>& args) {
+KaynatValue math_log10(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("log10 expects 1 argument", 0, 0);
     return KaynatValue(std::log10(get_number(args[0])));
 }
 
-KaynatValue math_exp(const std::vector<KaynatValue>& args) {
+KaynatValue math_exp(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("exp expects 1 argument", 0, 0);
     return KaynatValue(std::exp(get_number(args[0])));
 }
 
-KaynatValue math_min(const std::vector<KaynatValue>& args) {
+KaynatValue math_min(ArgSpan args) {
     if (args.empty()) throw RuntimeError("min expects at least 1 argument", 0, 0);
     double min_val = get_number(args[0]);
     for (size_t i = 1; i < args.size(); ++i) {
@@ -93,7 +127,7 @@ KaynatValue math_min(const std::vector<KaynatValue>& args) {
     return KaynatValue(min_val);
 }
 
-KaynatValue math_max(const std::vector<KaynatValue>& args) {
+KaynatValue math_max(ArgSpan args) {
     if (args.empty()) throw RuntimeError("max expects at least 1 argument", 0, 0);
     double max_val = get_number(args[0]);
     for (size_t i = 1; i < args.size(); ++i) {
@@ -102,18 +136,30 @@ KaynatValue math_max(const std::vector<KaynatValue>& args) {
     return KaynatValue(max_val);
 }
 
-KaynatValue math_factorial(const std::vector<KaynatValue>& args) {
+KaynatValue math_factorial(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("factorial expects 1 argument", 0, 0);
     int64_t n = get_int(args[0]);
     if (n < 0) throw RuntimeError("factorial requires non-negative integer", 0, 0);
     int64_t result = 1;
     for (int64_t i = 2; i <= n; ++i) {
-        result *= i;
+        // Past 20! the product no longer fits in 64 bits
+        if (__builtin_mul_overflow(result, i, &result)) {
+            return KaynatValue(number_theory::factorial(static_cast<uint64_t>(n)));
+        }
     }
     return KaynatValue(result);
 }
 
-KaynatValue math_gcd(const std::vector<KaynatValue>& args) {
+KaynatValue math_binomial(ArgSpan args) {
+    if (args.size() != 2) throw RuntimeError("binomial expects 2 arguments", 0, 0);
+    int64_t n = get_int(args[0]);
+    int64_t k = get_int(args[1]);
+    if (n < 0) throw RuntimeError("binomial requires non-negative integer", 0, 0);
+    if (k < 0 || k > n) return KaynatValue(static_cast<int64_t>(0));
+    return KaynatValue::integer(number_theory::binomial(static_cast<uint64_t>(n), static_cast<uint64_t>(k)));
+}
+
+KaynatValue math_gcd(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("gcd expects 2 arguments", 0, 0);
     int64_t a = std::abs(get_int(args[0]));
     int64_t b = std::abs(get_int(args[1]));
@@ -125,7 +171,7 @@ KaynatValue math_gcd(const std::vector<KaynatValue>& args) {
     return KaynatValue(a);
 }
 
-KaynatValue math_lcm(const std::vector<KaynatValue>& args) {
+KaynatValue math_lcm(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("lcm expects 2 arguments", 0, 0);
     int64_t a = std::abs(get_int(args[0]));
     int64_t b = std::abs(get_int(args[1]));
@@ -143,31 +189,80 @@ KaynatValue math_lcm(const std::vector<KaynatValue>& args) {
     return KaynatValue((a / gcd_val) * b);
 }
 
-KaynatValue math_is_prime(const std::vector<KaynatValue>& args) {
+KaynatValue math_is_prime(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("is_prime expects 1 argument", 0, 0);
+    if (auto* big = args[0].as_bigint_ptr()) {
+        return KaynatValue(number_theory::is_probable_prime(*big));
+    }
     int64_t n = get_int(args[0]);
-    if (n < 2) return KaynatValue(false);
-    if (n == 2) return KaynatValue(true);
-    if (n % 2 == 0) return KaynatValue(false);
+    return KaynatValue(n > 1 && number_theory::is_prime(static_cast<uint64_t>(n)));
+}
+
+KaynatValue math_pow_mod(ArgSpan args) {
+    if (args.size() != 3) throw RuntimeError("pow_mod expects 3 arguments", 0, 0);
+    const int64_t* base = args[0].as_int_ptr();
+    const int64_t* exponent = args[1].as_int_ptr();
+    const int64_t* modulus = args[2].as_int_ptr();
+    
+    // Machine-word fast path; the result lies in [0, |modulus|)
+    if (base && exponent && modulus && *exponent >= 0 && *modulus != 0) {
+        uint64_t m = *modulus < 0 ? 0 - static_cast<uint64_t>(*modulus) : static_cast<uint64_t>(*modulus);
+        uint64_t b = *base < 0 ? (m - (0 - static_cast<uint64_t>(*base)) % m) % m
+                               : static_cast<uint64_t>(*base) % m;
+        uint64_t result = number_theory::pow_mod(b, static_cast<uint64_t>(*exponent), m);
+        return KaynatValue(static_cast<int64_t>(result));
+    }
     
-    for (int64_t i = 3; i * i <= n; i += 2) {
-        if (n % i == 0) return KaynatValue(false);
+    BigInt big_exponent = get_integer(args[1]);
+    BigInt big_modulus = get_integer(args[2]);
+    if (big_exponent.is_negative()) throw RuntimeError("pow_mod requires non-negative exponent", 0, 0);
+    if (big_modulus.is_zero()) throw DivisionByZeroError(0, 0);
+    return KaynatValue::integer(BigInt::pow_mod(get_integer(args[0]), big_exponent, big_modulus));
+}
+
+KaynatValue math_primes_up_to(ArgSpan args) {
+    if (args.size() != 1) throw RuntimeError("primes_up_to expects 1 argument", 0, 0);
+    int64_t limit = get_int(args[0]);
+    if (limit < 2) return KaynatValue(ListType());
+    if (static_cast<uint64_t>(limit) > number_theory::MAX_PRIMES_LIMIT) {
+        throw RuntimeError("primes_up_to limit must be at most " +
+                           std::to_string(number_theory::MAX_PRIMES_LIMIT) +
+                           ", since a longer list of primes would not fit in memory", 0, 0);
     }
-    return KaynatValue(true);
+    return KaynatValue(number_theory::primes_up_to(static_cast<uint64_t>(limit)));
 }
 
-KaynatValue math_random(const std::vector<KaynatValue>& args) {
+KaynatValue math_prime_count(ArgSpan args) {
+    if (args.size() != 1) throw RuntimeError("prime_count expects 1 argument", 0, 0);
+    int64_t limit = get_int(args[0]);
+    if (limit < 2) return KaynatValue(static_cast<int64_t>(0));
+    return KaynatValue(static_cast<int64_t>(number_theory::prime_count(static_cast<uint64_t>(limit))));
+}
+
+KaynatValue math_random(ArgSpan args) {
     if (!args.empty()) throw RuntimeError("random expects 0 arguments", 0, 0);
     static std::random_device rd;
     static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
+    static std::mutex gen_mutex;  // Parallel loops share the generator
+    std::uniform_real_distribution<> dis(0.0, 1.0);
+    std::lock_guard<std::mutex> lock(gen_mutex);
     return KaynatValue(dis(gen));
 }
 
-KaynatValue math_pi(const std::vector<KaynatValue>& args) {
+KaynatValue math_pi(ArgSpan args) {
     if (!args.empty()) throw RuntimeError("pi expects 0 arguments", 0, 0);
     return KaynatValue(M_PI);
 }
 
+KaynatValue math_to_hex(ArgSpan args) {
+    if (args.size() != 1) throw RuntimeError("to_hex expects 1 argument", 0, 0);
+    return KaynatValue(get_integer(args[0]).to_string(16));
+}
+
+KaynatValue math_to_binary(ArgSpan args) {
+    if (args.size() != 1) throw RuntimeError("to_binary expects 1 argument", 0, 0);
+    return KaynatValue(get_integer(args[0]).to_string(2));
+}
+
 } // namespace stdlib
 } // namespace kaynat
@@ -0,0 +1,313 @@
+/**
+ * @file number_theory.cpp
+ * @brief Number theory and exact combinatorics kernels
+ */
+
+#include "number_theory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace kaynat {
+namespace number_theory {
+
+namespace {
+
+__extension__ typedef unsigned __int128 Wide;
+
+// Bases that make Miller-Rabin exact below 3.3 * 10^24
+constexpr uint64_t WITNESSES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+// Sieve segments fit one L1 data cache; each byte stands for an odd number
+constexpr uint64_t SEGMENT_BYTES = 32 * 1024;
+
+/**
+ * @brief Arithmetic modulo an odd 64-bit n in Montgomery form (R = 2^64)
+ */
+class Montgomery64 {
+public:
+    explicit Montgomery64(uint64_t modulus) : modulus_(modulus) {
+        // Newton iteration doubles the correct low bits of n^-1 mod 2^64;
+        // n is its own inverse modulo 8
+        inverse_ = modulus;
+        for (int i = 0; i < 5; ++i) inverse_ *= 2 - modulus * inverse_;
+
+        uint64_t r = static_cast<uint64_t>((static_cast<Wide>(1) << 64) % modulus);
+        r_squared_ = static_cast<uint64_t>(static_cast<Wide>(r) * r % modulus);
+    }
+
+    uint64_t to_form(uint64_t a) const { return reduce(static_cast<Wide>(a % modulus_) * r_squared_); }
+    uint64_t from_form(uint64_t a) const { return reduce(a); }
+    uint64_t product(uint64_t a, uint64_t b) const { return reduce(static_cast<Wide>(a) * b); }
+
+    uint64_t power(uint64_t base, uint64_t exponent) const {
+        uint64_t result = to_form(1);
+        for (; exponent > 0; exponent >>= 1) {
+            if (exponent & 1) result = product(result, base);
+            base = product(base, base);
+        }
+        return result;
+    }
+
+private:
+    uint64_t modulus_;
+    uint64_t inverse_;    // n^-1 mod 2^64
+    uint64_t r_squared_;  // R^2 mod n
+
+    /**
+     * @brief t / R mod n for t < n R
+     */
+    uint64_t reduce(Wide t) const {
+        // t - m n has zero low half, so its high half is the exact quotient
+        const uint64_t m = static_cast<uint64_t>(t) * inverse_;
+        const uint64_t high = static_cast<uint64_t>(t >> 64);
+        const uint64_t subtract = static_cast<uint64_t>((static_cast<Wide>(m) * modulus_) >> 64);
+        return high >= subtract ? high - subtract : high + modulus_ - subtract;
+    }
+};
+
+uint64_t isqrt(uint64_t n) {
+    uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+    while (root > 0 && root > n / root) --root;
+    while ((root + 1) <= n / (root + 1)) ++root;
+    return root;
+}
+
+/**
+ * @brief Call visit(p) for every prime p <= limit, in increasing order
+ */
+template <typename Visit>
+void sieve(uint64_t limit, Visit&& visit) {
+    if (limit < 2) return;
+    visit(uint64_t{2});
+
+    // Odd primes up to sqrt(limit) do the striking
+    const uint64_t root = isqrt(limit);
+    std::vector<uint8_t> small(root + 1, 1);
+    std::vector<uint64_t> primes;
+    for (uint64_t i = 3; i <= root; i += 2) {
+        if (!small[i]) continue;
+        primes.push_back(i);
+        for (uint64_t j = i * i; j <= root; j += 2 * i) small[j] = 0;
+    }
+
+    // Index i stands for the odd number 2i + 1; next holds, per prime,
+    // the index of the next odd multiple still to strike
+    std::vector<uint64_t> next;
+    next.reserve(primes.size());
+    for (uint64_t p : primes) next.push_back(p * p / 2);
+
+    const uint64_t last = (limit - 1) / 2;
+    std::vector<uint8_t> segment(SEGMENT_BYTES);
+    for (uint64_t low = 1; low <= last; low += SEGMENT_BYTES) {
+        const uint64_t high = std::min(low + SEGMENT_BYTES - 1, last);
+        std::fill(segment.begin(), segment.begin() + (high - low + 1), 1);
+
+        // Primes above sqrt(2 high + 1) have nothing to strike yet
+        for (size_t k = 0; k < primes.size() && primes[k] * primes[k] <= 2 * high + 1; ++k) {
+            uint64_t j = next[k];
+            for (; j <= high; j += primes[k]) segment[j - low] = 0;
+            next[k] = j;
+        }
+
+        for (uint64_t i = low; i <= high; ++i) {
+            if (segment[i - low]) visit(2 * i + 1);
+        }
+    }
+}
+
+/**
+ * @brief Product of factors[begin, end) as a balanced tree
+ *
+ * Splitting in the middle keeps the operands of every multiplication
+ * about the same size, so the large products reach the subquadratic
+ * algorithms instead of growing one small factor at a time.
+ */
+BigInt product(const std::vector<uint64_t>& factors, size_t begin, size_t end) {
+    if (end - begin == 1) return BigInt(static_cast<int64_t>(factors[begin]));
+    if (end == begin) return BigInt(1);
+
+    const size_t middle = begin + (end - begin) / 2;
+    return product(factors, begin, middle) * product(factors, middle, end);
+}
+
+/**
+ * @brief Multiply a sequence of factors, packing runs into 63-bit words first
+ */
+class Product {
+public:
+    void multiply(uint64_t factor) {
+        uint64_t next;
+        if (__builtin_mul_overflow(word_, factor, &next) || next > static_cast<uint64_t>(INT64_MAX)) {
+            words_.push_back(word_);
+            next = factor;
+        }
+        word_ = next;
+    }
+
+    BigInt result() {
+        words_.push_back(word_);
+        word_ = 1;
+        BigInt total = product(words_, 0, words_.size());
+        words_.clear();
+        return total;
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    uint64_t word_ = 1;
+};
+
+/**
+ * @brief low * (low + 1) * ... * high
+ */
+BigInt range_product(uint64_t low, uint64_t high) {
+    Product result;
+    for (uint64_t i = low; i <= high && i >= low; ++i) {
+        result.multiply(i);
+    }
+    return result.result();
+}
+
+// Above this n, binomial divides a range product by k! instead of
+// sieving primes up to n
+constexpr uint64_t BINOMIAL_SIEVE_LIMIT = uint64_t{1} << 26;
+
+} // namespace
+
+uint64_t pow_mod(uint64_t base, uint64_t exponent, uint64_t modulus) {
+    if (modulus == 1) return 0;
+
+    if (modulus % 2 != 0) {
+        const Montgomery64 field(modulus);
+        return field.from_form(field.power(field.to_form(base), exponent));
+    }
+
+    uint64_t result = 1;
+    base %= modulus;
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) result = static_cast<uint64_t>(static_cast<Wide>(result) * base % modulus);
+        base = static_cast<uint64_t>(static_cast<Wide>(base) * base % modulus);
+    }
+    return result;
+}
+
+bool is_prime(uint64_t n) {
+    if (n < 2) return false;
+    for (uint64_t p : WITNESSES) {
+        if (n % p == 0) return n == p;
+    }
+
+    uint64_t d = n - 1;
+    int s = 0;
+    for (; d % 2 == 0; d /= 2) ++s;
+
+    const Montgomery64 field(n);
+    const uint64_t one = field.to_form(1);
+    const uint64_t minus_one = field.to_form(n - 1);
+    for (uint64_t a : WITNESSES) {
+        uint64_t x = field.power(field.to_form(a), d);
+        if (x == one || x == minus_one) continue;
+
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r) {
+            x = field.product(x, x);
+            composite = x != minus_one;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+bool is_probable_prime(const BigInt& n, int rounds) {
+    if (auto small = n.to_int64()) {
+        return *small > 0 && is_prime(static_cast<uint64_t>(*small));
+    }
+    if (n.is_negative()) return false;
+
+    for (uint64_t p : WITNESSES) {
+        if ((n % BigInt(static_cast<int64_t>(p))).is_zero()) return false;
+    }
+
+    const BigInt one(1);
+    const BigInt two(2);
+    const BigInt n_minus_one = n - one;
+    BigInt d = n_minus_one;
+    int s = 0;
+    for (; (d % two).is_zero(); d = d / two) ++s;
+
+    // The small primes first, then bases from a fixed seed
+    std::mt19937_64 rng(0x6b61796e6174);
+    for (int round = 0; round < rounds; ++round) {
+        const size_t count = sizeof(WITNESSES) / sizeof(WITNESSES[0]);
+        const uint64_t a = static_cast<size_t>(round) < count ? WITNESSES[round] : 2 + (rng() >> 2);
+
+        BigInt x = BigInt::pow_mod(BigInt(static_cast<int64_t>(a)), d, n);
+        if (x == one || x == n_minus_one) continue;
+
+        bool composite = true;
+        for (int r = 1; r < s && composite; ++r) {
+            x = (x * x) % n;
+            composite = x != n_minus_one;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+ListType primes_up_to(uint64_t limit) {
+    ListType primes;
+    if (limit >= 10) {
+        // pi(x) < x / ln x (1 + 1.2762 / ln x) for x > 1 (Dusart)
+        const double ln = std::log(static_cast<double>(limit));
+        primes.reserve(static_cast<size_t>(limit / ln * (1 + 1.2762 / ln)) + 1);
+    }
+    sieve(limit, [&](uint64_t p) { primes.push_back(KaynatValue(static_cast<int64_t>(p))); });
+    return primes;
+}
+
+uint64_t prime_count(uint64_t limit) {
+    uint64_t count = 0;
+    sieve(limit, [&](uint64_t) { ++count; });
+    return count;
+}
+
+BigInt factorial(uint64_t n) {
+    return n < 2 ? BigInt(1) : range_product(2, n);
+}
+
+BigInt binomial(uint64_t n, uint64_t k) {
+    if (k > n) return BigInt();
+    k = std::min(k, n - k);
+    if (k == 0) return BigInt(1);
+
+    if (n > BINOMIAL_SIEVE_LIMIT || k <= 64) {
+        return range_product(n - k + 1, n) / factorial(k);
+    }
+
+    // Legendre's formula gives the exponent of each prime p <= n in
+    // n! / (k! (n - k)!) as a count of carries; p^e <= n always fits
+    Product result;
+    sieve(n, [&](uint64_t p) {
+        uint64_t factor = 1;
+        for (uint64_t q = p; q <= n; q *= p) {
+            if (n / q - k / q - (n - k) / q > 0) factor *= p;
+            if (q > n / p) break;
+        }
+        if (factor > 1) result.multiply(factor);
+    });
+    return result.result();
+}
+
+BigInt power(const BigInt& base, uint64_t exponent) {
+    BigInt result(1);
+    BigInt square = base;
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) result = result * square;
+        if (exponent > 1) square = square * square;
+    }
+    return result;
+}
+
+} // namespace number_theory
+} // namespace kaynat
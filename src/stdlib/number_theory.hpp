@@ -0,0 +1,74 @@
+/**
+ * @file number_theory.hpp
+ * @brief Number theory and exact combinatorics kernels
+ *
+ * Machine-word versions of the math tools' number theory functions, which
+ * the builtins use when their arguments fit in 64 bits, and the exact
+ * BigInt products behind factorial, binomial and integer pow.
+ */
+
+#pragma once
+
+#include "../interpreter/runtime_value.hpp"
+#include <cstdint>
+
+namespace kaynat {
+namespace number_theory {
+
+/**
+ * @brief base^exponent mod modulus, using Montgomery form for odd moduli
+ * @param modulus Must be non-zero
+ */
+uint64_t pow_mod(uint64_t base, uint64_t exponent, uint64_t modulus);
+
+/**
+ * @brief Deterministic Miller-Rabin; exact for every 64-bit value
+ */
+bool is_prime(uint64_t n);
+
+/**
+ * @brief Miller-Rabin with a fixed set of bases
+ *
+ * Composite numbers pass with probability below 4^-rounds; primes are
+ * always accepted. Results are reproducible from run to run.
+ */
+bool is_probable_prime(const BigInt& n, int rounds = 24);
+
+/**
+ * @brief Largest limit primes_up_to accepts
+ *
+ * Its 203 million primes already take over 3 GB as a list.
+ */
+constexpr uint64_t MAX_PRIMES_LIMIT = uint64_t{1} << 32;
+
+/**
+ * @brief Every prime <= limit as an Integer, in increasing order
+ *
+ * The sieve writes straight into the list, which is reserved once from
+ * an upper bound on the number of primes.
+ * @param limit At most MAX_PRIMES_LIMIT
+ */
+ListType primes_up_to(uint64_t limit);
+
+/**
+ * @brief Number of primes <= limit
+ */
+uint64_t prime_count(uint64_t limit);
+
+/**
+ * @brief n!, multiplied as a balanced product tree
+ */
+BigInt factorial(uint64_t n);
+
+/**
+ * @brief n choose k, 0 if k > n
+ */
+BigInt binomial(uint64_t n, uint64_t k);
+
+/**
+ * @brief base^exponent by repeated squaring
+ */
+BigInt power(const BigInt& base, uint64_t exponent);
+
+} // namespace number_theory
+} // namespace kaynat
@@ -12,6 +12,7 @@
 #include <iomanip>
 #include <filesystem>
 #include <regex>
+#include <mutex>
 
 namespace fs = std::filesystem;
 
@@ -20,9 +21,9 @@ namespace stdlib {
 
 // ===== FILE TOOLS =====
 
-KaynatValue file_read(const std::vector<KaynatValue>& args) {
+KaynatValue file_read(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_read expects 1 argument", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     
     std::ifstream file(*filename);
@@ -33,9 +34,9 @@ KaynatValue file_read(const std::vector<KaynatValue>& args) {
     return KaynatValue(oss.str());
 }
 
-KaynatValue file_write(const std::vector<KaynatValue>& args) {
+KaynatValue file_write(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("file_write expects 2 arguments", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     
     std::ofstream file(*filename);
@@ -45,9 +46,9 @@ KaynatValue file_write(const std::vector<KaynatValue>& args) {
     return KaynatValue(true);
 }
 
-KaynatValue file_append(const std::vector<KaynatValue>& args) {
+KaynatValue file_append(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("file_append expects 2 arguments", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     
     std::ofstream file(*filename, std::ios::app);
@@ -57,24 +58,24 @@ KaynatValue file_append(const std::vector<KaynatValue>& args) {
     return KaynatValue(true);
 }
 
-KaynatValue file_exists(const std::vector<KaynatValue>& args) {
+KaynatValue file_exists(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_exists expects 1 argument", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     return KaynatValue(fs::exists(*filename));
 }
 
-KaynatValue file_delete(const std::vector<KaynatValue>& args) {
+KaynatValue file_delete(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_delete expects 1 argument", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     return KaynatValue(fs::remove(*filename));
 }
 
-KaynatValue file_copy(const std::vector<KaynatValue>& args) {
+KaynatValue file_copy(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("file_copy expects 2 arguments", 0, 0);
-    auto src = args[0].as_string();
-    auto dst = args[1].as_string();
+    const std::string* src = args[0].as_string_ptr();
+    const std::string* dst = args[1].as_string_ptr();
     if (!src || !dst) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -85,10 +86,10 @@ KaynatValue file_copy(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue file_move(const std::vector<KaynatValue>& args) {
+KaynatValue file_move(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("file_move expects 2 arguments", 0, 0);
-    auto src = args[0].as_string();
-    auto dst = args[1].as_string();
+    const std::string* src = args[0].as_string_ptr();
+    const std::string* dst = args[1].as_string_ptr();
     if (!src || !dst) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -99,9 +100,9 @@ KaynatValue file_move(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue file_size(const std::vector<KaynatValue>& args) {
+KaynatValue file_size(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_size expects 1 argument", 0, 0);
-    auto filename = args[0].as_string();
+    const std::string* filename = args[0].as_string_ptr();
     if (!filename) throw TypeError("String", args[0].type_name(), 0, 0);
     
     try {
@@ -111,9 +112,9 @@ KaynatValue file_size(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue file_list_dir(const std::vector<KaynatValue>& args) {
+KaynatValue file_list_dir(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_list_dir expects 1 argument", 0, 0);
-    auto dirname = args[0].as_string();
+    const std::string* dirname = args[0].as_string_ptr();
     if (!dirname) throw TypeError("String", args[0].type_name(), 0, 0);
     
     ListType result;
@@ -127,55 +128,61 @@ KaynatValue file_list_dir(const std::vector<KaynatValue>& args) {
     return KaynatValue(result);
 }
 
-KaynatValue file_create_dir(const std::vector<KaynatValue>& args) {
+KaynatValue file_create_dir(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_create_dir expects 1 argument", 0, 0);
-    auto dirname = args[0].as_string();
+    const std::string* dirname = args[0].as_string_ptr();
     if (!dirname) throw TypeError("String", args[0].type_name(), 0, 0);
     return KaynatValue(fs::create_directories(*dirname));
 }
 
-KaynatValue file_is_file(const std::vector<KaynatValue>& args) {
+KaynatValue file_is_file(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_is_file expects 1 argument", 0, 0);
-    auto path = args[0].as_string();
+    const std::string* path = args[0].as_string_ptr();
     if (!path) throw TypeError("String", args[0].type_name(), 0, 0);
     return KaynatValue(fs::is_regular_file(*path));
 }
 
-KaynatValue file_is_dir(const std::vector<KaynatValue>& args) {
+KaynatValue file_is_dir(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("file_is_dir expects 1 argument", 0, 0);
-    auto path = args[0].as_string();
+    const std::string* path = args[0].as_string_ptr();
     if (!path) throw TypeError("String", args[0].type_name(), 0, 0);
     return KaynatValue(fs::is_directory(*path));
 }
 
 // ===== DATE TOOLS =====
 
-KaynatValue date_now(const std::vector<KaynatValue>& args) {
+KaynatValue date_now(ArgSpan args) {
     if (!args.empty()) throw RuntimeError("date_now expects 0 arguments", 0, 0);
     auto now = std::time(nullptr);
     return KaynatValue(static_cast<int64_t>(now));
 }
 
-KaynatValue date_format(const std::vector<KaynatValue>& args) {
+KaynatValue date_format(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("date_format expects 2 arguments", 0, 0);
     auto timestamp = args[0].as_int();
-    auto format = args[1].as_string();
+    const std::string* format = args[1].as_string_ptr();
     if (!timestamp || !format) throw TypeError("Integer/String", "unknown", 0, 0);
     
     std::time_t time = static_cast<std::time_t>(*timestamp);
-    std::tm* tm = std::localtime(&time);
+    std::tm tm;
+    {
+        // localtime returns a shared buffer; parallel loops may call this
+        static std::mutex localtime_mutex;
+        std::lock_guard<std::mutex> lock(localtime_mutex);
+        tm = *std::localtime(&time);
+    }
     
     std::ostringstream oss;
-    oss << std::put_time(tm, format->c_str());
+    oss << std::put_time(&tm, format->c_str());
     return KaynatValue(oss.str());
 }
 
-KaynatValue date_parse([[maybe_unused]] const std::vector<KaynatValue>& args) {
+KaynatValue date_parse([[maybe_unused]] ArgSpan args) {
     // Simplified - returns current time
     return date_now({});
 }
 
-KaynatValue date_add_days(const std::vector<KaynatValue>& args) {
+KaynatValue date_add_days(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("date_add_days expects 2 arguments", 0, 0);
     auto timestamp = args[0].as_int();
     auto days = args[1].as_int();
@@ -184,7 +191,7 @@ KaynatValue date_add_days(const std::vector<KaynatValue>& args) {
     return KaynatValue(*timestamp + (*days * 86400));
 }
 
-KaynatValue date_diff_days(const std::vector<KaynatValue>& args) {
+KaynatValue date_diff_days(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("date_diff_days expects 2 arguments", 0, 0);
     auto time1 = args[0].as_int();
     auto time2 = args[1].as_int();
@@ -197,76 +204,83 @@ KaynatValue date_diff_days(const std::vector<KaynatValue>& args) {
 
 static std::random_device rd;
 static std::mt19937 gen(rd());
+static std::mutex gen_mutex;  // Parallel loops share the generator
 
-KaynatValue random_int(const std::vector<KaynatValue>& args) {
+KaynatValue random_int(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("random_int expects 2 arguments", 0, 0);
     auto min = args[0].as_int();
     auto max = args[1].as_int();
     if (!min || !max) throw TypeError("Integer", "unknown", 0, 0);
     
     std::uniform_int_distribution<int64_t> dis(*min, *max);
+    std::lock_guard<std::mutex> lock(gen_mutex);
     return KaynatValue(dis(gen));
 }
 
-KaynatValue random_float(const std::vector<KaynatValue>& args) {
+KaynatValue random_float(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("random_float expects 2 arguments", 0, 0);
     double min = args[0].as_float() ? *args[0].as_float() : static_cast<double>(*args[0].as_int());
     double max = args[1].as_float() ? *args[1].as_float() : static_cast<double>(*args[1].as_int());
     
     std::uniform_real_distribution<double> dis(min, max);
+    std::lock_guard<std::mutex> lock(gen_mutex);
     return KaynatValue(dis(gen));
 }
 
-KaynatValue random_choice(const std::vector<KaynatValue>& args) {
+KaynatValue random_choice(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("random_choice expects 1 argument", 0, 0);
-    auto list = args[0].as_list();
+    const ListType* list = args[0].as_list_ptr();
     if (!list || list->empty()) throw RuntimeError("random_choice requires non-empty list", 0, 0);
     
     std::uniform_int_distribution<size_t> dis(0, list->size() - 1);
+    std::lock_guard<std::mutex> lock(gen_mutex);
     return (*list)[dis(gen)];
 }
 
-KaynatValue random_shuffle(const std::vector<KaynatValue>& args) {
+KaynatValue random_shuffle(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("random_shuffle expects 1 argument", 0, 0);
-    auto list = args[0].as_list();
+    const ListType* list = args[0].as_list_ptr();
     if (!list) throw TypeError("List", args[0].type_name(), 0, 0);
     
     ListType result = *list;
+    std::lock_guard<std::mutex> lock(gen_mutex);
     std::shuffle(result.begin(), result.end(), gen);
     return KaynatValue(result);
 }
 
-KaynatValue random_sample(const std::vector<KaynatValue>& args) {
+KaynatValue random_sample(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("random_sample expects 2 arguments", 0, 0);
-    auto list = args[0].as_list();
+    const ListType* list = args[0].as_list_ptr();
     auto count = args[1].as_int();
     if (!list || !count) throw TypeError("List/Integer", "unknown", 0, 0);
     
     ListType shuffled = *list;
+    std::lock_guard<std::mutex> lock(gen_mutex);
     std::shuffle(shuffled.begin(), shuffled.end(), gen);
     
     size_t n = std::min(static_cast<size_t>(*count), shuffled.size());
     return KaynatValue(ListType(shuffled.begin(), shuffled.begin() + n));
 }
 
-KaynatValue random_seed(const std::vector<KaynatValue>& args) {
+KaynatValue random_seed(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("random_seed expects 1 argument", 0, 0);
     auto seed = args[0].as_int();
     if (!seed) throw TypeError("Integer", args[0].type_name(), 0, 0);
     
+    std::lock_guard<std::mutex> lock(gen_mutex);
     gen.seed(static_cast<unsigned int>(*seed));
     return KaynatValue();
 }
 
 // ===== NETWORK TOOLS (Simplified - no actual HTTP) =====
 
-KaynatValue network_http_get(const std::vector<KaynatValue>& args) {
+KaynatValue network_http_get(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("http_get expects 1 argument", 0, 0);
     // Simplified - would need libcurl
     return KaynatValue("HTTP GET not implemented - requires libcurl");
 }
 
-KaynatValue network_http_post(const std::vector<KaynatValue>& args) {
+KaynatValue network_http_post(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("http_post expects 2 arguments", 0, 0);
     // Simplified - would need libcurl
     return KaynatValue("HTTP POST not implemented - requires libcurl");
@@ -274,40 +288,40 @@ KaynatValue network_http_post(const std::vector<KaynatValue>& args) {
 
 // ===== JSON TOOLS (Simplified) =====
 
-KaynatValue json_parse(const std::vector<KaynatValue>& args) {
+KaynatValue json_parse(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("json_parse expects 1 argument", 0, 0);
     // Simplified - would need nlohmann/json
     return KaynatValue("JSON parse not implemented - requires nlohmann/json");
 }
 
-KaynatValue json_stringify(const std::vector<KaynatValue>& args) {
+KaynatValue json_stringify(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("json_stringify expects 1 argument", 0, 0);
     // Simplified - basic conversion
     return KaynatValue(args[0].to_string());
 }
 
-KaynatValue json_format(const std::vector<KaynatValue>& args) {
+KaynatValue json_format(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("json_format expects 1 argument", 0, 0);
     return json_stringify(args);
 }
 
 // ===== CRYPTO TOOLS (Simplified) =====
 
-KaynatValue crypto_sha256(const std::vector<KaynatValue>& args) {
+KaynatValue crypto_sha256(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("sha256 expects 1 argument", 0, 0);
     // Simplified - would need OpenSSL
     return KaynatValue("SHA256 not implemented - requires OpenSSL");
 }
 
-KaynatValue crypto_md5(const std::vector<KaynatValue>& args) {
+KaynatValue crypto_md5(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("md5 expects 1 argument", 0, 0);
     // Simplified - would need OpenSSL
     return KaynatValue("MD5 not implemented - requires OpenSSL");
 }
 
-KaynatValue crypto_base64_encode(const std::vector<KaynatValue>& args) {
+KaynatValue crypto_base64_encode(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("base64_encode expects 1 argument", 0, 0);
-    auto str = args[0].as_string();
+    const std::string* str = args[0].as_string_ptr();
     if (!str) throw TypeError("String", args[0].type_name(), 0, 0);
     
     static const char* base64_chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -328,13 +342,13 @@ KaynatValue crypto_base64_encode(const std::vector<KaynatValue>& args) {
     return KaynatValue(result);
 }
 
-KaynatValue crypto_base64_decode(const std::vector<KaynatValue>& args) {
+KaynatValue crypto_base64_decode(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("base64_decode expects 1 argument", 0, 0);
     // Simplified
     return KaynatValue("Base64 decode not fully implemented");
 }
 
-KaynatValue crypto_random_token(const std::vector<KaynatValue>& args) {
+KaynatValue crypto_random_token(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("random_token expects 1 argument", 0, 0);
     auto length = args[0].as_int();
     if (!length) throw TypeError("Integer", args[0].type_name(), 0, 0);
@@ -343,6 +357,7 @@ KaynatValue crypto_random_token(const std::vector<KaynatValue>& args) {
     std::uniform_int_distribution<size_t> dis(0, 61);
     
     std::string result;
+    std::lock_guard<std::mutex> lock(gen_mutex);
     for (int64_t i = 0; i < *length; ++i) {
         result += chars[dis(gen)];
     }
@@ -351,10 +366,10 @@ KaynatValue crypto_random_token(const std::vector<KaynatValue>& args) {
 
 // ===== PATTERN TOOLS =====
 
-KaynatValue pattern_match(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_match(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("pattern_match expects 2 arguments", 0, 0);
-    auto pattern = args[0].as_string();
-    auto text = args[1].as_string();
+    const std::string* pattern = args[0].as_string_ptr();
+    const std::string* text = args[1].as_string_ptr();
     if (!pattern || !text) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -365,10 +380,10 @@ KaynatValue pattern_match(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue pattern_find_all(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_find_all(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("pattern_find_all expects 2 arguments", 0, 0);
-    auto pattern = args[0].as_string();
-    auto text = args[1].as_string();
+    const std::string* pattern = args[0].as_string_ptr();
+    const std::string* text = args[1].as_string_ptr();
     if (!pattern || !text) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -388,11 +403,11 @@ KaynatValue pattern_find_all(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue pattern_replace(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_replace(ArgSpan args) {
     if (args.size() != 3) throw RuntimeError("pattern_replace expects 3 arguments", 0, 0);
-    auto pattern = args[0].as_string();
-    auto replacement = args[1].as_string();
-    auto text = args[2].as_string();
+    const std::string* pattern = args[0].as_string_ptr();
+    const std::string* replacement = args[1].as_string_ptr();
+    const std::string* text = args[2].as_string_ptr();
     if (!pattern || !replacement || !text) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -403,10 +418,10 @@ KaynatValue pattern_replace(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue pattern_split(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_split(ArgSpan args) {
     if (args.size() != 2) throw RuntimeError("pattern_split expects 2 arguments", 0, 0);
-    auto pattern = args[0].as_string();
-    auto text = args[1].as_string();
+    const std::string* pattern = args[0].as_string_ptr();
+    const std::string* text = args[1].as_string_ptr();
     if (!pattern || !text) throw TypeError("String", "unknown", 0, 0);
     
     try {
@@ -426,18 +441,18 @@ KaynatValue pattern_split(const std::vector<KaynatValue>& args) {
     }
 }
 
-KaynatValue pattern_is_email(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_is_email(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("is_email expects 1 argument", 0, 0);
-    auto text = args[0].as_string();
+    const std::string* text = args[0].as_string_ptr();
     if (!text) throw TypeError("String", args[0].type_name(), 0, 0);
     
     std::regex email_pattern(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
     return KaynatValue(std::regex_match(*text, email_pattern));
 }
 
-KaynatValue pattern_is_url(const std::vector<KaynatValue>& args) {
+KaynatValue pattern_is_url(ArgSpan args) {
     if (args.size() != 1) throw RuntimeError("is_url expects 1 argument", 0, 0);
-    auto text = args[0].as_string();
+    const std::string* text = args[0].as_string_ptr();
     if (!text) throw TypeError("String", args[0].type_name(), 0, 0);
     
     std::regex url_pattern(R"(https?://[^\s]+)");
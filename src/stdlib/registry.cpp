@@ -0,0 +1,281 @@
+/**
+ * @file registry.cpp
+ * @brief Registration of standard library functions
+ */
+
+#include "stdlib.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+
+namespace kaynat {
+namespace stdlib {
+
+namespace {
+
+constexpr Builtin BUILTINS[] = {
+    // Math functions (26)
+    {"sqrt", math_sqrt, true},
+    {"pow", math_pow, true},
+    {"abs", math_abs, true},
+    {"floor", math_floor, true},
+    {"ceil", math_ceil, true},
+    {"round", math_round, true},
+    {"sin", math_sin, true},
+    {"cos", math_cos, true},
+    {"tan", math_tan, true},
+    {"log", math_log, true},
+    {"log10", math_log10, true},
+    {"exp", math_exp, true},
+    {"min", math_min, true},
+    {"max", math_max, true},
+    {"factorial", math_factorial, true},
+    {"binomial", math_binomial, true},
+    {"gcd", math_gcd, true},
+    {"lcm", math_lcm, true},
+    {"is_prime", math_is_prime, true},
+    {"pow_mod", math_pow_mod, true},
+    {"primes_up_to", math_primes_up_to, true},
+    {"prime_count", math_prime_count, true},
+    {"random", math_random, false},
+    {"pi", math_pi, true},
+    {"to_hex", math_to_hex, true},
+    {"to_binary", math_to_binary, true},
+    
+    // String functions (20)
+    {"uppercase", string_uppercase, true},
+    {"lowercase", string_lowercase, true},
+    {"string_length", string_length, true},
+    {"trim", string_trim, true},
+    {"split", string_split, true},
+    {"join", string_join, true},
+    {"replace", string_replace, true},
+    {"starts_with", string_starts_with, true},
+    {"ends_with", string_ends_with, true},
+    {"contains", string_contains, true},
+    {"substring", string_substring, true},
+    {"index_of", string_index_of, true},
+    {"string_reverse", string_reverse, true},
+    {"string_repeat", string_repeat, true},
+    {"pad_left", string_pad_left, true},
+    {"pad_right", string_pad_right, true},
+    {"to_number", string_to_number, true},
+    {"to_list", string_to_list, true},
+    {"is_empty", string_is_empty, true},
+    {"capitalize", string_capitalize, true},
+    
+    // List functions (20)
+    {"list_length", list_length, true},
+    {"list_append", list_append, true},
+    {"list_prepend", list_prepend, true},
+    {"list_insert", list_insert, true},
+    {"list_remove", list_remove, true},
+    {"list_get", list_get, true},
+    {"list_set", list_set, true},
+    {"list_slice", list_slice, true},
+    {"list_sort", list_sort, true},
+    {"list_reverse", list_reverse, true},
+    {"list_contains", list_contains, true},
+    {"list_index_of", list_index_of, true},
+    {"list_min", list_min, true},
+    {"list_max", list_max, true},
+    {"list_sum", list_sum, true},
+    {"list_filter", list_filter, true},
+    {"list_map", list_map, true},
+    {"list_reduce", list_reduce, true},
+    {"list_unique", list_unique, true},
+    {"list_flatten", list_flatten, true},
+    
+    // File functions (12)
+    {"file_read", file_read, false},
+    {"file_write", file_write, false},
+    {"file_append", file_append, false},
+    {"file_exists", file_exists, false},
+    {"file_delete", file_delete, false},
+    {"file_copy", file_copy, false},
+    {"file_move", file_move, false},
+    {"file_size", file_size, false},
+    {"file_list_dir", file_list_dir, false},
+    {"file_create_dir", file_create_dir, false},
+    {"file_is_file", file_is_file, false},
+    {"file_is_dir", file_is_dir, false},
+    
+    // Date functions (5)
+    {"date_now", date_now, false},
+    {"date_format", date_format, true},
+    {"date_parse", date_parse, false},
+    {"date_add_days", date_add_days, true},
+    {"date_diff_days", date_diff_days, true},
+    
+    // Random functions (6)
+    {"random_int", random_int, false},
+    {"random_float", random_float, false},
+    {"random_choice", random_choice, false},
+    {"random_shuffle", random_shuffle, false},
+    {"random_sample", random_sample, false},
+    {"random_seed", random_seed, false},
+    
+    // Network functions (2)
+    {"http_get", network_http_get, false},
+    {"http_post", network_http_post, false},
+    
+    // JSON functions (3)
+    {"json_parse", json_parse, true},
+    {"json_stringify", json_stringify, true},
+    {"json_format", json_format, true},
+    
+    // Crypto functions (5)
+    {"sha256", crypto_sha256, true},
+    {"md5", crypto_md5, true},
+    {"base64_encode", crypto_base64_encode, true},
+    {"base64_decode", crypto_base64_decode, true},
+    {"random_token", crypto_random_token, false},
+    
+    // Pattern functions (6)
+    {"pattern_match", pattern_match, true},
+    {"pattern_find_all", pattern_find_all, true},
+    {"pattern_replace", pattern_replace, true},
+    {"pattern_split", pattern_split, true},
+    {"is_email", pattern_is_email, true},
+    {"is_url", pattern_is_url, true}
+};
+
+constexpr size_t BUILTIN_COUNT = std::size(BUILTINS);
+
+// Names are hashed into buckets, and each bucket has a seed that sends
+// its names to free slots. Twice as many slots as names keeps seeds easy to find.
+constexpr size_t BUCKETS = 32;
+constexpr size_t SLOTS = 256;
+constexpr uint32_t MAX_SEED = 1u << 16;
+static_assert(SLOTS >= 2 * BUILTIN_COUNT, "Too many builtins for the hash table");
+
+/**
+ * @brief FNV-1a hash of a name
+ */
+constexpr uint32_t hash_name(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Spread every bit of a hash over the low bits
+ */
+constexpr uint32_t mix(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+constexpr size_t bucket_of(uint32_t hash) {
+    return mix(hash) % BUCKETS;
+}
+
+constexpr size_t slot_of(uint32_t hash, uint32_t seed) {
+    return mix(hash ^ (seed * 0x9e3779b9u)) % SLOTS;
+}
+
+/**
+ * @brief Perfect hash of the builtin names
+ */
+struct HashTable {
+    uint32_t seeds[BUCKETS];
+    int16_t slots[SLOTS];  // Index into BUILTINS, or -1
+};
+
+constexpr HashTable build_table() {
+    HashTable table{};
+    for (int16_t& slot : table.slots) {
+        slot = -1;
+    }
+    
+    uint32_t hashes[BUILTIN_COUNT] = {};
+    size_t sizes[BUCKETS] = {};
+    for (size_t i = 0; i < BUILTIN_COUNT; ++i) {
+        hashes[i] = hash_name(BUILTINS[i].name);
+        ++sizes[bucket_of(hashes[i])];
+    }
+    
+    // Place the fullest buckets first, while most slots are still free
+    bool placed[BUCKETS] = {};
+    for (size_t round = 0; round < BUCKETS; ++round) {
+        size_t bucket = 0;
+        while (placed[bucket]) ++bucket;
+        for (size_t b = bucket + 1; b < BUCKETS; ++b) {
+            if (!placed[b] && sizes[b] > sizes[bucket]) bucket = b;
+        }
+        placed[bucket] = true;
+        
+        for (uint32_t seed = 0;; ++seed) {
+            if (seed == MAX_SEED) {
+                throw "No perfect hash for the builtin names; is one listed twice?";
+            }
+            
+            size_t taken[BUILTIN_COUNT] = {};
+            size_t count = 0;
+            bool fits = true;
+            for (size_t i = 0; i < BUILTIN_COUNT && fits; ++i) {
+                if (bucket_of(hashes[i]) != bucket) continue;
+                const size_t slot = slot_of(hashes[i], seed);
+                fits = table.slots[slot] < 0;
+                for (size_t j = 0; j < count && fits; ++j) {
+                    fits = taken[j] != slot;
+                }
+                taken[count++] = slot;
+            }
+            if (!fits) continue;
+            
+            for (size_t i = 0; i < BUILTIN_COUNT; ++i) {
+                if (bucket_of(hashes[i]) == bucket) {
+                    table.slots[slot_of(hashes[i], seed)] = static_cast<int16_t>(i);
+                }
+            }
+            table.seeds[bucket] = seed;
+            break;
+        }
+    }
+    return table;
+}
+
+constexpr HashTable TABLE = build_table();
+
+/**
+ * @brief A builtin's function value, made by the first thread to need it
+ */
+struct LazyValue {
+    std::once_flag made;
+    KaynatValue value;
+};
+
+} // namespace
+
+const Builtin* find_builtin(std::string_view name) {
+    const uint32_t hash = hash_name(name);
+    const int16_t index = TABLE.slots[slot_of(hash, TABLE.seeds[bucket_of(hash)])];
+    if (index < 0 || name != BUILTINS[index].name) {
+        return nullptr;
+    }
+    return &BUILTINS[index];
+}
+
+const KaynatValue* builtin_value(Symbol name) {
+    const Builtin* builtin = find_builtin(name.str());
+    if (builtin == nullptr) {
+        return nullptr;
+    }
+    
+    static LazyValue values[BUILTIN_COUNT];
+    LazyValue& lazy = values[builtin - BUILTINS];
+    std::call_once(lazy.made, [&]() { lazy.value = KaynatValue(CallableType(builtin->function)); });
+    return &lazy.value;
+}
+
+} // namespace stdlib
+} // namespace kaynat
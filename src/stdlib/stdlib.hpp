@@ -2,8 +2,8 @@
  * @file stdlib.hpp
  * @brief Standard library functions for Kaynat++
  * 
- * Provides 99 built-in functions across 10 modules:
- * - Math tools (20 functions)
+ * Provides 105 built-in functions across 10 modules:
+ * - Math tools (26 functions)
  * - String tools (20 functions)
  * - List tools (20 functions)
  * - File tools (12 functions)
@@ -13,6 +13,9 @@
  * - JSON tools (3 functions)
  * - Crypto tools (5 functions)
  * - Pattern tools (6 functions)
+ * 
+ * Every function is a NativeFunction: it reads its arguments through an
+ * ArgSpan over the caller's storage and returns its result by value.
  */
 
 #pragma once
@@ -20,128 +23,165 @@
 #include "../interpreter/runtime_value.hpp"
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace kaynat {
+
 namespace stdlib {
 
-// Math Tools (20 functions)
-KaynatValue math_sqrt(const std::vector<KaynatValue>& args);
-KaynatValue math_pow(const std::vector<KaynatValue>& args);
-KaynatValue math_abs(const std::vector<KaynatValue>& args);
-KaynatValue math_floor(const std::vector<KaynatValue>& args);
-KaynatValue math_ceil(const std::vector<KaynatValue>& args);
-KaynatValue math_round(const std::vector<KaynatValue>& args);
-KaynatValue math_sin(const std::vector<KaynatValue>& args);
-KaynatValue math_cos(const std::vector<KaynatValue>& args);
-KaynatValue math_tan(const std::vector<KaynatValue>& args);
-KaynatValue math_log(const std::vector<KaynatValue>& args);
-KaynatValue math_log10(const std::vector<KaynatValue>& args);
-KaynatValue math_exp(const std::vector<KaynatValue>& args);
-KaynatValue math_min(const std::vector<KaynatValue>& args);
-KaynatValue math_max(const std::vector<KaynatValue>& args);
-KaynatValue math_factorial(const std::vector<KaynatValue>& args);
-KaynatValue math_gcd(const std::vector<KaynatValue>& args);
-KaynatValue math_lcm(const std::vector<KaynatValue>& args);
-KaynatValue math_is_prime(const std::vector<KaynatValue>& args);
-KaynatValue math_random(const std::vector<KaynatValue>& args);
-KaynatValue math_pi(const std::vector<KaynatValue>& args);
+/**
+ * @brief Entry of the standard library table
+ */
+struct Builtin {
+    const char* name;
+    NativeFunction function;
+    bool pure;  // Result depends only on the arguments: no I/O, clock or randomness
+};
+
+/**
+ * @brief Look up a standard library function by name
+ * 
+ * Uses a perfect hash built at compile time: one hash of the name and
+ * one string comparison.
+ * 
+ * @return Null if no function has that name
+ */
+const Builtin* find_builtin(std::string_view name);
+
+/**
+ * @brief Value of a standard library function, for use as an Environment's builtins
+ * 
+ * Each value is made the first time it is asked for and is then shared
+ * by every engine on every thread, so starting an engine costs nothing.
+ * 
+ * @return Null if no function has that name
+ */
+const KaynatValue* builtin_value(Symbol name);
+
+// Math Tools (26 functions)
+KaynatValue math_sqrt(ArgSpan args);
+KaynatValue math_pow(ArgSpan args);
+KaynatValue math_abs(ArgSpan args);
+KaynatValue math_floor(ArgSpan args);
+KaynatValue math_ceil(ArgSpan args);
+KaynatValue math_round(ArgSpan args);
+KaynatValue math_sin(ArgSpan args);
+KaynatValue math_cos(ArgSpan args);
+KaynatValue math_tan(ArgSpan args);
+KaynatValue math_log(ArgSpan args);
+KaynatValue math_log10(ArgSpan args);
+KaynatValue math_exp(ArgSpan args);
+KaynatValue math_min(ArgSpan args);
+KaynatValue math_max(ArgSpan args);
+KaynatValue math_factorial(ArgSpan args);
+KaynatValue math_binomial(ArgSpan args);
+KaynatValue math_gcd(ArgSpan args);
+KaynatValue math_lcm(ArgSpan args);
+KaynatValue math_is_prime(ArgSpan args);
+KaynatValue math_pow_mod(ArgSpan args);
+KaynatValue math_primes_up_to(ArgSpan args);
+KaynatValue math_prime_count(ArgSpan args);
+KaynatValue math_random(ArgSpan args);
+KaynatValue math_pi(ArgSpan args);
+KaynatValue math_to_hex(ArgSpan args);
+KaynatValue math_to_binary(ArgSpan args);
 
 // String Tools (20 functions)
-KaynatValue string_uppercase(const std::vector<KaynatValue>& args);
-KaynatValue string_lowercase(const std::vector<KaynatValue>& args);
-KaynatValue string_length(const std::vector<KaynatValue>& args);
-KaynatValue string_trim(const std::vector<KaynatValue>& args);
-KaynatValue string_split(const std::vector<KaynatValue>& args);
-KaynatValue string_join(const std::vector<KaynatValue>& args);
-KaynatValue string_replace(const std::vector<KaynatValue>& args);
-KaynatValue string_starts_with(const std::vector<KaynatValue>& args);
-KaynatValue string_ends_with(const std::vector<KaynatValue>& args);
-KaynatValue string_contains(const std::vector<KaynatValue>& args);
-KaynatValue string_substring(const std::vector<KaynatValue>& args);
-KaynatValue string_index_of(const std::vector<KaynatValue>& args);
-KaynatValue string_reverse(const std::vector<KaynatValue>& args);
-KaynatValue string_repeat(const std::vector<KaynatValue>& args);
-KaynatValue string_pad_left(const std::vector<KaynatValue>& args);
-KaynatValue string_pad_right(const std::vector<KaynatValue>& args);
-KaynatValue string_to_number(const std::vector<KaynatValue>& args);
-KaynatValue string_to_list(const std::vector<KaynatValue>& args);
-KaynatValue string_is_empty(const std::vector<KaynatValue>& args);
-KaynatValue string_capitalize(const std::vector<KaynatValue>& args);
+KaynatValue string_uppercase(ArgSpan args);
+KaynatValue string_lowercase(ArgSpan args);
+KaynatValue string_length(ArgSpan args);
+KaynatValue string_trim(ArgSpan args);
+KaynatValue string_split(ArgSpan args);
+KaynatValue string_join(ArgSpan args);
+KaynatValue string_replace(ArgSpan args);
+KaynatValue string_starts_with(ArgSpan args);
+KaynatValue string_ends_with(ArgSpan args);
+KaynatValue string_contains(ArgSpan args);
+KaynatValue string_substring(ArgSpan args);
+KaynatValue string_index_of(ArgSpan args);
+KaynatValue string_reverse(ArgSpan args);
+KaynatValue string_repeat(ArgSpan args);
+KaynatValue string_pad_left(ArgSpan args);
+KaynatValue string_pad_right(ArgSpan args);
+KaynatValue string_to_number(ArgSpan args);
+KaynatValue string_to_list(ArgSpan args);
+KaynatValue string_is_empty(ArgSpan args);
+KaynatValue string_capitalize(ArgSpan args);
 
 // List Tools (20 functions)
-KaynatValue list_length(const std::vector<KaynatValue>& args);
-KaynatValue list_append(const std::vector<KaynatValue>& args);
-KaynatValue list_prepend(const std::vector<KaynatValue>& args);
-KaynatValue list_insert(const std::vector<KaynatValue>& args);
-KaynatValue list_remove(const std::vector<KaynatValue>& args);
-KaynatValue list_get(const std::vector<KaynatValue>& args);
-KaynatValue list_set(const std::vector<KaynatValue>& args);
-KaynatValue list_slice(const std::vector<KaynatValue>& args);
-KaynatValue list_sort(const std::vector<KaynatValue>& args);
-KaynatValue list_reverse(const std::vector<KaynatValue>& args);
-KaynatValue list_contains(const std::vector<KaynatValue>& args);
-KaynatValue list_index_of(const std::vector<KaynatValue>& args);
-KaynatValue list_min(const std::vector<KaynatValue>& args);
-KaynatValue list_max(const std::vector<KaynatValue>& args);
-KaynatValue list_sum(const std::vector<KaynatValue>& args);
-KaynatValue list_filter(const std::vector<KaynatValue>& args);
-KaynatValue list_map(const std::vector<KaynatValue>& args);
-KaynatValue list_reduce(const std::vector<KaynatValue>& args);
-KaynatValue list_unique(const std::vector<KaynatValue>& args);
-KaynatValue list_flatten(const std::vector<KaynatValue>& args);
+KaynatValue list_length(ArgSpan args);
+KaynatValue list_append(ArgSpan args);
+KaynatValue list_prepend(ArgSpan args);
+KaynatValue list_insert(ArgSpan args);
+KaynatValue list_remove(ArgSpan args);
+KaynatValue list_get(ArgSpan args);
+KaynatValue list_set(ArgSpan args);
+KaynatValue list_slice(ArgSpan args);
+KaynatValue list_sort(ArgSpan args);
+KaynatValue list_reverse(ArgSpan args);
+KaynatValue list_contains(ArgSpan args);
+KaynatValue list_index_of(ArgSpan args);
+KaynatValue list_min(ArgSpan args);
+KaynatValue list_max(ArgSpan args);
+KaynatValue list_sum(ArgSpan args);
+KaynatValue list_filter(ArgSpan args);
+KaynatValue list_map(ArgSpan args);
+KaynatValue list_reduce(ArgSpan args);
+KaynatValue list_unique(ArgSpan args);
+KaynatValue list_flatten(ArgSpan args);
 
 // File Tools (12 functions)
-KaynatValue file_read(const std::vector<KaynatValue>& args);
-KaynatValue file_write(const std::vector<KaynatValue>& args);
-KaynatValue file_append(const std::vector<KaynatValue>& args);
-KaynatValue file_exists(const std::vector<KaynatValue>& args);
-KaynatValue file_delete(const std::vector<KaynatValue>& args);
-KaynatValue file_copy(const std::vector<KaynatValue>& args);
-KaynatValue file_move(const std::vector<KaynatValue>& args);
-KaynatValue file_size(const std::vector<KaynatValue>& args);
-KaynatValue file_list_dir(const std::vector<KaynatValue>& args);
-KaynatValue file_create_dir(const std::vector<KaynatValue>& args);
-KaynatValue file_is_file(const std::vector<KaynatValue>& args);
-KaynatValue file_is_dir(const std::vector<KaynatValue>& args);
+KaynatValue file_read(ArgSpan args);
+KaynatValue file_write(ArgSpan args);
+KaynatValue file_append(ArgSpan args);
+KaynatValue file_exists(ArgSpan args);
+KaynatValue file_delete(ArgSpan args);
+KaynatValue file_copy(ArgSpan args);
+KaynatValue file_move(ArgSpan args);
+KaynatValue file_size(ArgSpan args);
+KaynatValue file_list_dir(ArgSpan args);
+KaynatValue file_create_dir(ArgSpan args);
+KaynatValue file_is_file(ArgSpan args);
+KaynatValue file_is_dir(ArgSpan args);
 
 // Date Tools (5 functions)
-KaynatValue date_now(const std::vector<KaynatValue>& args);
-KaynatValue date_format(const std::vector<KaynatValue>& args);
-KaynatValue date_parse(const std::vector<KaynatValue>& args);
-KaynatValue date_add_days(const std::vector<KaynatValue>& args);
-KaynatValue date_diff_days(const std::vector<KaynatValue>& args);
+KaynatValue date_now(ArgSpan args);
+KaynatValue date_format(ArgSpan args);
+KaynatValue date_parse(ArgSpan args);
+KaynatValue date_add_days(ArgSpan args);
+KaynatValue date_diff_days(ArgSpan args);
 
 // Random Tools (6 functions)
-KaynatValue random_int(const std::vector<KaynatValue>& args);
-KaynatValue random_float(const std::vector<KaynatValue>& args);
-KaynatValue random_choice(const std::vector<KaynatValue>& args);
-KaynatValue random_shuffle(const std::vector<KaynatValue>& args);
-KaynatValue random_sample(const std::vector<KaynatValue>& args);
-KaynatValue random_seed(const std::vector<KaynatValue>& args);
+KaynatValue random_int(ArgSpan args);
+KaynatValue random_float(ArgSpan args);
+KaynatValue random_choice(ArgSpan args);
+KaynatValue random_shuffle(ArgSpan args);
+KaynatValue random_sample(ArgSpan args);
+KaynatValue random_seed(ArgSpan args);
 
 // Network Tools (2 functions)
-KaynatValue network_http_get(const std::vector<KaynatValue>& args);
-KaynatValue network_http_post(const std::vector<KaynatValue>& args);
+KaynatValue network_http_get(ArgSpan args);
+KaynatValue network_http_post(ArgSpan args);
 
 // JSON Tools (3 functions)
-KaynatValue json_parse(const std::vector<KaynatValue>& args);
-KaynatValue json_stringify(const std::vector<KaynatValue>& args);
-KaynatValue json_format(const std::vector<KaynatValue>& args);
+KaynatValue json_parse(ArgSpan args);
+KaynatValue json_stringify(ArgSpan args);
+KaynatValue json_format(ArgSpan args);
 
 // Crypto Tools (5 functions)
-KaynatValue crypto_sha256(const std::vector<KaynatValue>& args);
-KaynatValue crypto_md5(const std::vector<KaynatValue>& args);
-KaynatValue crypto_base64_encode(const std::vector<KaynatValue>& args);
-KaynatValue crypto_base64_decode(const std::vector<KaynatValue>& args);
-KaynatValue crypto_random_token(const std::vector<KaynatValue>& args);
+KaynatValue crypto_sha256(ArgSpan args);
+KaynatValue crypto_md5(ArgSpan args);
+KaynatValue crypto_base64_encode(ArgSpan args);
+KaynatValue crypto_base64_decode(ArgSpan args);
+KaynatValue crypto_random_token(ArgSpan args);
 
 // Pattern Tools (6 functions)
-KaynatValue pattern_match(const std::vector<KaynatValue>& args);
-KaynatValue pattern_find_all(const std::vector<KaynatValue>& args);
-KaynatValue pattern_replace(const std::vector<KaynatValue>& args);
-KaynatValue pattern_split(const std::vector<KaynatValue>& args);
-KaynatValue pattern_is_email(const std::vector<KaynatValue>& args);
-KaynatValue pattern_is_url(const std::vector<KaynatValue>& args);
+KaynatValue pattern_match(ArgSpan args);
+KaynatValue pattern_find_all(ArgSpan args);
+KaynatValue pattern_replace(ArgSpan args);
+KaynatValue pattern_split(ArgSpan args);
+KaynatValue pattern_is_email(ArgSpan args);
+KaynatValue pattern_is_url(ArgSpan args);
 
 } // namespace stdlib
 } // namespace kaynat
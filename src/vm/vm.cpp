@@ -0,0 +1,885 @@
+/**
+ * @file vm.cpp
+ * @brief Virtual machine implementation
+ */
+
+#include "vm.hpp"
+#include "../errors/error_types.hpp"
+#include "../gui/gui_commands.hpp"
+#include "../interpreter/operators.hpp"
+#include "../interpreter/parallel.hpp"
+#include "../interpreter/task.hpp"
+#include "../stdlib/stdlib.hpp"
+#include <string>
+
+namespace kaynat {
+
+namespace {
+
+BinaryOpNode::Op to_binary_op(OpCode op) {
+    switch (op) {
+        case OpCode::SUBTRACT: return BinaryOpNode::Op::SUBTRACT;
+        case OpCode::MULTIPLY: return BinaryOpNode::Op::MULTIPLY;
+        case OpCode::DIVIDE: return BinaryOpNode::Op::DIVIDE;
+        case OpCode::MODULO: return BinaryOpNode::Op::MODULO;
+        case OpCode::EQUAL: return BinaryOpNode::Op::EQUAL;
+        case OpCode::NOT_EQUAL: return BinaryOpNode::Op::NOT_EQUAL;
+        case OpCode::LESS_THAN: return BinaryOpNode::Op::LESS_THAN;
+        case OpCode::LESS_EQUAL: return BinaryOpNode::Op::LESS_EQUAL;
+        case OpCode::GREATER_THAN: return BinaryOpNode::Op::GREATER_THAN;
+        case OpCode::GREATER_EQUAL: return BinaryOpNode::Op::GREATER_EQUAL;
+        case OpCode::AND: return BinaryOpNode::Op::AND;
+        case OpCode::OR: return BinaryOpNode::Op::OR;
+        default: return BinaryOpNode::Op::ADD;
+    }
+}
+
+/**
+ * @brief Apply an operator to two integers in place
+ * @return false if the operands are not both integers or the operation
+ *         must go through ops::binary (e.g. to report an error or to
+ *         promote an overflowing result to BigInt)
+ */
+bool int_binary(OpCode op, KaynatValue& left, const KaynatValue& right) {
+    int64_t* l = left.as_int_ptr();
+    const int64_t* r = right.as_int_ptr();
+    if (l == nullptr || r == nullptr) {
+        return false;
+    }
+
+    switch (op) {
+        // The builtins store the wrapped value on overflow, so the operand
+        // is only overwritten once the result is known to fit
+        case OpCode::ADD: {
+            int64_t value;
+            if (__builtin_add_overflow(*l, *r, &value)) return false;
+            *l = value;
+            return true;
+        }
+        case OpCode::SUBTRACT: {
+            int64_t value;
+            if (__builtin_sub_overflow(*l, *r, &value)) return false;
+            *l = value;
+            return true;
+        }
+        case OpCode::MULTIPLY: {
+            int64_t value;
+            if (__builtin_mul_overflow(*l, *r, &value)) return false;
+            *l = value;
+            return true;
+        }
+        case OpCode::MODULO:
+            if (*r == 0 || *r == -1) return false;
+            *l = *l % *r;
+            return true;
+        case OpCode::EQUAL: { const bool result = *l == *r; left = KaynatValue(result); return true; }
+        case OpCode::NOT_EQUAL: { const bool result = *l != *r; left = KaynatValue(result); return true; }
+        case OpCode::LESS_THAN: { const bool result = *l < *r; left = KaynatValue(result); return true; }
+        case OpCode::LESS_EQUAL: { const bool result = *l <= *r; left = KaynatValue(result); return true; }
+        case OpCode::GREATER_THAN: { const bool result = *l > *r; left = KaynatValue(result); return true; }
+        case OpCode::GREATER_EQUAL: { const bool result = *l >= *r; left = KaynatValue(result); return true; }
+        default: return false;
+    }
+}
+
+bool truthy(const KaynatValue& value) {
+    if (value.type() == KaynatValue::Type::BOOLEAN) {
+        return *value.as_bool();
+    }
+    return value.is_truthy();
+}
+
+} // namespace
+
+KaynatValue VMFunction::operator()(std::vector<KaynatValue> args) const {
+    return vm->call(*this, std::move(args));
+}
+
+VM::VM()
+    : globals_(std::make_shared<Environment>(nullptr, stdlib::builtin_value)), root_(this),
+      tasks_(std::make_shared<TaskGroup>()), parallel_(false), isolated_(false) {
+    stack_.reserve(256);
+    slots_.reserve(256);
+    frames_.reserve(64);
+}
+
+VM::VM(const VM& creator, std::shared_ptr<Environment> globals, bool isolated)
+    : globals_(std::move(globals)), root_(creator.root_), tasks_(creator.tasks_),
+      parallel_(true), isolated_(isolated) {
+    stack_.reserve(256);
+    slots_.reserve(256);
+    frames_.reserve(64);
+}
+
+KaynatValue VM::execute(const std::shared_ptr<FunctionProto>& script) {
+    return invoke(*script, nullptr, {}, nullptr);
+}
+
+KaynatValue VM::call(const VMFunction& function, std::vector<KaynatValue> args) {
+    KaynatValue cached;
+    if (function.memo && function.memo->find(args, cached)) {
+        return cached;
+    }
+    return invoke(*function.proto, function.closure, std::move(args), function.memo);
+}
+
+KaynatValue VM::invoke(const FunctionProto& proto, std::shared_ptr<Scope> closure,
+                       std::vector<KaynatValue> args, std::shared_ptr<MemoTable> memo) {
+    const size_t entry_depth = frames_.size();
+    const size_t stack_height = stack_.size();
+    const size_t slot_height = slots_.size();
+
+    try {
+        // Placeholder for the callee so the frame layout matches CALL
+        stack_.emplace_back();
+        const size_t args_at = stack_.size();
+        for (auto& arg : args) {
+            stack_.push_back(std::move(arg));
+        }
+
+        push_frame(proto, std::move(closure), args_at, args.size(), args_at - 1, proto.line);
+        if (memo) {
+            remember_arguments(std::move(memo));
+        }
+        return run(entry_depth);
+    } catch (...) {
+        // Discard everything the failed call left behind
+        frames_.erase(frames_.begin() + static_cast<std::ptrdiff_t>(entry_depth), frames_.end());
+        stack_.resize(stack_height);
+        slots_.resize(slot_height);
+        throw;
+    }
+}
+
+void VM::push_frame(const FunctionProto& proto, std::shared_ptr<Scope> closure,
+                    size_t args_at, size_t argc, size_t stack_base, uint32_t line) {
+    if (argc != proto.arity) {
+        throw RuntimeError("Function expects " + std::to_string(proto.arity) +
+                           " arguments, got " + std::to_string(argc), proto.line, 0);
+    }
+
+    if (frames_.size() >= MAX_CALL_DEPTH) {
+        throw RuntimeError("Stack overflow: too many nested function calls", line, 0);
+    }
+
+    const size_t base = slots_.size();
+    slots_.resize(base + proto.frame_size);
+
+    frames_.emplace_back();
+    Frame& frame = frames_.back();
+    frame.proto = &proto;
+    frame.ip = 0;
+    frame.base = base;
+    frame.stack_base = stack_base;
+    frame.closure = std::move(closure);
+
+    if (proto.scope_size > 0) {
+        frame.scope = scopes_.acquire(proto.scope_size, frame.closure);
+    }
+
+    // Bind parameters
+    for (size_t i = 0; i < argc; ++i) {
+        Slot& slot = proto.param_captured[i]
+            ? frame.scope->slots[proto.param_targets[i]]
+            : slots_[base + proto.param_targets[i]];
+        slot.value = std::move(stack_[args_at + i]);
+        slot.defined = true;
+    }
+
+    stack_.resize(args_at);
+}
+
+void VM::replace_frame(std::shared_ptr<const FunctionProto> proto, std::shared_ptr<Scope> closure,
+                       size_t args_at, size_t argc, uint32_t line) {
+    // Move the arguments down to where the finished frame's operands began
+    const size_t stack_base = frames_.back().stack_base;
+    if (args_at != stack_base) {
+        for (size_t i = 0; i < argc; ++i) {
+            stack_[stack_base + i] = std::move(stack_[args_at + i]);
+        }
+    }
+    stack_.resize(stack_base + argc);
+
+    slots_.resize(frames_.back().base);
+    scopes_.release(std::move(frames_.back().scope));
+    frames_.pop_back();
+
+    // The callee may have been reachable only through the replaced frame
+    push_frame(*proto, std::move(closure), stack_base, argc, stack_base, line);
+    frames_.back().owner = std::move(proto);
+}
+
+void VM::call_native(const CallableType& callable, size_t args_at, size_t stack_base) {
+    KaynatValue result;
+    if (const auto* function = callable.target<NativeFunction>()) {
+        // Standard library functions never call back into the VM, so the
+        // arguments can be read in place on the stack
+        result = (*function)(ArgSpan(stack_.data() + args_at, stack_.size() - args_at));
+    } else {
+        // Copy the callable since a callback into the VM may move the stack
+        CallableType native = callable;
+        std::vector<KaynatValue> args(std::make_move_iterator(stack_.begin() + static_cast<std::ptrdiff_t>(args_at)),
+                                      std::make_move_iterator(stack_.end()));
+        result = native(std::move(args));
+    }
+    stack_.resize(stack_base);
+    stack_.push_back(std::move(result));
+}
+
+bool VM::recall(MemoTable& memo, size_t args_at, size_t stack_base) {
+    KaynatValue cached;
+    if (!memo.find(ArgSpan(stack_.data() + args_at, stack_.size() - args_at), cached)) {
+        return false;
+    }
+
+    stack_.resize(stack_base);
+    stack_.push_back(std::move(cached));
+    return true;
+}
+
+void VM::remember_arguments(std::shared_ptr<MemoTable> memo) {
+    // The arguments were just bound to the new frame's parameter slots
+    Frame& frame = frames_.back();
+    const FunctionProto& proto = *frame.proto;
+    std::vector<KaynatValue> key;
+    key.reserve(proto.arity);
+    for (size_t i = 0; i < proto.arity; ++i) {
+        const Slot& slot = proto.param_captured[i]
+            ? frame.scope->slots[proto.param_targets[i]]
+            : slots_[frame.base + proto.param_targets[i]];
+        key.push_back(slot.value);
+    }
+
+    if (MemoTable::keyable(key)) {
+        frame.memo = std::move(memo);
+        frame.memo_key = std::move(key);
+    }
+}
+
+KaynatValue VM::run_parallel(const std::shared_ptr<FunctionProto>& body, std::shared_ptr<Scope> closure,
+                             const ListType& list) {
+    // Fill the body's global cache now, while no worker reads it
+    for (uint32_t name = 0; name < body->names.size(); ++name) {
+        bool constant = false;
+        find_global(*body, name, constant);
+    }
+
+    return KaynatValue(parallel_map(list.size(), [&]() -> IterationRunner {
+        std::shared_ptr<VM> worker(new VM(*this, globals_, isolated_));
+        return [worker, &body, &closure, &list](size_t index) {
+            return worker->invoke(*body, closure, {list[index]}, nullptr);
+        };
+    }));
+}
+
+KaynatValue VM::spawn(const CallableType& callee, std::vector<KaynatValue> args) {
+    // The task reads copies, so the spawning code may go on changing the
+    // globals and the function's captured variables
+    std::shared_ptr<VM> worker(new VM(*this, globals_->copy(), true));
+    CallableType target = callee;
+    if (const auto* function = callee.target<VMFunction>(); function && function->vm == root_) {
+        VMFunction copy = *function;
+        copy.closure = copy_scopes(function->closure);
+        target = std::move(copy);
+    }
+
+    return KaynatValue(Task::spawn(tasks_, [worker, target, args = std::move(args)]() mutable {
+        return worker->call_value(target, std::move(args));
+    }));
+}
+
+KaynatValue VM::call_value(const CallableType& callee, std::vector<KaynatValue> args) {
+    if (const auto* function = callee.target<VMFunction>(); function && function->vm == root_) {
+        return call(*function, std::move(args));
+    }
+    if (const auto* native = callee.target<NativeFunction>()) {
+        return (*native)(ArgSpan(args));
+    }
+    return callee(std::move(args));
+}
+
+KaynatValue* VM::find_global(const FunctionProto& proto, uint32_t name, bool& constant) {
+    GlobalCacheEntry& entry = proto.global_cache[name];
+    if (!isolated_ && entry.owner == globals_.get() && entry.version == globals_->version()) {
+        constant = entry.constant;
+        return entry.value;
+    }
+
+    KaynatValue* value = globals_->find_local(proto.names[name]);
+    bool is_constant = value != nullptr && globals_->is_constant(proto.names[name]);
+    if (value == nullptr) {
+        // Builtins are shared by every engine; counting them as constants
+        // keeps stores from writing through the pointer
+        value = const_cast<KaynatValue*>(globals_->find_builtin(proto.names[name]));
+        is_constant = value != nullptr;
+    }
+
+    // Workers leave the shared prototypes unchanged
+    if (parallel_) {
+        constant = is_constant;
+        return value;
+    }
+
+    entry.owner = globals_.get();
+    entry.version = globals_->version();
+    entry.value = value;
+    entry.constant = is_constant;
+    constant = is_constant;
+    return value;
+}
+
+KaynatValue VM::load_global(const FunctionProto& proto, uint32_t name) {
+    bool constant = false;
+    KaynatValue* value = find_global(proto, name, constant);
+    if (value == nullptr) {
+        throw UndefinedError(proto.names[name].str(), 0, 0);
+    }
+    return *value;
+}
+
+void VM::store_global(const FunctionProto& proto, uint32_t name, KaynatValue value, bool is_constant) {
+    if (parallel_) {
+        check_parallel_write(nullptr, proto.names[name]);
+    }
+
+    bool constant = false;
+    KaynatValue* target = find_global(proto, name, constant);
+    if (target == nullptr) {
+        globals_->define(proto.names[name], value, is_constant);
+        return;
+    }
+
+    assign_global(proto, name, target, constant, std::move(value));
+}
+
+void VM::assign_global(const FunctionProto& proto, uint32_t name, KaynatValue* target, bool constant,
+                       KaynatValue value) {
+    if (constant) {
+        // Assigning to a builtin gives the program a global that hides it
+        if (target == globals_->find_builtin(proto.names[name])) {
+            globals_->set(proto.names[name], value);
+            return;
+        }
+        throw RuntimeError("Cannot modify constant '" + proto.names[name].str() + "'", 0, 0);
+    }
+    *target = std::move(value);
+}
+
+Slot& VM::locate(const Frame& frame, const NameLocation& location) {
+    switch (location.kind) {
+        case NameLocation::Kind::FRAME:
+            return slots_[frame.base + location.slot];
+
+        case NameLocation::Kind::OWN:
+            return frame.scope->slots[location.slot];
+
+        case NameLocation::Kind::OUTER:
+            break;
+    }
+    return outer_scope(frame, location)->slots[location.slot];
+}
+
+Scope* VM::outer_scope(const Frame& frame, const NameLocation& location) {
+    Scope* scope = frame.closure.get();
+    for (uint32_t i = 0; i < location.depth; ++i) {
+        scope = scope->parent.get();
+    }
+    return scope;
+}
+
+KaynatValue VM::load_name(const Frame& frame, const NameReference& ref) {
+    for (const auto& location : ref.locations) {
+        Slot& slot = locate(frame, location);
+        if (slot.defined) {
+            return slot.value;
+        }
+    }
+    return load_global(*frame.proto, ref.name);
+}
+
+void VM::store_name(const Frame& frame, const NameReference& ref, KaynatValue value, bool is_constant) {
+    const Symbol name = frame.proto->names[ref.name];
+
+    for (const auto& location : ref.locations) {
+        Slot& slot = locate(frame, location);
+        if (slot.defined) {
+            if (parallel_ && location.kind == NameLocation::Kind::OUTER) {
+                check_parallel_write(outer_scope(frame, location), name);
+            }
+            assign(slot, name, std::move(value));
+            return;
+        }
+    }
+
+    bool constant = false;
+    KaynatValue* global = find_global(*frame.proto, ref.name, constant);
+    if (global != nullptr) {
+        if (parallel_) {
+            check_parallel_write(nullptr, name);
+        }
+        assign_global(*frame.proto, ref.name, global, constant, std::move(value));
+        return;
+    }
+
+    // Not visible anywhere: define in the current function
+    Slot& slot = locate(frame, ref.locations.front());
+    define(slot, name, std::move(value));
+    slot.constant = is_constant;
+}
+
+void VM::check_parallel_write(const Scope* scope, Symbol name) const {
+    // Only variables of scopes this worker created may change
+    if (scope == nullptr || scope->owner != scopes_.id()) {
+        throw RuntimeError("Cannot change '" + name.str() + "' from a parallel loop or task; it was defined outside it",
+                           0, 0);
+    }
+}
+
+void VM::assign(Slot& slot, Symbol name, KaynatValue value) {
+    if (slot.constant) {
+        throw RuntimeError("Cannot modify constant '" + name.str() + "'", 0, 0);
+    }
+    slot.value = std::move(value);
+}
+
+void VM::define(Slot& slot, Symbol name, KaynatValue value) {
+    if (slot.defined) {
+        throw RuntimeError("Variable '" + name.str() + "' already defined in this scope", 0, 0);
+    }
+    slot.value = std::move(value);
+    slot.defined = true;
+}
+
+KaynatValue VM::run(size_t entry_depth) {
+    Frame* frame = &frames_.back();
+    const FunctionProto* proto = frame->proto;
+    const Instruction* code = proto->code.data();
+    Slot* locals = slots_.data() + frame->base;
+    size_t ip = frame->ip;
+
+    // Frames and slots may move when calls push or pop frames
+    auto reload = [&]() {
+        frame = &frames_.back();
+        proto = frame->proto;
+        code = proto->code.data();
+        locals = slots_.data() + frame->base;
+        ip = frame->ip;
+    };
+
+    auto pop = [this]() {
+        KaynatValue value = std::move(stack_.back());
+        stack_.pop_back();
+        return value;
+    };
+
+    for (;;) {
+        const Instruction& instr = code[ip++];
+
+        switch (instr.op) {
+            case OpCode::CONSTANT:
+                stack_.push_back(proto->constants[instr.a]);
+                break;
+
+            case OpCode::PUSH_NULL:
+                stack_.emplace_back();
+                break;
+
+            case OpCode::POP:
+                stack_.pop_back();
+                break;
+
+            case OpCode::DUP:
+                stack_.push_back(stack_.back());
+                break;
+
+            case OpCode::LOAD_LOCAL: {
+                const Slot& slot = locals[instr.a];
+                if (slot.defined) {
+                    stack_.push_back(slot.value);
+                } else {
+                    stack_.push_back(load_global(*proto, proto->frame_names[instr.a]));
+                }
+                break;
+            }
+
+            case OpCode::STORE_LOCAL: {
+                Slot& slot = locals[instr.a];
+                const uint32_t name = proto->frame_names[instr.a];
+                if (slot.defined) {
+                    assign(slot, proto->names[name], pop());
+                    break;
+                }
+
+                bool constant = false;
+                KaynatValue* global = find_global(*proto, name, constant);
+                if (global != nullptr) {
+                    if (parallel_) {
+                        check_parallel_write(nullptr, proto->names[name]);
+                    }
+                    assign_global(*proto, name, global, constant, pop());
+                } else {
+                    slot.value = pop();
+                    slot.defined = true;
+                    slot.constant = instr.b != 0;
+                }
+                break;
+            }
+
+            case OpCode::DEFINE_LOCAL:
+                define(locals[instr.a], proto->names[proto->frame_names[instr.a]], pop());
+                break;
+
+            case OpCode::LOAD_GLOBAL: {
+                const GlobalCacheEntry& entry = proto->global_cache[instr.a];
+                if (!isolated_ && entry.owner == globals_.get() && entry.version == globals_->version() &&
+                    entry.value) {
+                    stack_.push_back(*entry.value);
+                } else {
+                    stack_.push_back(load_global(*proto, instr.a));
+                }
+                break;
+            }
+
+            case OpCode::STORE_GLOBAL: {
+                const GlobalCacheEntry& entry = proto->global_cache[instr.a];
+                if (!parallel_ && entry.owner == globals_.get() && entry.version == globals_->version() &&
+                    entry.value && !entry.constant) {
+                    *entry.value = std::move(stack_.back());
+                    stack_.pop_back();
+                } else {
+                    store_global(*proto, instr.a, pop(), instr.b != 0);
+                }
+                break;
+            }
+
+            case OpCode::DEFINE_GLOBAL:
+                if (parallel_) {
+                    check_parallel_write(nullptr, proto->names[instr.a]);
+                }
+                globals_->define(proto->names[instr.a], pop());
+                break;
+
+            case OpCode::LOAD_NAME:
+                stack_.push_back(load_name(*frame, proto->references[instr.a]));
+                break;
+
+            case OpCode::STORE_NAME:
+                store_name(*frame, proto->references[instr.a], pop(), instr.b != 0);
+                break;
+
+            case OpCode::DEFINE_SCOPED:
+                define(frame->scope->slots[instr.a], proto->names[proto->scope_names[instr.a]], pop());
+                break;
+
+            case OpCode::ADD:
+            case OpCode::SUBTRACT:
+            case OpCode::MULTIPLY:
+            case OpCode::DIVIDE:
+            case OpCode::MODULO:
+            case OpCode::EQUAL:
+            case OpCode::NOT_EQUAL:
+            case OpCode::LESS_THAN:
+            case OpCode::LESS_EQUAL:
+            case OpCode::GREATER_THAN:
+            case OpCode::GREATER_EQUAL:
+            case OpCode::AND:
+            case OpCode::OR: {
+                KaynatValue& left = stack_[stack_.size() - 2];
+                const KaynatValue& right = stack_.back();
+                if (!int_binary(instr.op, left, right)) {
+                    left = ops::binary(to_binary_op(instr.op), left, right, proto->lines[ip - 1]);
+                }
+                stack_.pop_back();
+                break;
+            }
+
+            case OpCode::NEGATE: {
+                KaynatValue& operand = stack_.back();
+                if (int64_t* i = operand.as_int_ptr(); i && *i != INT64_MIN) {
+                    *i = -*i;
+                } else {
+                    operand = ops::unary(UnaryOpNode::Op::NEGATE, operand, proto->lines[ip - 1]);
+                }
+                break;
+            }
+
+            case OpCode::NOT:
+                stack_.back() = KaynatValue(!truthy(stack_.back()));
+                break;
+
+            case OpCode::JUMP:
+                ip = instr.a;
+                break;
+
+            case OpCode::JUMP_IF_FALSE: {
+                const bool condition = truthy(stack_.back());
+                stack_.pop_back();
+                if (!condition) {
+                    ip = instr.a;
+                }
+                break;
+            }
+
+            case OpCode::REPEAT_INIT: {
+                KaynatValue count = pop();
+                const int64_t* n = count.as_int_ptr();
+                if (n == nullptr) {
+                    throw TypeError("Integer", count.type_name(), proto->lines[ip - 1], 0);
+                }
+                locals[instr.a].value = KaynatValue(*n);
+                break;
+            }
+
+            case OpCode::REPEAT_NEXT: {
+                int64_t& remaining = *locals[instr.c].value.as_int_ptr();
+                if (remaining <= 0) {
+                    ip = instr.a;
+                } else {
+                    remaining--;
+                }
+                break;
+            }
+
+            case OpCode::FOR_EACH_INIT: {
+                KaynatValue iterable = pop();
+                if (iterable.type() != KaynatValue::Type::LIST) {
+                    throw TypeError("List", iterable.type_name(), proto->lines[ip - 1], 0);
+                }
+                locals[instr.a].value = std::move(iterable);
+                locals[instr.a + 1].value = KaynatValue(static_cast<int64_t>(0));
+                break;
+            }
+
+            case OpCode::FOR_EACH_NEXT: {
+                const ListType& list = *locals[instr.c].value.as_list_ptr();
+                int64_t& index = *locals[instr.c + 1].value.as_int_ptr();
+                if (static_cast<size_t>(index) >= list.size()) {
+                    ip = instr.a;
+                } else {
+                    stack_.push_back(list[static_cast<size_t>(index)]);
+                    index++;
+                }
+                break;
+            }
+
+            case OpCode::FOR_EACH_PARALLEL: {
+                KaynatValue iterable = pop();
+                const ListType* list = iterable.as_list_ptr();
+                if (list == nullptr) {
+                    throw TypeError("List", iterable.type_name(), proto->lines[ip - 1], 0);
+                }
+
+                frame->ip = ip;
+                auto closure = frame->scope ? frame->scope : frame->closure;
+                KaynatValue results = run_parallel(proto->functions[instr.a], std::move(closure), *list);
+                stack_.push_back(std::move(results));
+                break;
+            }
+
+            case OpCode::MAKE_FUNCTION: {
+                auto closure = frame->scope ? frame->scope : frame->closure;
+                const auto& function = proto->functions[instr.a];
+                std::shared_ptr<MemoTable> memo;
+                if (function->memo) {
+                    memo = std::make_shared<MemoTable>(function->arity, function->memo);
+                }
+                stack_.push_back(KaynatValue(CallableType(
+                    VMFunction{root_, function, std::move(closure), std::move(memo)})));
+                break;
+            }
+
+            case OpCode::CALL: {
+                const size_t argc = instr.c;
+                const size_t callee_at = stack_.size() - argc - 1;
+                const uint32_t line = proto->lines[ip - 1];
+
+                const CallableType* callable = stack_[callee_at].as_callable_ptr();
+                if (callable == nullptr) {
+                    throw TypeError("Function", stack_[callee_at].type_name(), line, 0);
+                }
+
+                frame->ip = ip;
+                const auto* function = callable->target<VMFunction>();
+                if (function != nullptr && function->vm == root_) {
+                    // Copied, since replacing the frame may drop the callee
+                    std::shared_ptr<MemoTable> memo = function->memo;
+                    if (memo && recall(*memo, callee_at + 1, callee_at)) {
+                        reload();
+                        break;
+                    }
+
+                    if (instr.b != 0) {
+                        replace_frame(function->proto, function->closure, callee_at + 1, argc, line);
+                    } else {
+                        // The callee stays on the stack and keeps its prototype alive
+                        push_frame(*function->proto, function->closure, callee_at + 1, argc, callee_at, line);
+                    }
+                    if (memo) {
+                        remember_arguments(std::move(memo));
+                    }
+                } else {
+                    call_native(*callable, callee_at + 1, callee_at);
+                }
+                reload();
+                break;
+            }
+
+            case OpCode::CALL_GLOBAL: {
+                const size_t argc = instr.c;
+                const size_t args_at = stack_.size() - argc;
+                const uint32_t line = proto->lines[ip - 1];
+
+                const GlobalCacheEntry& entry = proto->global_cache[instr.a];
+                KaynatValue* callee;
+                if (!isolated_ && entry.owner == globals_.get() && entry.version == globals_->version()) {
+                    callee = entry.value;
+                } else {
+                    bool constant = false;
+                    callee = find_global(*proto, instr.a, constant);
+                }
+                if (callee == nullptr) {
+                    throw UndefinedError(proto->names[instr.a].str(), 0, 0);
+                }
+
+                const CallableType* callable = callee->as_callable_ptr();
+                if (callable == nullptr) {
+                    throw TypeError("Function", callee->type_name(), line, 0);
+                }
+
+                frame->ip = ip;
+                const auto* function = callable->target<VMFunction>();
+                if (function != nullptr && function->vm == root_) {
+                    std::shared_ptr<MemoTable> memo = function->memo;
+                    if (memo && recall(*memo, args_at, args_at)) {
+                        reload();
+                        break;
+                    }
+
+                    if (instr.b != 0) {
+                        replace_frame(function->proto, function->closure, args_at, argc, line);
+                    } else {
+                        // The global may be reassigned while the call runs
+                        auto owner = function->proto;
+                        push_frame(*owner, function->closure, args_at, argc, args_at, line);
+                        frames_.back().owner = std::move(owner);
+                    }
+                    if (memo) {
+                        remember_arguments(std::move(memo));
+                    }
+                } else {
+                    call_native(*callable, args_at, args_at);
+                }
+                reload();
+                break;
+            }
+
+            case OpCode::SET_RESULT:
+                frame->result = pop();
+                break;
+
+            case OpCode::RETURN:
+            case OpCode::RETURN_RESULT: {
+                KaynatValue result = instr.op == OpCode::RETURN ? pop() : std::move(frame->result);
+                if (frame->memo) {
+                    frame->memo->insert(frame->memo_key, result);
+                }
+                stack_.resize(frame->stack_base);
+                slots_.resize(frame->base);
+                scopes_.release(std::move(frame->scope));
+                frames_.pop_back();
+
+                if (frames_.size() == entry_depth) {
+                    return result;
+                }
+
+                stack_.push_back(std::move(result));
+                reload();
+                break;
+            }
+
+            case OpCode::SPAWN: {
+                const size_t argc = instr.c;
+                const size_t callee_at = stack_.size() - argc - 1;
+                const CallableType* callable = stack_[callee_at].as_callable_ptr();
+                if (callable == nullptr) {
+                    throw TypeError("Function", stack_[callee_at].type_name(), proto->lines[ip - 1], 0);
+                }
+
+                std::vector<KaynatValue> args(std::make_move_iterator(stack_.begin() + static_cast<std::ptrdiff_t>(callee_at + 1)),
+                                              std::make_move_iterator(stack_.end()));
+                KaynatValue task = spawn(*callable, std::move(args));
+                stack_.resize(callee_at);
+                stack_.push_back(std::move(task));
+                break;
+            }
+
+            case OpCode::WAIT: {
+                const std::shared_ptr<Task>* task = stack_.back().as_task_ptr();
+                if (task == nullptr) {
+                    throw TypeError("Task", stack_.back().type_name(), proto->lines[ip - 1], 0);
+                }
+
+                // The task runs on a worker of its own, even when it runs here
+                frame->ip = ip;
+                KaynatValue result = (*task)->wait();
+                stack_.back() = std::move(result);
+                break;
+            }
+
+            case OpCode::BUILD_LIST: {
+                const auto first = stack_.end() - instr.c;
+                ListType elements(std::make_move_iterator(first), std::make_move_iterator(stack_.end()));
+                stack_.erase(first, stack_.end());
+                stack_.push_back(KaynatValue(std::move(elements)));
+                break;
+            }
+
+            case OpCode::BUILD_DICT: {
+                const size_t first = stack_.size() - instr.c;
+                DictType dict;
+                for (size_t i = 0; i < instr.c; ++i) {
+                    dict[proto->keys[instr.a + i]] = std::move(stack_[first + i]);
+                }
+                stack_.resize(first);
+                stack_.push_back(KaynatValue(std::move(dict)));
+                break;
+            }
+
+            case OpCode::INDEX: {
+                KaynatValue index = pop();
+                stack_.back() = ops::index(stack_.back(), index, proto->lines[ip - 1]);
+                break;
+            }
+
+            case OpCode::SAY: {
+                const size_t first = stack_.size() - instr.c;
+                std::string line;
+                for (size_t i = first; i < stack_.size(); ++i) {
+                    line += stack_[i].to_string();
+                    if (i + 1 != stack_.size()) {
+                        line += ' ';
+                    }
+                }
+                say_line(line);
+                stack_.resize(first);
+                stack_.emplace_back();
+                break;
+            }
+
+            case OpCode::GUI: {
+                if (parallel_) {
+                    throw RuntimeError("GUI commands cannot run inside a parallel loop or task", proto->lines[ip - 1], 0);
+                }
+
+                const size_t first = stack_.size() - instr.c;
+                std::vector<KaynatValue> args(std::make_move_iterator(stack_.begin() + static_cast<std::ptrdiff_t>(first)),
+                                              std::make_move_iterator(stack_.end()));
+                stack_.resize(first);
+                run_gui_command(static_cast<GUINode::Command>(instr.b), proto->names[instr.a].str(), args);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace kaynat
@@ -0,0 +1,159 @@
+/**
+ * @file vm.hpp
+ * @brief Stack-based bytecode virtual machine for Kaynat++
+ *
+ * Executes prototypes produced by the Compiler. The VM is the default
+ * execution engine; the tree-walking Interpreter remains available for
+ * comparison and debugging.
+ */
+
+#pragma once
+
+#include "../compiler/bytecode.hpp"
+#include "../interpreter/environment.hpp"
+#include "../interpreter/runtime_value.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace kaynat {
+
+class TaskGroup;
+class VM;
+
+/**
+ * @brief Function value created by MAKE_FUNCTION
+ *
+ * Stored inside a CallableType so that compiled functions and native
+ * stdlib functions share one runtime representation. The VM recognises
+ * its own functions on CALL and runs them without native recursion.
+ */
+struct VMFunction {
+    VM* vm;
+    std::shared_ptr<const FunctionProto> proto;
+    std::shared_ptr<Scope> closure;
+    std::shared_ptr<MemoTable> memo;  // Result cache of a memoized function
+
+    /**
+     * @brief Call the function from native code
+     */
+    KaynatValue operator()(std::vector<KaynatValue> args) const;
+};
+
+/**
+ * @brief Bytecode virtual machine
+ *
+ * Keeps one operand stack, one slot array for all call frames and a
+ * frame stack. Globals live in an Environment preloaded with the
+ * standard library and persist across execute() calls, which lets the
+ * REPL compile each line separately.
+ *
+ * Parallel for-each loops run their iterations on worker VMs, one per
+ * thread, which share the globals and the functions of the VM that
+ * started the loop. A spawned task runs on a worker of its own, with a
+ * copy of the globals and of the variables its function captured.
+ * Workers keep the globals, and the variables of scopes they did not
+ * create, read-only.
+ *
+ * Thread-safe: No. Each thread runs its own (worker) VM.
+ */
+class VM {
+public:
+    /**
+     * @brief Construct VM with global environment
+     */
+    VM();
+
+    /**
+     * @brief Execute a compiled script
+     * @param script Prototype returned by Compiler::compile
+     * @return Value of the last statement or null
+     * @throws KaynatError on runtime errors
+     */
+    KaynatValue execute(const std::shared_ptr<FunctionProto>& script);
+
+    /**
+     * @brief Call a compiled function with arguments
+     * @param function Function to call
+     * @param args Argument values
+     * @return Function result
+     * @throws KaynatError on runtime errors
+     */
+    KaynatValue call(const VMFunction& function, std::vector<KaynatValue> args);
+
+    /**
+     * @brief Global scope, for hosts defining inputs before a run
+     */
+    Environment& globals() { return *globals_; }
+
+    /**
+     * @brief Tasks spawned by this VM and its workers
+     */
+    TaskGroup& tasks() { return *tasks_; }
+
+private:
+    /**
+     * @brief Activation record of a running function
+     */
+    struct Frame {
+        const FunctionProto* proto;
+        size_t ip;
+        size_t base;        // First slot in slots_
+        size_t stack_base;  // Operand stack height restored on return
+        std::shared_ptr<Scope> scope;
+        std::shared_ptr<Scope> closure;
+        std::shared_ptr<const FunctionProto> owner;  // Set when the callee is not on the stack
+        KaynatValue result;
+        std::shared_ptr<MemoTable> memo;     // Receives the result when set
+        std::vector<KaynatValue> memo_key;  // Arguments the result is stored under
+    };
+
+    static constexpr size_t MAX_CALL_DEPTH = 10000;
+
+    std::shared_ptr<Environment> globals_;
+    std::vector<KaynatValue> stack_;
+    std::vector<Slot> slots_;
+    std::vector<Frame> frames_;
+    ScopePool scopes_;  // Scopes of frames with captured slots
+    VM* root_;          // VM whose functions this one runs
+    std::shared_ptr<TaskGroup> tasks_;  // Shared with the root and its workers
+    bool parallel_;     // Runs a parallel loop iteration or a task
+    bool isolated_;     // Runs alongside the root, so leaves its caches alone
+
+    /**
+     * @brief Worker for a parallel loop or task started by `creator`
+     */
+    VM(const VM& creator, std::shared_ptr<Environment> globals, bool isolated);
+
+    // Execution
+    KaynatValue invoke(const FunctionProto& proto, std::shared_ptr<Scope> closure,
+                       std::vector<KaynatValue> args, std::shared_ptr<MemoTable> memo);
+    KaynatValue run(size_t entry_depth);
+    void push_frame(const FunctionProto& proto, std::shared_ptr<Scope> closure,
+                    size_t args_at, size_t argc, size_t stack_base, uint32_t line);
+    void replace_frame(std::shared_ptr<const FunctionProto> proto, std::shared_ptr<Scope> closure,
+                       size_t args_at, size_t argc, uint32_t line);
+    void call_native(const CallableType& callable, size_t args_at, size_t stack_base);
+    bool recall(MemoTable& memo, size_t args_at, size_t stack_base);
+    void remember_arguments(std::shared_ptr<MemoTable> memo);
+    KaynatValue run_parallel(const std::shared_ptr<FunctionProto>& body, std::shared_ptr<Scope> closure,
+                             const ListType& list);
+    KaynatValue spawn(const CallableType& callee, std::vector<KaynatValue> args);
+    KaynatValue call_value(const CallableType& callee, std::vector<KaynatValue> args);
+
+    // Variable access
+    KaynatValue* find_global(const FunctionProto& proto, uint32_t name, bool& constant);
+    KaynatValue load_global(const FunctionProto& proto, uint32_t name);
+    void store_global(const FunctionProto& proto, uint32_t name, KaynatValue value, bool is_constant);
+    void assign_global(const FunctionProto& proto, uint32_t name, KaynatValue* target, bool constant,
+                       KaynatValue value);
+    Slot& locate(const Frame& frame, const NameLocation& location);
+    static Scope* outer_scope(const Frame& frame, const NameLocation& location);
+    KaynatValue load_name(const Frame& frame, const NameReference& ref);
+    void store_name(const Frame& frame, const NameReference& ref, KaynatValue value, bool is_constant);
+    void check_parallel_write(const Scope* scope, Symbol name) const;
+    static void assign(Slot& slot, Symbol name, KaynatValue value);
+    static void define(Slot& slot, Symbol name, KaynatValue value);
+};
+
+} // namespace kaynat